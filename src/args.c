@@ -189,22 +189,36 @@ handle_arg_or_fail(const char arg[], int select, const char dir[], args_t *args)
 static int
 handle_path_arg(const char arg[], int select, const char dir[], args_t *args)
 {
-	if(!is_path_arg(arg))
+	/* Standard input can be read only on startup. */
+	const int from_stdin = (strcmp(arg, "-") == 0 && !select &&
+			curr_stats.load_stage == 0);
+	char *path;
+
+	if(!from_stdin && !is_path_arg(arg))
 	{
 		return 1;
 	}
 
 	if(args->lwin_path[0] != '\0')
 	{
-		parse_path(dir, arg, args->rwin_path);
+		path = args->rwin_path;
 		args->rwin_handle = !select;
 	}
 	else
 	{
-		parse_path(dir, arg, args->lwin_path);
+		path = args->lwin_path;
 		args->lwin_handle = !select;
 	}
 
+	if(from_stdin)
+	{
+		strcpy(path, "-");
+	}
+	else
+	{
+		parse_path(dir, arg, path);
+	}
+
 	return 0;
 }
 
@@ -300,6 +314,8 @@ show_help_msg(const char wrong_arg[])
 	puts("    vifm /path/to/start/dir/one  /path/to/start/dir/two\n");
 	puts("  To open file using associated program pass to vifm it's path.\n");
 	puts("  To select file prepend its path with --select.\n");
+	puts("  To display list of files read from standard input in a pane use \"-\"");
+	puts("  instead of path to a directory.\n");
 	puts("  If no path is given vifm will start in the current working directory.\n");
 	puts("  vifm -f");
 	puts("    makes vifm instead of opening files write selection to");
@@ -25,7 +25,7 @@
 
 #include <pthread.h>
 
-#include <fcntl.h> /* open() */
+#include <fcntl.h> /* FD_CLOEXEC F_* O_NONBLOCK fcntl() open() */
 #include <unistd.h>
 
 #include <assert.h> /* assert() */
@@ -86,7 +86,6 @@ static job_t * add_background_job(pid_t pid, const char cmd[], HANDLE hprocess,
 		BgJobType type);
 #endif
 static void * background_task_bootstrap(void *arg);
-static void set_current_job(job_t *job);
 static void make_current_job_key(void);
 static void finish_current_job(void);
 
@@ -94,12 +93,15 @@ job_t *jobs;
 
 static pthread_key_t current_job;
 static pthread_once_t current_job_once = PTHREAD_ONCE_INIT;
+/* Protects fields of jobs updated by threads of background tasks, which can be
+ * several per job. */
+static pthread_mutex_t job_state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 void
 init_background(void)
 {
 	/* Initialize state for the main thread. */
-	set_current_job(NULL);
+	bg_set_current_job(NULL);
 }
 
 void
@@ -172,6 +174,33 @@ check_background_jobs(void)
 	bg_jobs_unfreeze();
 }
 
+#ifndef _WIN32
+
+int
+bg_get_error_fds(int fds[], int max)
+{
+	int count = 0;
+	job_t *job;
+
+	if(bg_jobs_freeze() != 0)
+	{
+		return 0;
+	}
+
+	for(job = jobs; job != NULL && count < max; job = job->next)
+	{
+		if(job->fd != NO_JOB_ID)
+		{
+			fds[count++] = job->fd;
+		}
+	}
+
+	bg_jobs_unfreeze();
+	return count;
+}
+
+#endif
+
 /* Checks status of the job.  Processes error stream or checks whether process
  * is still running. */
 static void
@@ -181,6 +210,7 @@ job_check(job_t *const job)
 	fd_set ready;
 	int max_fd = 0;
 	struct timeval ts = { .tv_sec = 0, .tv_usec = 1000 };
+	char *error;
 
 	/* Setup pipe for reading */
 	FD_ZERO(&ready);
@@ -190,15 +220,19 @@ job_check(job_t *const job)
 		max_fd = job->fd;
 	}
 
-	if(job->error != NULL)
+	/* The error is set by job's thread, so take it out under the lock. */
+	pthread_mutex_lock(&job_state_mutex);
+	error = job->error;
+	job->error = NULL;
+	pthread_mutex_unlock(&job_state_mutex);
+
+	if(error != NULL)
 	{
 		if(!job->skip_errors)
 		{
-			job->skip_errors = prompt_error_msg("Background Process Error",
-					job->error);
+			job->skip_errors = prompt_error_msg("Background Process Error", error);
 		}
-		free(job->error);
-		job->error = NULL;
+		free(error);
 	}
 
 	while(select(max_fd + 1, &ready, NULL, NULL, &ts) > 0)
@@ -208,6 +242,9 @@ job_check(job_t *const job)
 		const ssize_t nread = read(job->fd, err_msg, sizeof(err_msg) - 1);
 		if(nread == 0)
 		{
+			/* Stream is at its end and would be always reported as readable. */
+			close(job->fd);
+			job->fd = NO_JOB_ID;
 			break;
 		}
 		else if(nread > 0 && !job->skip_errors)
@@ -342,7 +379,9 @@ error_msg(const char *title, const char *text)
 	}
 	else
 	{
+		pthread_mutex_lock(&job_state_mutex);
 		(void)replace_string(&job->error, text);
+		pthread_mutex_unlock(&job_state_mutex);
 	}
 }
 #endif
@@ -434,7 +473,8 @@ background_and_wait_for_errors(char cmd[], int cancellable)
 
 #ifndef _WIN32
 pid_t
-background_and_capture(char *cmd, int user_sh, FILE **out, FILE **err)
+background_and_capture(char *cmd, int user_sh, int new_group, FILE **out,
+		FILE **err)
 {
 	pid_t pid;
 	int out_pipe[2];
@@ -467,6 +507,11 @@ background_and_capture(char *cmd, int user_sh, FILE **out, FILE **err)
 	{
 		char *args[4];
 
+		if(new_group)
+		{
+			setpgid(0, 0);
+		}
+
 		close(out_pipe[0]);
 		close(error_pipe[0]);
 		if(dup2(out_pipe[1], STDOUT_FILENO) == -1)
@@ -483,6 +528,12 @@ background_and_capture(char *cmd, int user_sh, FILE **out, FILE **err)
 		exit(-1);
 	}
 
+	/* Parent does the same to be sure the group exists when it's signaled. */
+	if(new_group)
+	{
+		(void)setpgid(pid, pid);
+	}
+
 	close(out_pipe[1]);
 	close(error_pipe[1]);
 	*out = fdopen(out_pipe[0], "r");
@@ -490,6 +541,43 @@ background_and_capture(char *cmd, int user_sh, FILE **out, FILE **err)
 
 	return pid;
 }
+
+pid_t
+bg_run_and_capture(char cmd[], int *fd)
+{
+	pid_t pid;
+	int out_pipe[2];
+
+	if(pipe(out_pipe) != 0)
+	{
+		return (pid_t)-1;
+	}
+
+	if((pid = fork()) == -1)
+	{
+		close(out_pipe[0]);
+		close(out_pipe[1]);
+		return (pid_t)-1;
+	}
+
+	if(pid == 0)
+	{
+		/* Make the command leader of a group to be able to kill its children. */
+		setpgid(0, 0);
+		run_from_fork(out_pipe, 0, cmd);
+	}
+
+	/* Do the same in the parent, otherwise the group might not exist yet when
+	 * it's signaled. */
+	(void)setpgid(pid, pid);
+
+	close(out_pipe[1]);
+	(void)fcntl(out_pipe[0], F_SETFL, fcntl(out_pipe[0], F_GETFL) | O_NONBLOCK);
+	(void)fcntl(out_pipe[0], F_SETFD, FD_CLOEXEC);
+
+	*fd = out_pipe[0];
+	return pid;
+}
 #else
 /* Runs command in a background and redirects its stdout and stderr streams to
  * file streams which are set.  Returns (pid_t)0 or (pid_t)-1 on error. */
@@ -564,7 +652,8 @@ background_and_capture_internal(char cmd[], int user_sh, FILE **out, FILE **err,
 }
 
 pid_t
-background_and_capture(char cmd[], int user_sh, FILE **out, FILE **err)
+background_and_capture(char cmd[], int user_sh, int new_group, FILE **out,
+		FILE **err)
 {
 	int out_fd, out_pipe[2];
 	int err_fd, err_pipe[2];
@@ -725,11 +814,20 @@ inner_bg_next(void)
 	job_t *job = pthread_getspecific(current_job);
 	if(job != NULL)
 	{
+		pthread_mutex_lock(&job_state_mutex);
 		++job->done;
 		assert(job->done <= job->total);
+		pthread_mutex_unlock(&job_state_mutex);
 	}
 }
 
+job_t *
+bg_get_current_job(void)
+{
+	pthread_once(&current_job_once, &make_current_job_key);
+	return pthread_getspecific(current_job);
+}
+
 int
 bg_execute(const char desc[], int total, int important, bg_task_func task_func,
 		void *args)
@@ -809,7 +907,7 @@ background_task_bootstrap(void *arg)
 {
 	background_task_args *const task_args = arg;
 
-	set_current_job(task_args->job);
+	bg_set_current_job(task_args->job);
 
 	task_args->func(task_args->args);
 
@@ -820,9 +918,8 @@ background_task_bootstrap(void *arg)
 	return NULL;
 }
 
-/* Stores pointer to the job in a thread-local storage. */
-static void
-set_current_job(job_t *job)
+void
+bg_set_current_job(job_t *job)
 {
 	pthread_once(&current_job_once, &make_current_job_key);
 	(void)pthread_setspecific(current_job, job);
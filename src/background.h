@@ -88,15 +88,44 @@ int background_and_wait_for_status(char cmd[], int cancellable, int *cancelled);
 int background_and_wait_for_errors(char cmd[], int cancellable);
 
 /* Runs command in a background and redirects its stdout and stderr streams to
- * file streams which are set.  Returns id of background process ((pid_t)0 for
+ * file streams which are set.  On *nix the command can be started in a new
+ * process group (id of which is id of the process), so that it can be killed
+ * along with its children.  Returns id of background process ((pid_t)0 for
  * non-*nix like systems) or (pid_t)-1 on error. */
-pid_t background_and_capture(char cmd[], int user_sh, FILE **out, FILE **err);
+pid_t background_and_capture(char cmd[], int user_sh, int new_group,
+		FILE **out, FILE **err);
+
+#ifndef _WIN32
+/* Runs command in background redirecting both its output streams to a pipe,
+ * non-blocking read end of which is stored in *fd.  The command is started in
+ * a new process group, which can be killed along with children of the command.
+ * Returns id of the process, which is also id of the group, or (pid_t)-1 on
+ * error. */
+pid_t bg_run_and_capture(char cmd[], int *fd);
+#endif
 
 void add_finished_job(pid_t pid, int status);
 void check_background_jobs(void);
 
+#ifndef _WIN32
+/* Collects descriptors of error streams of external commands, which become
+ * readable when check_background_jobs() has something to process.  Returns
+ * number of descriptors stored in fds, which is at most max. */
+int bg_get_error_fds(int fds[], int max);
+#endif
+
+/* Marks one more item of current background task as processed.  Can be called
+ * from several threads of the same task. */
 void inner_bg_next(void);
 
+/* Retrieves background job of the calling thread.  Returns the job or NULL for
+ * threads that don't perform background tasks. */
+job_t * bg_get_current_job(void);
+
+/* Makes calling thread (e.g. a helper thread of a background task) report its
+ * errors and progress to the job. */
+void bg_set_current_job(job_t *job);
+
 /* Start new background task, executed in a separate thread.  Returns zero on
  * success, otherwise non-zero is returned. */
 int bg_execute(const char desc[], int total, int important,
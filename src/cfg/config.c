@@ -157,6 +157,7 @@ cfg_init(void)
 	cfg.selection_is_primary = 1;
 	cfg.tab_switches_pane = 1;
 	cfg.use_system_calls = 0;
+	cfg.io_threads = 4;
 	cfg.tab_stop = 8;
 	cfg.ruler_format = strdup("%l/%S ");
 	cfg.status_line = strdup("");
@@ -192,6 +193,8 @@ cfg_init(void)
 	cfg.timeout_len = 1000;
 	cfg.min_timeout_len = 150;
 
+	cfg.preview_timeout = 500;
+
 	/* Fill cfg.word_chars as if it was initialized from isspace() fuction. */
 	memset(&cfg.word_chars, 1, sizeof(cfg.word_chars));
 	cfg.word_chars['\x00'] = 0; cfg.word_chars['\x09'] = 0;
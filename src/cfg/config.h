@@ -111,6 +111,7 @@ typedef struct config_t
 	int selection_is_primary; /* For yy, dd and DD: act on selection not file. */
 	int tab_switches_pane; /* Whether <tab> is switch pane or history forward. */
 	int use_system_calls; /* Prefer performing operations with system calls. */
+	int io_threads; /* Max number of threads of background file operations. */
 	int tab_stop;
 	char *ruler_format;
 	char *status_line;
@@ -153,6 +154,9 @@ typedef struct config_t
 	int timeout_len;     /* Maximum period on waiting for the input. */
 	int min_timeout_len; /* Minimum period on waiting for the input. */
 
+	/* Time to wait for output of a viewer before showing it in background. */
+	int preview_timeout;
+
 	char word_chars[256]; /* Whether corresponding character is a word char. */
 }
 config_t;
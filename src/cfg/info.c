@@ -902,10 +902,12 @@ write_options(FILE *const fp)
 	fprintf(fp, "=%siec\n", cfg.use_iec_prefixes ? "" : "no");
 	fprintf(fp, "=%signorecase\n", cfg.ignore_case ? "" : "no");
 	fprintf(fp, "=%sincsearch\n", cfg.inc_search ? "" : "no");
+	fprintf(fp, "=iothreads=%d\n", cfg.io_threads);
 	fprintf(fp, "=%slaststatus\n", cfg.display_statusline ? "" : "no");
 	fprintf(fp, "=lines=%d\n", cfg.lines);
 	fprintf(fp, "=locateprg=%s\n", escape_spaces(cfg.locate_prg));
 	fprintf(fp, "=mintimeoutlen=%d\n", cfg.min_timeout_len);
+	fprintf(fp, "=previewtimeout=%d\n", cfg.preview_timeout);
 	fprintf(fp, "=rulerformat=%s\n", escape_spaces(cfg.ruler_format));
 	fprintf(fp, "=%srunexec\n", cfg.auto_execute ? "" : "no");
 	fprintf(fp, "=%sscrollbind\n", cfg.scroll_bind ? "" : "no");
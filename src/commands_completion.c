@@ -92,6 +92,7 @@ static int is_dirent_targets_exec(const struct dirent *d);
 #ifdef _WIN32
 static void complete_with_shared(const char *server, const char *file);
 #endif
+static const char * parse_cmd(const char cmd[], int *is_path);
 
 int
 complete_args(int id, const cmd_info_t *cmd_info, int arg_pos, void *extra_arg)
@@ -653,14 +654,38 @@ complete_command_name(const char beginning[])
 	int i;
 	char ** paths;
 	size_t paths_count;
+	const size_t len = strlen(beginning);
 
 	paths = get_paths(&paths_count);
 	for(i = 0; i < paths_count; i++)
 	{
-		if(vifm_chdir(paths[i]) == 0)
+		int j, count;
+		char **const names = get_path_dir_files(i, &count);
+		if(names == NULL)
 		{
-			filename_completion(beginning, CT_EXECONLY);
+			if(vifm_chdir(paths[i]) == 0)
+			{
+				filename_completion(beginning, CT_EXECONLY);
+			}
+			continue;
+		}
+
+		for(j = 0; j < count; ++j)
+		{
+			char path[PATH_MAX];
+
+			if(beginning[0] == '\0' && names[j][0] == '.')
+				continue;
+			if(strnoscmp(names[j], beginning, len) != 0)
+				continue;
+
+			snprintf(path, sizeof(path), "%s/%s", paths[i], names[j]);
+			if(executable_exists(path))
+			{
+				vle_compl_add_path_match(names[j]);
+			}
 		}
+		vle_compl_finish_group();
 	}
 	vle_compl_add_last_path_match(beginning);
 }
@@ -917,24 +942,25 @@ complete_with_shared(const char *server, const char *file)
 int
 external_command_exists(const char cmd[])
 {
-	char path[PATH_MAX];
+	int is_path;
+	cmd = parse_cmd(cmd, &is_path);
 
-	if(get_cmd_path(cmd, sizeof(path), path) == 0)
+	if(is_path)
 	{
-		return executable_exists(path);
+		return executable_exists(cmd);
 	}
-	return 0;
+
+	/* The check for being executable is done during the search. */
+	return (find_cmd_in_path(cmd, 0UL, NULL) == 0);
 }
 
 int
 get_cmd_path(const char cmd[], size_t path_len, char path[])
 {
-	if(starts_with(cmd, "!!"))
-	{
-		cmd += 2;
-	}
+	int is_path;
+	cmd = parse_cmd(cmd, &is_path);
 
-	if(contains_slash(cmd))
+	if(is_path)
 	{
 		copy_str(path, path_len, cmd);
 		return 0;
@@ -945,5 +971,20 @@ get_cmd_path(const char cmd[], size_t path_len, char path[])
 	}
 }
 
+/* Skips optional "!!" prefix of the command and checks whether it's specified
+ * by a path rather than by a name to be looked up in $PATH.  Returns pointer to
+ * the command without the prefix. */
+static const char *
+parse_cmd(const char cmd[], int *is_path)
+{
+	if(starts_with(cmd, "!!"))
+	{
+		cmd += 2;
+	}
+
+	*is_path = contains_slash(cmd);
+	return cmd;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
@@ -21,17 +21,23 @@
 
 #include <curses.h>
 
+#ifndef _WIN32
+#include <poll.h> /* POLLIN poll() pollfd */
+#include <sys/time.h> /* gettimeofday() timeval */
+#endif
 #include <unistd.h> /* select() */
 
 #include <assert.h> /* assert() */
 #include <signal.h> /* signal() */
 #include <stddef.h> /* NULL size_t wchar_t wint_t */
+#include <stdio.h> /* fileno() stdin */
 #include <string.h> /* memmove() strncpy() */
 #include <wchar.h> /* wcslen() wcscmp() */
 
 #include "cfg/config.h"
 #include "engine/keys.h"
 #include "engine/mode.h"
+#include "menus/menus.h"
 #include "modes/modes.h"
 #include "ui/statusbar.h"
 #include "ui/ui.h"
@@ -42,10 +48,17 @@
 #include "filelist.h"
 #include "fileview.h"
 #include "ipc.h"
+#include "quickview.h"
 #include "status.h"
 
 static int ensure_term_is_ready(void);
 static int get_char_async_loop(WINDOW *win, wint_t *c, int timeout);
+#ifndef _WIN32
+static int should_wake_up_periodically(int check_views);
+static void wait_for_events(int timeout, int check_views);
+static int add_watch_fd(struct pollfd fds[], int count, const FileView *view);
+static int ms_since(const struct timeval *since);
+#endif
 static void process_scheduled_updates(void);
 static void process_scheduled_updates_of_view(FileView *view);
 static int should_check_views_for_changes(void);
@@ -258,6 +271,207 @@ ensure_term_is_ready(void)
 	return 1;
 }
 
+#ifndef _WIN32
+
+/* Maximum number of descriptors of background jobs to wait on at once. */
+#define MAX_JOB_FDS 32
+
+/* Sub-loop of the main loop that "asynchronously" queries for the input
+ * performing the following tasks while waiting for input:
+ *  - checks for new IPC messages;
+ *  - checks whether contents of displayed directories changed;
+ *  - processes output of background jobs and file viewer;
+ *  - redraws UI if requested.
+ * Sleeps until one of these things needs attention, waking up periodically only
+ * when something can't be waited on.  Returns KEY_CODE_YES for functional keys,
+ * OK for wide character and ERR otherwise (e.g. after timeout). */
+static int
+get_char_async_loop(WINDOW *win, wint_t *c, int timeout)
+{
+	struct timeval start;
+	(void)gettimeofday(&start, NULL);
+
+	/* Input is waited for by poll(), curses should only fetch it. */
+	wtimeout(win, 0);
+
+	while(1)
+	{
+		int result;
+		int wait_time;
+		int prefetching;
+		const int check_views = should_check_views_for_changes();
+
+		ipc_check();
+		process_scheduled_updates();
+		prefetching = qv_check_prefetching();
+
+		if(check_views)
+		{
+			check_view_for_changes(curr_view);
+			check_view_for_changes(other_view);
+		}
+
+		result = wget_wch(win, c);
+		if(result != ERR)
+		{
+			return result;
+		}
+
+		wait_time = timeout - ms_since(&start);
+		if(wait_time <= 0)
+		{
+			return ERR;
+		}
+
+		/* Viewer run in advance can hang without producing any output. */
+		if(prefetching || should_wake_up_periodically(check_views))
+		{
+			wait_time = MIN(cfg.min_timeout_len, wait_time);
+		}
+
+		wait_for_events(wait_time, check_views);
+	}
+}
+
+/* Checks whether there are things that need to be checked periodically as they
+ * can't be waited for.  Returns non-zero if so, otherwise zero is returned. */
+static int
+should_wake_up_periodically(int check_views)
+{
+	/* Background tasks report progress and schedule redraws from other
+	 * threads. */
+	if(jobs != NULL)
+	{
+		return 1;
+	}
+
+	if(check_views)
+	{
+		if(window_shows_dirlist(curr_view) && flist_watch_fd(curr_view) == -1)
+		{
+			return 1;
+		}
+		if(window_shows_dirlist(other_view) && flist_watch_fd(other_view) == -1)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Sleeps for at most timeout milliseconds or until there is input, IPC message,
+ * output of background job or file viewer or change of directory displayed in
+ * a view (the last one only if check_views is non-zero).  Processes output of
+ * background jobs and file viewer. */
+static void
+wait_for_events(int timeout, int check_views)
+{
+	struct pollfd fds[6 + MAX_JOB_FDS];
+	int job_fds[MAX_JOB_FDS];
+	int count = 0;
+	int first_job_fd;
+	int njob_fds;
+	int ipc_fd;
+	int viewer_fd;
+	int viewer_fd_pos = -1;
+	int capture_fd;
+	int capture_fd_pos = -1;
+	int i;
+
+	fds[count].fd = fileno(stdin);
+	fds[count++].events = POLLIN;
+
+	ipc_fd = ipc_get_fd();
+	if(ipc_fd != -1)
+	{
+		fds[count].fd = ipc_fd;
+		fds[count++].events = POLLIN;
+	}
+
+	if(check_views)
+	{
+		count = add_watch_fd(fds, count, curr_view);
+		count = add_watch_fd(fds, count, other_view);
+	}
+
+	viewer_fd = qv_viewer_fd();
+	if(viewer_fd != -1)
+	{
+		viewer_fd_pos = count;
+		fds[count].fd = viewer_fd;
+		fds[count++].events = POLLIN;
+	}
+
+	capture_fd = menu_capture_fd();
+	if(capture_fd != -1)
+	{
+		capture_fd_pos = count;
+		fds[count].fd = capture_fd;
+		fds[count++].events = POLLIN;
+	}
+
+	first_job_fd = count;
+	njob_fds = bg_get_error_fds(job_fds, MAX_JOB_FDS);
+	for(i = 0; i < njob_fds; ++i)
+	{
+		fds[count].fd = job_fds[i];
+		fds[count++].events = POLLIN;
+	}
+
+	/* Signals (e.g., SIGWINCH or SIGCHLD) interrupt the wait, which is fine. */
+	if(poll(fds, count, timeout) <= 0)
+	{
+		return;
+	}
+
+	if(viewer_fd_pos != -1 && fds[viewer_fd_pos].revents != 0)
+	{
+		qv_check_viewer();
+	}
+
+	if(capture_fd_pos != -1 && fds[capture_fd_pos].revents != 0)
+	{
+		menu_check_capture();
+	}
+
+	for(i = first_job_fd; i < count; ++i)
+	{
+		if(fds[i].revents != 0)
+		{
+			check_background_jobs();
+			break;
+		}
+	}
+}
+
+/* Adds descriptor of directory watcher of the view to the array if the view has
+ * it.  Returns new number of elements in the array. */
+static int
+add_watch_fd(struct pollfd fds[], int count, const FileView *view)
+{
+	const int fd = flist_watch_fd(view);
+	if(fd != -1 && window_shows_dirlist(view))
+	{
+		fds[count].fd = fd;
+		fds[count++].events = POLLIN;
+	}
+	return count;
+}
+
+/* Computes time passed since the moment in time.  Returns the difference in
+ * milliseconds. */
+static int
+ms_since(const struct timeval *since)
+{
+	struct timeval now;
+	(void)gettimeofday(&now, NULL);
+	return (now.tv_sec - since->tv_sec)*1000
+	     + (now.tv_usec - since->tv_usec)/1000;
+}
+
+#else
+
 /* Sub-loop of the main loop that "asynchronously" queries for the input
  * performing the following tasks while waiting for input:
  *  - checks for new IPC messages;
@@ -305,6 +519,8 @@ get_char_async_loop(WINDOW *win, wint_t *c, int timeout)
 	return ERR;
 }
 
+#endif
+
 /* Updates TUI or its elements if something is scheduled. */
 static void
 process_scheduled_updates(void)
@@ -28,6 +28,7 @@
 
 #include <curses.h>
 
+#include <fcntl.h> /* O_DIRECTORY O_RDONLY open() */
 #include <sys/stat.h> /* stat */
 #include <unistd.h> /* close() fork() pipe() */
 
@@ -46,6 +47,7 @@
 #include "engine/mode.h"
 #include "modes/dialogs/msg_dialog.h"
 #include "modes/modes.h"
+#include "ui/cancellation.h"
 #include "ui/statusbar.h"
 #include "ui/statusline.h"
 #include "ui/ui.h"
@@ -56,9 +58,10 @@
 #include "utils/log.h"
 #include "utils/macros.h"
 #include "utils/path.h"
+#include "utils/stat_batch.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
-#include "utils/tree.h"
+#include "utils/string_map.h"
 #include "utils/utf8.h"
 #include "utils/utils.h"
 #include "fileview.h"
@@ -77,9 +80,24 @@ typedef struct
 	FileView *const view; /* View being filled. */
 	const int is_root;    /* Whether we're at file system root. */
 	int with_parent_dir;  /* Whether parent direcotory was seen during filling. */
+
+	const int stream;     /* Whether partial list is drawn during filling. */
+	int published;        /* Number of entries that are ready to be displayed. */
+	int next_publish;     /* Number of entries to trigger next publishing. */
+	int interrupted;      /* Whether filling was interrupted by user. */
+
+	int capacity;         /* Number of entries view->dir_entry can hold. */
 }
 dir_fill_info_t;
 
+/* Number of directory entries processed by a single thread at a time during
+ * loading of meta-data. */
+#define STAT_BATCH_SIZE 512
+
+/* Minimal number of entries to be loaded before partial file list is drawn for
+ * the first time. */
+#define STREAM_FIRST_CHUNK 64
+
 /* Type of predicate functions to reason about entries.  Should return non-zero
  * if particular property holds and zero otherwise. */
 typedef int (*predicate_func)(const dir_entry_t *entry);
@@ -96,18 +114,39 @@ static void move_cursor_out_of_scope(FileView *view, predicate_func pred);
 static void navigate_to_history_pos(FileView *view, int pos);
 static void save_selection(FileView *view);
 static void free_saved_selection(FileView *view);
+static int refill_dir_list(FileView *view, int stream, int *interrupted);
 static int add_file_entry_to_view(const char name[], const void *data,
 		void *param);
+static void publish_entries(dir_fill_info_t *info);
 static int fill_dir_entry_by_path(dir_entry_t *entry, const char path[]);
 #ifndef _WIN32
+static void fill_dir_entries(FileView *view, int from);
+static void fill_custom_entries(FileView *view);
+static int stat_entries(FileView *view, dir_entry_t entries[],
+		stat_batch_item_t items[], int count);
 static int fill_dir_entry(dir_entry_t *entry, const char path[],
 		const struct dirent *d);
+static int fill_dir_entry_from_stat(dir_entry_t *entry, const char path[],
+		const struct stat *s, FileType type_hint);
 static int data_is_dir_entry(const struct dirent *d);
 #else
 static int fill_dir_entry(dir_entry_t *entry, const char path[],
 		const WIN32_FIND_DATAW *ffd);
 static int data_is_dir_entry(const WIN32_FIND_DATAW *ffd);
 #endif
+#ifndef _WIN32
+static int check_dir_watcher(FileView *view);
+static int apply_dir_changes(FileView *view, const filemon_change_t changes[],
+		int count);
+static int add_changed_entry(FileView *view, const char name[], int *hidden);
+static void update_filtered_count(FileView *view,
+		const filemon_change_t *change, int hidden, int *recount);
+static void remove_changed_entry(FileView *view, int pos);
+static int count_filtered_out(const char name[], const void *data,
+		void *param);
+static int is_entry_filtered_out(FileView *view, const char name[],
+		int is_dir);
+#endif
 static void load_dir_list_internal(FileView *view, int reload, int draw_only);
 static int populate_dir_list_internal(FileView *view, int reload);
 static int is_dead_or_filtered(FileView *view, const dir_entry_t *entry,
@@ -120,7 +159,10 @@ static int rescue_from_empty_filelist(FileView *view);
 static void init_dir_entry(FileView *view, dir_entry_t *entry,
 		const char name[]);
 static void free_dir_entries(FileView *view, dir_entry_t **entries, int *count);
+static void free_dir_entry_keys(dir_entry_t *entry);
 static dir_entry_t * alloc_dir_entry(dir_entry_t **list, int list_size);
+static dir_entry_t * grow_dir_entries(dir_entry_t **list, int list_size,
+		int *capacity);
 static int file_can_be_displayed(const char directory[], const char filename[]);
 static void find_dir_in_cdpath(const char base_dir[], const char dst[],
 		char buf[], size_t buf_size);
@@ -1133,18 +1175,32 @@ win_to_unix_time(FILETIME ft)
 }
 #endif
 
+/* Fills view with list of files of its current directory.  When stream is
+ * non-zero, partial list is drawn as entries are loaded and user can interrupt
+ * the process, in which case *interrupted is set to non-zero value.  Returns
+ * non-zero on error. */
 static int
-refill_dir_list(FileView *view)
+refill_dir_list(FileView *view, int stream, int *interrupted)
 {
 	dir_fill_info_t info = {
 		.view = view,
 		.is_root = is_root_dir(view->curr_dir),
 		.with_parent_dir = 0,
+
+		.stream = stream,
+		.published = 0,
+		.next_publish = MAX(STREAM_FIRST_CHUNK, (int)view->window_cells),
+		.interrupted = 0,
+
+		.capacity = 0,
 	};
+	int result;
 
 	view->matches = 0;
 	free_view_entries(view);
 
+	*interrupted = 0;
+
 #ifdef _WIN32
 	if(is_unc_root(view->curr_dir))
 	{
@@ -1153,12 +1209,46 @@ refill_dir_list(FileView *view)
 	}
 #endif
 
-	if(enum_dir_content(view->curr_dir, &add_file_entry_to_view, &info) != 0)
+	if(stream)
+	{
+		/* Partial list is drawn from the top. */
+		view->list_pos = 0;
+		view->top_line = 0;
+		view->curr_line = 0;
+
+		ui_cancellation_reset();
+		ui_cancellation_enable();
+	}
+
+	result = enum_dir_content(view->curr_dir, &add_file_entry_to_view, &info);
+
+	if(stream)
+	{
+		ui_cancellation_disable();
+		*interrupted = info.interrupted;
+	}
+
+	if(result != 0)
 	{
 		LOG_SERROR_MSG(errno, "Can't opendir() \"%s\"", view->curr_dir);
 		return 1;
 	}
 
+#ifndef _WIN32
+	fill_dir_entries(view, info.published);
+#endif
+
+	/* Give back memory reserved for entries that never came. */
+	if(info.capacity > view->list_rows && view->list_rows != 0)
+	{
+		dir_entry_t *const list = realloc(view->dir_entry,
+				sizeof(dir_entry_t)*view->list_rows);
+		if(list != NULL)
+		{
+			view->dir_entry = list;
+		}
+	}
+
 #ifdef _WIN32
 	/* Not all Windows file systems provide standard dot directories. */
 	if(!info.with_parent_dir && cfg_parent_dir_is_visible(info.is_root))
@@ -1215,7 +1305,7 @@ add_file_entry_to_view(const char name[], const void *data, void *param)
 		return 0;
 	}
 
-	entry = alloc_dir_entry(&view->dir_entry, view->list_rows);
+	entry = grow_dir_entries(&view->dir_entry, view->list_rows, &info->capacity);
 	if(entry == NULL)
 	{
 		show_error_msg("Memory Error", "Unable to allocate enough memory");
@@ -1224,6 +1314,12 @@ add_file_entry_to_view(const char name[], const void *data, void *param)
 
 	init_dir_entry(view, entry, name);
 
+#ifndef _WIN32
+	/* Meta-data is queried for groups of entries after they are enumerated, just
+	 * remember type reported by directory entry as a fallback. */
+	entry->type = type_from_dir_entry(data);
+	++view->list_rows;
+#else
 	if(fill_dir_entry(entry, entry->name, data) == 0)
 	{
 		++view->list_rows;
@@ -1232,10 +1328,49 @@ add_file_entry_to_view(const char name[], const void *data, void *param)
 	{
 		free_dir_entry(view, entry);
 	}
+#endif
+
+	if(info->stream)
+	{
+		if(view->list_rows >= info->next_publish)
+		{
+			publish_entries(info);
+		}
+
+		if(ui_cancellation_requested())
+		{
+			info->interrupted = 1;
+			return 1;
+		}
+	}
 
 	return 0;
 }
 
+/* Makes entries loaded so far visible to the user by drawing partial file list.
+ * The list will be sorted and drawn once again after all entries are
+ * loaded. */
+static void
+publish_entries(dir_fill_info_t *info)
+{
+	FileView *const view = info->view;
+
+#ifndef _WIN32
+	fill_dir_entries(view, info->published);
+#endif
+	info->published = view->list_rows;
+	/* Double the size of every next chunk to keep amount of work linear. */
+	info->next_publish = view->list_rows*2;
+
+	sort_view(view);
+	fview_list_updated(view);
+	draw_dir_list_only(view);
+	refresh_view_win(view);
+
+	ui_sb_quick_msgf("Reading directory... %d (press Ctrl-C to interrupt)",
+			view->list_rows);
+}
+
 char *
 get_typed_current_fname(const FileView *view)
 {
@@ -1269,29 +1404,40 @@ void
 flist_custom_start(FileView *view, const char title[])
 {
 	free_dir_entries(view, &view->custom.entries, &view->custom.entry_count);
+	view->custom.capacity = 0;
 	(void)replace_string(&view->custom.title, title);
+
+	string_map_free(view->custom.paths, NULL);
+	view->custom.paths = string_map_create();
 }
 
 void
 flist_custom_add(FileView *view, const char path[])
 {
 	char canonic_path[PATH_MAX];
+	char key[PATH_MAX];
 	dir_entry_t *dir_entry;
 
-	/* Don't add duplicates. */
-	if(entry_from_path(view->custom.entries, view->custom.entry_count,
-				path) != NULL)
+	if(to_canonic_path(path, canonic_path, sizeof(canonic_path)) != 0)
 	{
 		return;
 	}
 
-	dir_entry = alloc_dir_entry(&view->custom.entries, view->custom.entry_count);
-	if(dir_entry == NULL)
+	copy_str(key, sizeof(key), canonic_path);
+#ifdef _WIN32
+	str_to_lower(key);
+#endif
+
+	/* Don't add duplicates. */
+	if(view->custom.paths != NULL &&
+			string_map_get(view->custom.paths, key) != NULL)
 	{
 		return;
 	}
 
-	if(to_canonic_path(path, canonic_path, sizeof(canonic_path)) != 0)
+	dir_entry = grow_dir_entries(&view->custom.entries, view->custom.entry_count,
+			&view->custom.capacity);
+	if(dir_entry == NULL)
 	{
 		return;
 	}
@@ -1301,11 +1447,19 @@ flist_custom_add(FileView *view, const char path[])
 	dir_entry->origin = strdup(canonic_path);
 	remove_last_path_component(dir_entry->origin);
 
+#ifdef _WIN32
 	if(fill_dir_entry_by_path(dir_entry, canonic_path) != 0)
 	{
 		free_dir_entry(view, dir_entry);
 		return;
 	}
+#endif
+
+	/* Value is irrelevant, it just needs to be non-NULL. */
+	if(view->custom.paths != NULL)
+	{
+		(void)string_map_set(view->custom.paths, key, view->custom.paths);
+	}
 
 	++view->custom.entry_count;
 }
@@ -1320,6 +1474,139 @@ fill_dir_entry_by_path(dir_entry_t *entry, const char path[])
 	return fill_dir_entry(entry, path, NULL);
 }
 
+/* Fills meta-data of entries of the view starting with the from-th one that
+ * were just enumerated by add_file_entry_to_view() (which should be relative to
+ * current working directory) querying files in parallel.  Entries for which
+ * this operation fails are removed preserving relative order of the rest, so
+ * the result is the same as if entries were processed one by one. */
+static void
+fill_dir_entries(FileView *view, int from)
+{
+	const int count = view->list_rows - from;
+	stat_batch_item_t *items;
+	int i;
+
+	if(count <= 0)
+	{
+		return;
+	}
+
+	items = malloc(sizeof(*items)*count);
+	if(items == NULL)
+	{
+		show_error_msg("Memory Error", "Unable to allocate enough memory");
+		free_view_entries(view);
+		return;
+	}
+
+	for(i = 0; i < count; ++i)
+	{
+		items[i].name = view->dir_entry[from + i].name;
+	}
+
+	view->list_rows = from + stat_entries(view, &view->dir_entry[from], items,
+			count);
+
+	free(items);
+}
+
+/* Fills meta-data of entries of custom view that were added by
+ * flist_custom_add() querying files in parallel.  Entries for which this
+ * operation fails are removed preserving relative order of the rest. */
+static void
+fill_custom_entries(FileView *view)
+{
+	const int count = view->custom.entry_count;
+	stat_batch_item_t *items;
+	int i;
+
+	if(count == 0)
+	{
+		return;
+	}
+
+	items = malloc(sizeof(*items)*count);
+	if(items == NULL)
+	{
+		free_dir_entries(view, &view->custom.entries, &view->custom.entry_count);
+		return;
+	}
+
+	for(i = 0; i < count; ++i)
+	{
+		char full_path[PATH_MAX];
+		get_full_path_of(&view->custom.entries[i], sizeof(full_path), full_path);
+		items[i].name = strdup(full_path);
+		if(items[i].name == NULL)
+		{
+			/* Make stat_batch() fail for this entry. */
+			items[i].name = "";
+		}
+	}
+
+	view->custom.entry_count = stat_entries(view, view->custom.entries, items,
+			count);
+
+	for(i = 0; i < count; ++i)
+	{
+		if(items[i].name[0] != '\0')
+		{
+			free((char *)items[i].name);
+		}
+	}
+	free(items);
+}
+
+/* Queries meta-data of count entries by paths specified in items (relative
+ * ones are resolved against current working directory) in parallel and fills
+ * the entries.  Entries for which this operation fails are freed and removed
+ * preserving relative order of the rest, so the result is the same as if
+ * entries were processed one by one.  Returns new number of entries. */
+static int
+stat_entries(FileView *view, dir_entry_t entries[], stat_batch_item_t items[],
+		int count)
+{
+	int dirfd;
+	int i, j;
+
+	dirfd = open(".", O_RDONLY | O_DIRECTORY);
+	stat_batch((dirfd == -1) ? AT_FDCWD : dirfd, items, count,
+			stat_batch_workers(count, STAT_BATCH_SIZE), STAT_BATCH_SIZE);
+	if(dirfd != -1)
+	{
+		close(dirfd);
+	}
+
+	j = 0;
+	for(i = 0; i < count; ++i)
+	{
+		dir_entry_t *const entry = &entries[i];
+
+		if(items[i].error != 0)
+		{
+			LOG_SERROR_MSG(items[i].error, "Can't lstat() \"%s\"", items[i].name);
+			free_dir_entry(view, entry);
+			continue;
+		}
+
+		if(fill_dir_entry_from_stat(entry, items[i].name, &items[i].st,
+					entry->type) != 0)
+		{
+			free_dir_entry(view, entry);
+			continue;
+		}
+
+		if(i != j)
+		{
+			entries[j] = *entry;
+		}
+
+		++j;
+	}
+
+	return j;
+}
+
 /* Fills fields of the entry from stat information of the file specified by its
  * path.  d is optional source of file type.  Returns zero on success, otherwise
  * non-zero is returned. */
@@ -1335,10 +1622,21 @@ fill_dir_entry(dir_entry_t *entry, const char path[], const struct dirent *d)
 		return 1;
 	}
 
-	entry->type = get_type_from_mode(s.st_mode);
+	return fill_dir_entry_from_stat(entry, path, &s,
+			(d == NULL) ? FT_UNK : type_from_dir_entry(d));
+}
+
+/* Fills fields of the entry from the *s for the file specified by its path.
+ * type_hint is used when type can't be determined by the *s.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+fill_dir_entry_from_stat(dir_entry_t *entry, const char path[],
+		const struct stat *s, FileType type_hint)
+{
+	entry->type = get_type_from_mode(s->st_mode);
 	if(entry->type == FT_UNK)
 	{
-		entry->type = (d == NULL) ? FT_UNK : type_from_dir_entry(d);
+		entry->type = type_hint;
 	}
 	if(entry->type == FT_UNK)
 	{
@@ -1346,24 +1644,34 @@ fill_dir_entry(dir_entry_t *entry, const char path[], const struct dirent *d)
 		return 1;
 	}
 
-	entry->size = (uintmax_t)s.st_size;
-	entry->mode = s.st_mode;
-	entry->uid = s.st_uid;
-	entry->gid = s.st_gid;
-	entry->mtime = s.st_mtime;
-	entry->atime = s.st_atime;
-	entry->ctime = s.st_ctime;
+	entry->size = (uintmax_t)s->st_size;
+	entry->mode = s->st_mode;
+	entry->uid = s->st_uid;
+	entry->gid = s->st_gid;
+	entry->mtime = s->st_mtime;
+	entry->atime = s->st_atime;
+	entry->ctime = s->st_ctime;
+
+	entry->broken_link = 0;
 
 	if(entry->type == FT_LINK)
 	{
-		/* Query mode of symbolic link target. */
+		/* Query mode of symbolic link target.  Targets on slow file system are
+		 * assumed to be not broken as actual check might take long time. */
 
-		struct stat s;
+		struct stat target;
 
-		const SymLinkType symlink_type = get_symlink_type(entry->name);
-		if(symlink_type != SLT_SLOW && os_stat(entry->name, &s) == 0)
+		const SymLinkType symlink_type = get_symlink_type(path);
+		if(symlink_type != SLT_SLOW)
 		{
-			entry->mode = s.st_mode;
+			if(os_stat(path, &target) == 0)
+			{
+				entry->mode = target.st_mode;
+			}
+			else
+			{
+				entry->broken_link = 1;
+			}
 		}
 	}
 
@@ -1418,9 +1726,24 @@ fill_dir_entry(dir_entry_t *entry, const char path[],
 	entry->atime = win_to_unix_time(ffd->ftLastAccessTime);
 	entry->ctime = win_to_unix_time(ffd->ftCreationTime);
 
+	entry->broken_link = 0;
+
 	if(is_win_symlink(ffd->dwFileAttributes, ffd->dwReserved0))
 	{
+		char target[PATH_MAX];
+
 		entry->type = FT_LINK;
+
+		/* Targets on slow file system are assumed to be not broken as actual
+		 * check might take long time. */
+		if(get_link_target_abs(path, entry->origin, target, sizeof(target)) != 0)
+		{
+			entry->broken_link = 1;
+		}
+		else if(!is_on_slow_fs(target))
+		{
+			entry->broken_link = !path_exists(target, DEREF);
+		}
 	}
 	else if(ffd->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
 	{
@@ -1451,6 +1774,13 @@ data_is_dir_entry(const WIN32_FIND_DATAW *ffd)
 int
 flist_custom_finish(FileView *view)
 {
+	string_map_free(view->custom.paths, NULL);
+	view->custom.paths = NULL;
+
+#ifndef _WIN32
+	fill_custom_entries(view);
+#endif
+
 	if(view->custom.entry_count == 0)
 	{
 		free_dir_entries(view, &view->custom.entries, &view->custom.entry_count);
@@ -1459,8 +1789,8 @@ flist_custom_finish(FileView *view)
 
 	if(cfg_parent_dir_is_visible(0))
 	{
-		dir_entry_t *const dir_entry = alloc_dir_entry(&view->custom.entries,
-				view->custom.entry_count);
+		dir_entry_t *const dir_entry = grow_dir_entries(&view->custom.entries,
+				view->custom.entry_count, &view->custom.capacity);
 		if(dir_entry != NULL)
 		{
 			init_dir_entry(view, dir_entry, "..");
@@ -1598,6 +1928,8 @@ static int
 populate_dir_list_internal(FileView *view, int reload)
 {
 	int need_free = (view->selected_filelist == NULL);
+	int stream = 0;
+	int interrupted;
 
 	view->filtered = 0;
 
@@ -1617,18 +1949,35 @@ populate_dir_list_internal(FileView *view, int reload)
 		return 0;
 	}
 
+#ifndef _WIN32
+	if(view->dir_watcher != NULL &&
+			stroscmp(view->watched_dir, view->curr_dir) == 0)
+	{
+		/* Whatever was reported so far is going to be picked up by reading the
+		 * directory below. */
+		filemon_change_t *changes;
+		const int count = filemon_read_changes(view->dir_watcher, &changes);
+		filemon_free_changes(changes, count);
+	}
+#endif
+
 	if(update_dir_mtime(view) != 0 && !is_unc_root(view->curr_dir))
 	{
 		LOG_SERROR_MSG(errno, "Can't get directory mtime \"%s\"", view->curr_dir);
 		return 1;
 	}
 
-	if(!reload && is_dir_big(view->curr_dir))
+	/* Incomplete list is reloaded in the same way it was loaded initially. */
+	if((!reload || view->list_incomplete) && is_dir_big(view->curr_dir))
 	{
 		if(!vle_mode_is(CMDLINE_MODE))
 		{
 			ui_sb_quick_msgf("%s", "Reading directory...");
 		}
+
+		/* Draw partial list for big directories, so that user doesn't have to wait
+		 * for the whole list to be loaded to see something. */
+		stream = (curr_stats.load_stage >= 2 && window_shows_dirlist(view));
 	}
 
 	if(curr_stats.load_stage < 2)
@@ -1648,7 +1997,7 @@ populate_dir_list_internal(FileView *view, int reload)
 		capture_selection(view);
 	}
 
-	if(refill_dir_list(view) != 0)
+	if(refill_dir_list(view, stream, &interrupted) != 0)
 	{
 		/* We don't have read access, only execute, or there were other problems. */
 		free_view_entries(view);
@@ -1657,7 +2006,13 @@ populate_dir_list_internal(FileView *view, int reload)
 
 	sort_dir_list(!reload, view);
 
-	if(!reload && !vle_mode_is(CMDLINE_MODE))
+	view->list_incomplete = (stream && interrupted);
+	if(view->list_incomplete)
+	{
+		status_bar_messagef("Directory reading was interrupted, got %d entries",
+				view->list_rows);
+	}
+	else if((!reload || stream) && !vle_mode_is(CMDLINE_MODE))
 	{
 		clean_status_bar();
 	}
@@ -1899,6 +2254,7 @@ static void
 init_dir_entry(FileView *view, dir_entry_t *entry, const char name[])
 {
 	entry->name = strdup(name);
+	entry->name_width = get_screen_string_length(name);
 	entry->origin = &view->curr_dir[0];
 
 	entry->size = 0ULL;
@@ -1916,6 +2272,7 @@ init_dir_entry(FileView *view, dir_entry_t *entry, const char name[])
 
 	entry->type = FT_UNK;
 	entry->hi_num = -1;
+	entry->broken_link = 0;
 
 	/* All files start as unselected, unmatched and unmarked. */
 	entry->selected = 0;
@@ -1923,7 +2280,8 @@ init_dir_entry(FileView *view, dir_entry_t *entry, const char name[])
 	entry->search_match = 0;
 	entry->marked = 0;
 
-	entry->list_num = -1;
+	entry->name_key.data = NULL;
+	entry->iname_key.data = NULL;
 }
 
 void
@@ -1947,6 +2305,9 @@ replace_dir_entries(FileView *view, dir_entry_t **entries, int *count,
 
 		entry->name = strdup(entry->name);
 		entry->origin = strdup(entry->origin);
+		/* Keys are cheap to recompute, so they aren't copied. */
+		entry->name_key.data = NULL;
+		entry->iname_key.data = NULL;
 
 		if(entry->name == NULL || entry->origin == NULL)
 		{
@@ -1983,6 +2344,8 @@ free_dir_entry(const FileView *view, dir_entry_t *entry)
 	free(entry->name);
 	entry->name = NULL;
 
+	free_dir_entry_keys(entry);
+
 	if(entry->origin != &view->curr_dir[0])
 	{
 		free(entry->origin);
@@ -1990,6 +2353,24 @@ free_dir_entry(const FileView *view, dir_entry_t *entry)
 	}
 }
 
+void
+rename_dir_entry(dir_entry_t *entry, const char new_name[])
+{
+	(void)replace_string(&entry->name, new_name);
+	entry->name_width = get_screen_string_length(entry->name);
+	free_dir_entry_keys(entry);
+}
+
+/* Frees natural sorting keys of the entry, if any. */
+static void
+free_dir_entry_keys(dir_entry_t *entry)
+{
+	free(entry->name_key.data);
+	entry->name_key.data = NULL;
+	free(entry->iname_key.data);
+	entry->iname_key.data = NULL;
+}
+
 int
 add_dir_entry(dir_entry_t **list, size_t *list_size, const dir_entry_t *entry)
 {
@@ -2020,6 +2401,30 @@ alloc_dir_entry(dir_entry_t **list, int list_size)
 	return &new_entry_list[list_size];
 }
 
+/* Allocates one more directory entry for the *list of size list_size, which
+ * has room for *capacity entries.  Capacity is doubled on running out of
+ * space, which makes adding n entries take O(n) time and O(log(n))
+ * reallocations.  Returns pointer to new entry or NULL on failure. */
+static dir_entry_t *
+grow_dir_entries(dir_entry_t **list, int list_size, int *capacity)
+{
+	if(list_size >= *capacity)
+	{
+		const int new_capacity = MAX(*capacity*2, 16);
+		dir_entry_t *const new_entry_list = realloc(*list,
+				sizeof(dir_entry_t)*new_capacity);
+		if(new_entry_list == NULL)
+		{
+			return NULL;
+		}
+
+		*list = new_entry_list;
+		*capacity = new_capacity;
+	}
+
+	return &(*list)[list_size];
+}
+
 static void
 reload_window(FileView *view)
 {
@@ -2042,13 +2447,18 @@ reload_window(FileView *view)
 void
 check_if_filelist_have_changed(FileView *view)
 {
-	if(view->on_slow_fs || flist_custom_active(view))
+	/* Reloading incomplete list would restart loading cancelled by the user. */
+	if(view->on_slow_fs || flist_custom_active(view) || view->list_incomplete)
 	{
 		return;
 	}
 
 #ifndef _WIN32
 	filemon_t mon;
+	if(check_dir_watcher(view))
+	{
+		return;
+	}
 	if(filemon_from_file(view->curr_dir, &mon) != 0)
 #else
 	int r;
@@ -2080,6 +2490,309 @@ check_if_filelist_have_changed(FileView *view)
 	}
 }
 
+int
+flist_watch_fd(const FileView *view)
+{
+#ifndef _WIN32
+	if(view->dir_watcher != NULL &&
+			stroscmp(view->watched_dir, view->curr_dir) == 0)
+	{
+		return filemon_watch_fd(view->dir_watcher);
+	}
+#endif
+	return -1;
+}
+
+#ifndef _WIN32
+
+/* Checks for changes of the directory via its watcher (creating one if
+ * needed).  Returns non-zero if the check has been performed, otherwise zero is
+ * returned and the caller should fallback to polling. */
+static int
+check_dir_watcher(FileView *view)
+{
+	filemon_change_t *changes;
+	int count;
+	int i;
+	int rescan;
+
+	if(stroscmp(view->watched_dir, view->curr_dir) != 0)
+	{
+		filemon_unwatch(view->dir_watcher);
+		copy_str(view->watched_dir, sizeof(view->watched_dir), view->curr_dir);
+		/* On failure there is no point in retrying until directory changes. */
+		view->dir_watcher = filemon_watch(view->curr_dir);
+		/* Changes made before watcher was set up can be detected by polling. */
+		return 0;
+	}
+
+	if(view->dir_watcher == NULL)
+	{
+		return 0;
+	}
+
+	if(view->local_filter.in_progress)
+	{
+		/* Leave changes queued until the list is in consistent state. */
+		return 1;
+	}
+
+	count = filemon_read_changes(view->dir_watcher, &changes);
+	if(count == 0)
+	{
+		return 1;
+	}
+
+	rescan = 0;
+	for(i = 0; i < count && !rescan; ++i)
+	{
+		rescan = (changes[i].kind == FMC_RESCAN);
+	}
+
+	if(!rescan && !window_shows_dirlist(view))
+	{
+		/* List will be reloaded when it's shown again, just drop the changes. */
+		filemon_free_changes(changes, count);
+		return 1;
+	}
+
+	if(!rescan)
+	{
+		rescan = apply_dir_changes(view, changes, count);
+	}
+	filemon_free_changes(changes, count);
+
+	if(!rescan)
+	{
+		(void)update_dir_mtime(view);
+		return 1;
+	}
+
+	/* Start watching anew on the next check. */
+	filemon_unwatch(view->dir_watcher);
+	view->dir_watcher = NULL;
+	view->watched_dir[0] = '\0';
+
+	if(!is_dir(view->curr_dir))
+	{
+		/* Let the caller handle disappearance of the directory. */
+		return 0;
+	}
+
+	reload_window(view);
+	return 1;
+}
+
+/* Updates list of files of the view according to the changes without
+ * rereading whole directory.  Returns non-zero if full reload is required. */
+static int
+apply_dir_changes(FileView *view, const filemon_change_t changes[], int count)
+{
+	char full_path[PATH_MAX];
+	int i;
+	const int old_pos = view->list_pos;
+	int recount_filtered = 0;
+
+	/* Patching the list in place doesn't pay off for big changes. */
+	if(count > 64 && count > view->list_rows/16)
+	{
+		return 1;
+	}
+
+	/* List with fake ".." entry only is easier to just reload. */
+	if(view->list_rows <= 1)
+	{
+		return 1;
+	}
+
+	/* This is needed for lstat() below. */
+	if(vifm_chdir(view->curr_dir) != 0)
+	{
+		return 1;
+	}
+
+	get_current_full_path(view, sizeof(full_path), full_path);
+
+	for(i = 0; i < count; ++i)
+	{
+		const char *const name = changes[i].name;
+		int pos;
+
+		if(strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+		{
+			continue;
+		}
+
+		pos = find_file_pos_in_list(view, name);
+		switch(changes[i].kind)
+		{
+			case FMC_CREATED:
+			case FMC_MODIFIED:
+				if(pos < 0)
+				{
+					int hidden;
+					if(add_changed_entry(view, name, &hidden) != 0)
+					{
+						return 1;
+					}
+					update_filtered_count(view, &changes[i], hidden, &recount_filtered);
+				}
+				else if(fill_dir_entry_by_path(&view->dir_entry[pos], name) != 0)
+				{
+					/* File is already gone. */
+					remove_changed_entry(view, pos);
+				}
+				break;
+			case FMC_DELETED:
+				if(pos < 0)
+				{
+					update_filtered_count(view, &changes[i], 0, &recount_filtered);
+				}
+				else
+				{
+					remove_changed_entry(view, pos);
+				}
+				break;
+			case FMC_RESCAN:
+				return 1;
+		}
+	}
+
+	if(view->list_rows < 1)
+	{
+		return 1;
+	}
+
+	/* Whether a file moved in replaced a filtered out one isn't known, so just
+	 * count them without building entries. */
+	if(recount_filtered)
+	{
+		view->filtered = 0;
+		if(enum_dir_content(view->curr_dir, &count_filtered_out, view) != 0)
+		{
+			return 1;
+		}
+	}
+
+	recount_selected_files(view);
+	sort_dir_list(0, view);
+
+	view->list_pos = MIN(old_pos, view->list_rows - 1);
+	flist_goto_by_path(view, full_path);
+	fview_list_updated(view);
+
+	draw_dir_list_only(view);
+	fview_cursor_redraw(view);
+	if(curr_stats.number_of_windows != 1 || view == curr_view)
+	{
+		refresh_view_win(view);
+	}
+	if(view != curr_view)
+	{
+		put_inactive_mark(view);
+	}
+
+	return 0;
+}
+
+/* Adds entry for newly created file to the list of the view unless it's
+ * filtered out or doesn't exist anymore.  Sets *hidden to non-zero if file
+ * exists, but is filtered out.  Returns non-zero on memory error, otherwise
+ * zero is returned. */
+static int
+add_changed_entry(FileView *view, const char name[], int *hidden)
+{
+	dir_entry_t *const entry = alloc_dir_entry(&view->dir_entry, view->list_rows);
+
+	*hidden = 0;
+	if(entry == NULL)
+	{
+		return 1;
+	}
+
+	init_dir_entry(view, entry, name);
+	if(entry->name == NULL)
+	{
+		return 1;
+	}
+
+	if(fill_dir_entry_by_path(entry, name) != 0)
+	{
+		/* File is already gone. */
+		free_dir_entry(view, entry);
+		return 0;
+	}
+
+	if(is_entry_filtered_out(view, name, is_directory_entry(entry)))
+	{
+		free_dir_entry(view, entry);
+		*hidden = 1;
+		return 0;
+	}
+
+	++view->list_rows;
+	return 0;
+}
+
+/* Updates number of filtered out files of the view according to the change of
+ * a file that's not in the list.  Such a file was filtered out if it existed
+ * before the change.  Sets *recount to non-zero if this can't be determined. */
+static void
+update_filtered_count(FileView *view, const filemon_change_t *change,
+		int hidden, int *recount)
+{
+	if(change->existed < 0)
+	{
+		/* A visible file wasn't there, otherwise it would have been listed. */
+		if(hidden || change->kind == FMC_DELETED)
+		{
+			*recount = 1;
+		}
+		return;
+	}
+
+	view->filtered += hidden - change->existed;
+	if(view->filtered < 0)
+	{
+		view->filtered = 0;
+	}
+}
+
+/* Removes entry of the deleted file at the pos from the list of the view. */
+static void
+remove_changed_entry(FileView *view, int pos)
+{
+	free_dir_entry(view, &view->dir_entry[pos]);
+	memmove(&view->dir_entry[pos], &view->dir_entry[pos + 1],
+			sizeof(*view->dir_entry)*(view->list_rows - pos - 1));
+	--view->list_rows;
+}
+
+/* enum_dir_content() callback that counts files hidden in the view.  Returns
+ * zero. */
+static int
+count_filtered_out(const char name[], const void *data, void *param)
+{
+	FileView *const view = param;
+	if(!is_builtin_dir(name) &&
+			is_entry_filtered_out(view, name, data_is_dir_entry(data)))
+	{
+		++view->filtered;
+	}
+	return 0;
+}
+
+/* Checks whether file should be hidden in the view.  Returns non-zero if so,
+ * otherwise zero is returned. */
+static int
+is_entry_filtered_out(FileView *view, const char name[], int is_dir)
+{
+	return (view->hide_dot && name[0] == '.')
+	    || !file_is_visible(view, name, is_dir);
+}
+
+#endif
+
 int
 cd_is_possible(const char *path)
 {
@@ -2360,7 +3073,7 @@ get_file_size_by_entry(const FileView *view, size_t pos)
 	{
 		char full_path[PATH_MAX];
 		get_full_path_of(entry, sizeof(full_path), full_path);
-		tree_get_data(curr_stats.dirsize_cache, full_path, &size);
+		dcache_get_size(full_path, &size);
 	}
 
 	return (size == 0) ? entry->size : size;
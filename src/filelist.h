@@ -202,6 +202,10 @@ dir_entry_t * get_current_entry(FileView *view);
 /* Checks whether content in the current directory of the view changed and
  * reloads the view if so. */
 void check_if_filelist_have_changed(FileView *view);
+/* Retrieves descriptor that becomes readable when directory of the view
+ * changes.  Returns the descriptor or -1 if there is none and changes are
+ * detected by polling. */
+int flist_watch_fd(const FileView *view);
 /* Checks whether cd'ing into path is possible. Shows cd errors to a user.
  * Returns non-zero if it's possible, zero otherwise. */
 int cd_is_possible(const char *path);
@@ -268,6 +272,8 @@ int add_dir_entry(dir_entry_t **list, size_t *list_size,
 		const dir_entry_t *entry);
 /* Frees single directory entry. */
 void free_dir_entry(const FileView *view, dir_entry_t *entry);
+/* Changes name of the entry in place. */
+void rename_dir_entry(dir_entry_t *entry, const char new_name[]);
 /* Adds parent directory entry (..) to filelist. */
 void add_parent_dir(FileView *view);
 
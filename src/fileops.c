@@ -41,6 +41,7 @@
 #include <stdlib.h> /* calloc() free() malloc() strtol() */
 #include <string.h> /* memcmp() memset() strcat() strcmp() strcpy() strdup()
                        strerror() */
+#include <time.h> /* time() time_t */
 
 #include "cfg/config.h"
 #include "compat/os.h"
@@ -61,7 +62,7 @@
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
-#include "utils/tree.h"
+#include "utils/string_map.h"
 #include "utils/test_helpers.h"
 #include "utils/utils.h"
 #include "background.h"
@@ -127,6 +128,16 @@ typedef struct
 }
 bg_args_t;
 
+/* State shared by threads that copy/move files of a background operation. */
+typedef struct
+{
+	bg_args_t *args;      /* Arguments of the operation. */
+	job_t *job;           /* Job of the operation. */
+	size_t next;          /* Index of the next element of sel_list to process. */
+	pthread_mutex_t lock; /* Protects next field. */
+}
+cpmv_bg_state_t;
+
 /* Arguments pack for dir_size_bg() background function. */
 typedef struct
 {
@@ -135,6 +146,33 @@ typedef struct
 }
 dir_size_args_t;
 
+/* Directory whose size is being calculated by dir_size_worker(). */
+typedef struct dir_size_node_t
+{
+	char *path;                     /* Full path to the directory. */
+	struct dir_size_node_t *parent; /* Parent directory or NULL for the root. */
+	struct dir_size_node_t *next;   /* Next directory in the queue. */
+	uint64_t size;                  /* Size accumulated so far. */
+	int pending;                    /* Number of unfinished subdirectories plus one
+	                                   until the directory is read. */
+	int failed;                     /* Whether reading directory failed. */
+	time_t mtime;                   /* Modification time of the directory. */
+	ino_t inode;                    /* Inode number of the directory. */
+}
+dir_size_node_t;
+
+/* State shared by threads that calculate size of a directory. */
+typedef struct
+{
+	dir_size_node_t *queue; /* Directories that are yet to be read. */
+	int busy;               /* Number of threads reading directories. */
+	int force;              /* Whether cached sizes should be ignored. */
+	uint64_t size;          /* Size of the root directory once done. */
+	pthread_mutex_t lock;   /* Protects all fields except for force. */
+	pthread_cond_t cond;    /* Signals changes of queue and busy fields. */
+}
+dir_size_state_t;
+
 static void io_progress_changed(const io_progress_t *const state);
 static char * format_file_progress(const ioeta_estim_t *estim, int precision);
 static void format_pretty_path(const char base_dir[], const char path[],
@@ -161,12 +199,12 @@ static int complete_filename(const char str[], void *arg);
 static void put_confirm_cb(const char dest_name[]);
 static void prompt_what_to_do(const char src_name[]);
 TSTATIC const char * gen_clone_name(const char normal_name[]);
+TSTATIC uint64_t calc_dirsize(const char path[], int force_update);
 static char ** grab_marked_files(FileView *view, size_t *nmarked);
 static int clone_file(const dir_entry_t *entry, const char path[],
 		const char clone[], ops_t *ops);
 static void put_decide_cb(const char dest_name[]);
 static void put_continue(int force);
-static int is_dir_entry(const char full_path[], const struct dirent* dentry);
 static int initiate_put_files(FileView *view, CopyMoveLikeOp op,
 				const char descr[], int reg_name);
 static OPS cmlo_to_op(CopyMoveLikeOp op);
@@ -194,8 +232,12 @@ static char ** edit_list(size_t count, char **orig, int *nlines,
 		int ignore_change);
 static const char * cmlo_to_str(CopyMoveLikeOp op);
 static void cpmv_files_in_bg(void *arg);
-static void cpmv_file_in_bg(const char src[], const char dst[], int move,
-		int force, int from_trash, const char dst_dir[]);
+static int have_same_dst_names(const bg_args_t *args);
+static const char * get_bg_dst_name(const bg_args_t *args, size_t i);
+static void * cpmv_files_bg_helper(void *arg);
+static void cpmv_files_bg_worker(cpmv_bg_state_t *state);
+static void cpmv_file_in_bg(cpmv_bg_state_t *state, const char src[],
+		const char dst[]);
 static int mv_file(const char src[], const char src_path[], const char dst[],
 		const char path[], int tmpfile_num, int cancellable, ops_t *ops);
 static int mv_file_f(const char src[], const char dst[], int tmpfile_num,
@@ -214,8 +256,15 @@ static int check_if_dir_writable(DirRole dir_role, const char path[]);
 static void update_dir_entry_size(const FileView *view, int index, int force);
 static void start_dir_size_calc(const char path[], int force);
 static void dir_size_bg(void *arg);
-static uint64_t calc_dirsize(const char path[], int force_update);
-static void set_dir_size(const char path[], uint64_t size);
+static void * dir_size_helper(void *arg);
+static void dir_size_worker(dir_size_state_t *state);
+static uint64_t dir_size_read(dir_size_state_t *state, dir_size_node_t *node,
+		dir_size_node_t **subdirs);
+static int dir_size_stat(DIR *dir, const char name[], const char path[],
+		struct stat *st);
+static dir_size_node_t * dir_size_node_alloc(const char path[],
+		dir_size_node_t *parent, const struct stat *st);
+static void dir_size_node_done(dir_size_state_t *state, dir_size_node_t *node);
 static void redraw_after_path_change(FileView *view, const char path[]);
 
 void
@@ -689,9 +738,8 @@ rename_file_cb(const char new_name[])
 	}
 
 	/* Rename file in internal structures for correct positioning of cursor after
-	 * reloading, as cursor will be positioned on the file with the same name.
-	 * TODO: maybe create a function in ui or filelist to do this. */
-	(void)replace_string(&entry->name, new);
+	 * reloading, as cursor will be positioned on the file with the same name. */
+	rename_dir_entry(entry, new);
 
 	ui_view_schedule_reload(curr_view);
 }
@@ -865,7 +913,7 @@ perform_renaming(FileView *view, char **files, int *is_dup, int len,
 				/* Rename file in internal structures for correct positioning of cursor
 				 * after reloading, as cursor will be positioned on the file with the
 				 * same name. */
-				(void)replace_string(&view->dir_entry[pos].name, list[i]);
+				rename_dir_entry(&view->dir_entry[pos], list[i]);
 			}
 		}
 	}
@@ -2058,27 +2106,6 @@ clone_file(const dir_entry_t *entry, const char path[], const char clone[],
 	return 0;
 }
 
-/* Uses dentry to check file type and falls back to lstat() if dentry contains
- * unknown type. */
-static int
-is_dir_entry(const char full_path[], const struct dirent* dentry)
-{
-#ifndef _WIN32
-	struct stat s;
-	if(dentry->d_type != DT_UNKNOWN)
-	{
-		return dentry->d_type == DT_DIR;
-	}
-	if(os_lstat(full_path, &s) == 0 && s.st_ino != 0)
-	{
-		return (s.st_mode&S_IFMT) == S_IFDIR;
-	}
-	return 0;
-#else
-	return is_dir(full_path);
-#endif
-}
-
 int
 put_links(FileView *view, int reg_name, int relative)
 {
@@ -2659,7 +2686,7 @@ fixup_entry_after_rename(FileView *view, dir_entry_t *entry,
 		/* Rename file in internal structures for correct positioning of cursor
 		 * after reloading, as cursor will be positioned on the file with the same
 		 * name. */
-		(void)replace_string(&entry->name, new_fname);
+		rename_dir_entry(entry, new_fname);
 	}
 }
 
@@ -3141,44 +3168,142 @@ cmlo_to_str(CopyMoveLikeOp op)
 	}
 }
 
-/* Entry point for a background task that copies/moves files. */
+/* Entry point for a background task that copies/moves files.  Up to
+ * cfg.io_threads files are processed at the same time.  Each file (with all
+ * its content in case of directory) is processed by a single thread, so
+ * directories are still created before their children. */
 static void
 cpmv_files_in_bg(void *arg)
 {
-	int i;
 	bg_args_t *const args = arg;
-	const int custom_fnames = (args->nlines > 0);
+	/* Files with the same name in destination directory must be processed in
+	 * order, so that the last one wins just like it does in foreground. */
+	const size_t max_threads = have_same_dst_names(args)
+	                         ? 1U
+	                         : (size_t)MAX(cfg.io_threads, 1);
+	const size_t nthreads = MIN(max_threads, args->sel_list_len);
+	pthread_t *helpers = NULL;
+	size_t nhelpers = 0U;
+	size_t i;
 
-	for(i = 0; i < args->sel_list_len; ++i)
+	cpmv_bg_state_t state = {
+		.args = args,
+		.job = bg_get_current_job(),
+		.next = 0U,
+	};
+	pthread_mutex_init(&state.lock, NULL);
+
+	if(nthreads > 1U)
 	{
-		const char *const src = args->sel_list[i];
-		const char *const dst = custom_fnames ? args->list[i] : NULL;
-		cpmv_file_in_bg(src, dst, args->move, args->force, args->use_trash,
-				args->path);
-		inner_bg_next();
+		helpers = malloc(sizeof(*helpers)*(nthreads - 1U));
+	}
+
+	/* Failing to start helpers is fine, there will be just less parallelism. */
+	for(i = 0U; helpers != NULL && i < nthreads - 1U; ++i)
+	{
+		if(pthread_create(&helpers[nhelpers], NULL, &cpmv_files_bg_helper,
+					&state) == 0)
+		{
+			++nhelpers;
+		}
+	}
+
+	cpmv_files_bg_worker(&state);
+
+	for(i = 0U; i < nhelpers; ++i)
+	{
+		(void)pthread_join(helpers[i], NULL);
 	}
+	free(helpers);
 
+	pthread_mutex_destroy(&state.lock);
 	free_bg_args(args);
 }
 
-/* Actual implementation of background file copying/moving. */
+/* Checks whether several files of background copying/moving end up at the same
+ * path.  Returns non-zero if so or if the check failed, otherwise zero is
+ * returned. */
+static int
+have_same_dst_names(const bg_args_t *args)
+{
+	size_t i;
+	int found = 0;
+	string_map_t *const names = string_map_create();
+	if(names == NULL)
+	{
+		return 1;
+	}
+
+	for(i = 0U; i < args->sel_list_len && !found; ++i)
+	{
+		const char *const name = get_bg_dst_name(args, i);
+		found = (string_map_get(names, name) != NULL)
+		     || (string_map_set(names, name, (void *)name) != 0);
+	}
+
+	string_map_free(names, NULL);
+	return found;
+}
+
+/* Gets name of the file in destination directory for i-th file of background
+ * copying/moving.  Returns the name. */
+static const char *
+get_bg_dst_name(const bg_args_t *args, size_t i)
+{
+	if(args->nlines > 0)
+	{
+		return args->list[i];
+	}
+	if(args->use_trash)
+	{
+		return get_real_name_from_trash_name(args->sel_list[i]);
+	}
+	return get_last_path_component(args->sel_list[i]);
+}
+
+/* Entry point of a helper thread of background copying/moving.  Returns
+ * NULL. */
+static void *
+cpmv_files_bg_helper(void *arg)
+{
+	cpmv_bg_state_t *const state = arg;
+	bg_set_current_job(state->job);
+	cpmv_files_bg_worker(state);
+	return NULL;
+}
+
+/* Processes files of background copying/moving until there are none left. */
 static void
-cpmv_file_in_bg(const char src[], const char dst[], int move, int force,
-		int from_trash, const char dst_dir[])
+cpmv_files_bg_worker(cpmv_bg_state_t *state)
 {
-	char dst_full[PATH_MAX];
+	bg_args_t *const args = state->args;
 
-	if(dst == NULL)
+	for(;;)
 	{
-		if(from_trash)
-		{
-			dst = get_real_name_from_trash_name(src);
-		}
-		else
+		size_t i;
+
+		pthread_mutex_lock(&state->lock);
+		i = state->next++;
+		pthread_mutex_unlock(&state->lock);
+
+		if(i >= args->sel_list_len)
 		{
-			dst = get_last_path_component(src);
+			break;
 		}
+
+		cpmv_file_in_bg(state, args->sel_list[i], get_bg_dst_name(args, i));
+		inner_bg_next();
 	}
+}
+
+/* Actual implementation of background file copying/moving. */
+static void
+cpmv_file_in_bg(cpmv_bg_state_t *state, const char src[], const char dst[])
+{
+	const int move = state->args->move;
+	const int from_trash = state->args->use_trash;
+	const char *const dst_dir = state->args->path;
+	char dst_full[PATH_MAX];
 
 	snprintf(dst_full, sizeof(dst_full), "%s/%s", dst_dir, dst);
 	if(path_exists(dst_full, DEREF) && !from_trash)
@@ -3190,9 +3315,11 @@ cpmv_file_in_bg(const char src[], const char dst[], int move, int force,
 	{
 		(void)mv_file_f(src, dst_full, -1, 0, NULL);
 	}
-	else
+	else if(strcmp(src, dst_full) != 0)
 	{
-		(void)cp_file_f(src, dst_full, -1, 0, NULL);
+		/* Just like moving above, background copying doesn't record undo
+		 * operations as there is no undo group open for them. */
+		(void)perform_operation(OP_COPY, NULL, (void *)1, src, dst_full);
 	}
 }
 
@@ -3697,67 +3824,271 @@ dir_size_bg(void *arg)
 	free(dir_size);
 }
 
-/* Calculates size of a directory possibly using cache of known sizes.  Returns
- * size of a directory or zero on error. */
-static uint64_t
+/* Calculates size of a directory possibly using cache of known sizes.  Cached
+ * size of a subdirectory is used only if the subdirectory seems to be unchanged
+ * since the size was calculated.  Directories are read by up to cfg.io_threads
+ * threads at once.  Returns size of a directory or zero on error. */
+TSTATIC uint64_t
 calc_dirsize(const char path[], int force_update)
 {
-	DIR* dir;
-	struct dirent* dentry;
-	const char* slash = "";
-	uint64_t size;
+	const int nthreads = MAX(cfg.io_threads, 1);
+	pthread_t *helpers;
+	int nhelpers = 0;
+	int i;
+	struct stat st;
 
-	dir = os_opendir(path);
-	if(dir == NULL)
+	dir_size_state_t state = {
+		.queue = NULL,
+		.busy = 0,
+		.force = force_update,
+		.size = 0U,
+	};
+
+	if(os_stat(path, &st) != 0)
 	{
-		return 0;
+		return 0U;
 	}
 
-	if(!ends_with_slash(path))
+	/* Old values are ignored anyway, so drop them to get rid of entries of
+	 * directories that don't exist anymore. */
+	if(force_update)
 	{
-		slash = "/";
+		dcache_invalidate(path);
+	}
+
+	state.queue = dir_size_node_alloc(path, NULL, &st);
+	if(state.queue == NULL)
+	{
+		return 0U;
+	}
+
+	pthread_mutex_init(&state.lock, NULL);
+	pthread_cond_init(&state.cond, NULL);
+
+	/* Failing to start helpers is fine, there will be just less parallelism. */
+	helpers = (nthreads > 1) ? malloc(sizeof(*helpers)*(nthreads - 1)) : NULL;
+	for(i = 0; helpers != NULL && i < nthreads - 1; ++i)
+	{
+		if(pthread_create(&helpers[nhelpers], NULL, &dir_size_helper,
+					&state) == 0)
+		{
+			++nhelpers;
+		}
+	}
+
+	dir_size_worker(&state);
+
+	for(i = 0; i < nhelpers; ++i)
+	{
+		(void)pthread_join(helpers[i], NULL);
+	}
+	free(helpers);
+
+	pthread_cond_destroy(&state.cond);
+	pthread_mutex_destroy(&state.lock);
+
+	return state.size;
+}
+
+/* Entry point of a helper thread of directory size calculation.  Returns
+ * NULL. */
+static void *
+dir_size_helper(void *arg)
+{
+	dir_size_worker(arg);
+	return NULL;
+}
+
+/* Reads directories from the queue until all of them are processed.  Each
+ * thread sums sizes of files of a directory on its own and takes the lock only
+ * to exchange directories and to propagate sizes of finished ones. */
+static void
+dir_size_worker(dir_size_state_t *state)
+{
+	pthread_mutex_lock(&state->lock);
+
+	for(;;)
+	{
+		dir_size_node_t *node;
+		dir_size_node_t *subdirs = NULL;
+		uint64_t size;
+
+		while(state->queue == NULL && state->busy != 0)
+		{
+			pthread_cond_wait(&state->cond, &state->lock);
+		}
+
+		if(state->queue == NULL)
+		{
+			break;
+		}
+
+		node = state->queue;
+		state->queue = node->next;
+		++state->busy;
+
+		pthread_mutex_unlock(&state->lock);
+		size = dir_size_read(state, node, &subdirs);
+		pthread_mutex_lock(&state->lock);
+
+		while(subdirs != NULL)
+		{
+			dir_size_node_t *const next = subdirs->next;
+			subdirs->next = state->queue;
+			state->queue = subdirs;
+			++node->pending;
+			subdirs = next;
+		}
+
+		node->size += size;
+		dir_size_node_done(state, node);
+
+		--state->busy;
+		pthread_cond_broadcast(&state->cond);
+	}
+
+	pthread_mutex_unlock(&state->lock);
+}
+
+/* Reads directory described by the node.  Subdirectories that need to be
+ * processed are returned via *subdirs.  Returns total size of files and
+ * subdirectories with valid cached sizes. */
+static uint64_t
+dir_size_read(dir_size_state_t *state, dir_size_node_t *node,
+		dir_size_node_t **subdirs)
+{
+	DIR *dir;
+	struct dirent *dentry;
+	const char *const slash = ends_with_slash(node->path) ? "" : "/";
+	uint64_t size = 0U;
+
+	dir = os_opendir(node->path);
+	if(dir == NULL)
+	{
+		node->failed = 1;
+		return 0U;
 	}
 
-	size = 0;
 	while((dentry = os_readdir(dir)) != NULL)
 	{
-		char buf[PATH_MAX];
+		char full_path[PATH_MAX];
+		struct stat st;
+		uint64_t dir_size;
+		dir_size_node_t *subdir;
 
 		if(is_builtin_dir(dentry->d_name))
 		{
 			continue;
 		}
 
-		snprintf(buf, sizeof(buf), "%s%s%s", path, slash, dentry->d_name);
-		if(is_dir_entry(buf, dentry))
+		snprintf(full_path, sizeof(full_path), "%s%s%s", node->path, slash,
+				dentry->d_name);
+		if(dir_size_stat(dir, dentry->d_name, full_path, &st) != 0)
+		{
+			continue;
+		}
+
+		if((st.st_mode & S_IFMT) != S_IFDIR)
+		{
+			size += (uint64_t)st.st_size;
+			continue;
+		}
+
+		if(!state->force &&
+				dcache_get_valid_size(full_path, st.st_mtime, st.st_ino,
+					&dir_size) == 0)
 		{
-			uint64_t dir_size = 0;
-			if(tree_get_data(curr_stats.dirsize_cache, buf, &dir_size) != 0
-					|| force_update)
-				dir_size = calc_dirsize(buf, force_update);
 			size += dir_size;
+			continue;
 		}
-		else
+
+		subdir = dir_size_node_alloc(full_path, node, &st);
+		if(subdir != NULL)
 		{
-			size += get_file_size(buf);
+			subdir->next = *subdirs;
+			*subdirs = subdir;
 		}
 	}
 
 	os_closedir(dir);
-
-	set_dir_size(path, size);
 	return size;
 }
 
-/* Updates cached directory size in a thread-safe way. */
+/* Queries information about a file without following symbolic links.  On *nix
+ * the query is performed relative to the opened directory to avoid repeated
+ * path resolution.  Returns zero on success, otherwise non-zero is returned. */
+static int
+dir_size_stat(DIR *dir, const char name[], const char path[], struct stat *st)
+{
+#ifndef _WIN32
+	return fstatat(dirfd(dir), name, st, AT_SYMLINK_NOFOLLOW);
+#else
+	return os_lstat(path, st);
+#endif
+}
+
+/* Allocates node of a directory to be processed.  Returns the node or NULL on
+ * error. */
+static dir_size_node_t *
+dir_size_node_alloc(const char path[], dir_size_node_t *parent,
+		const struct stat *st)
+{
+	dir_size_node_t *const node = malloc(sizeof(*node));
+	if(node == NULL)
+	{
+		return NULL;
+	}
+
+	node->path = strdup(path);
+	if(node->path == NULL)
+	{
+		free(node);
+		return NULL;
+	}
+
+	node->parent = parent;
+	node->next = NULL;
+	node->size = 0U;
+	node->pending = 1;
+	node->failed = 0;
+	node->mtime = st->st_mtime;
+	node->inode = st->st_ino;
+	return node;
+}
+
+/* Marks one pending part of the node as done.  Sizes of finished directories
+ * are cached and propagated to their parents.  Must be called with the lock
+ * held. */
 static void
-set_dir_size(const char path[], uint64_t size)
+dir_size_node_done(dir_size_state_t *state, dir_size_node_t *node)
 {
-	static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	while(node != NULL && --node->pending == 0)
+	{
+		dir_size_node_t *const parent = node->parent;
+
+		/* Caching size of unreadable directory would hide it from retries. */
+		if(!node->failed)
+		{
+			/* Modification time has granularity of a second, so changes made during
+			 * current second can't be detected and such sizes are never valid. */
+			const time_t mtime = (node->mtime >= time(NULL)) ? (time_t)-1
+			                                                 : node->mtime;
+			dcache_set_size(node->path, node->size, mtime, node->inode);
+		}
 
-	pthread_mutex_lock(&mutex);
-	tree_set_data(curr_stats.dirsize_cache, path, size);
-	pthread_mutex_unlock(&mutex);
+		if(parent == NULL)
+		{
+			state->size = node->size;
+		}
+		else
+		{
+			parent->size += node->size;
+		}
+
+		free(node->path);
+		free(node);
+		node = parent;
+	}
 }
 
 /* Schedules view redraw in case path change might have affected it. */
@@ -145,6 +145,7 @@ TSTATIC_DEFS(
 	const char * gen_clone_name(const char normal_name[]);
 	int is_name_list_ok(int count, int nlines, char *list[], char *files[]);
 	const char * incdec_name(const char fname[], int k);
+	uint64_t calc_dirsize(const char path[], int force_update);
 )
 
 #endif /* VIFM__FILEOPS_H__ */
@@ -21,15 +21,42 @@
 
 #include <ctype.h> /* isspace() */
 #include <stddef.h> /* NULL */
-#include <stdlib.h> /* free() realloc() */
+#include <stdlib.h> /* calloc() free() malloc() qsort() realloc() */
 #include <string.h> /* strchr() strdup() strcasecmp() */
 
 #include "modes/dialogs/msg_dialog.h"
 #include "utils/fs_limits.h"
 #include "utils/str.h"
+#include "utils/string_map.h"
 #include "utils/utils.h"
 #include "globals.h"
 
+/* List of indexes of associations. */
+typedef struct
+{
+	int *items; /* Indexes in ascending order. */
+	int count;  /* Number of items. */
+}
+int_list_t;
+
+/* Index of a list of associations, which makes it unnecessary to check every
+ * association on matching a file name. */
+typedef struct assoc_index_t
+{
+	string_map_t *by_ext; /* Extension -> int_list_t of associations, which
+	                         consist only of "*.ext" globals. */
+	int_list_t others;    /* Associations that can't be found by extension. */
+}
+assoc_index_t;
+
+/* Argument of collect_ext_candidates() callback. */
+typedef struct
+{
+	const assoc_index_t *index; /* Index to look up extensions in. */
+	int_list_t *candidates;     /* Where to append found associations. */
+}
+ext_lookup_t;
+
 const assoc_record_t NONE_PSEUDO_PROG =
 {
 	.command = "",
@@ -47,7 +74,7 @@ static assoc_record_type_t new_records_type = ART_CUSTOM;
 /* Pointer to external command existence check function. */
 static external_command_exists_t external_command_exists_func;
 
-static const char * find_existing_cmd(const assoc_list_t *record_list,
+static const char * find_existing_cmd(assoc_list_t *record_list,
 		const char file[]);
 static assoc_record_t find_existing_cmd_record(const assoc_records_t *records);
 static void assoc_programs(const char pattern[],
@@ -56,7 +83,16 @@ static assoc_records_t parse_command_list(const char cmds[], int with_descr);
 TSTATIC void replace_double_comma(char cmd[], int put_null);
 static void register_assoc(assoc_t assoc, int for_x, int in_x);
 static assoc_records_t clone_all_matching_records(const char file[],
-		const assoc_list_t *record_list);
+		assoc_list_t *record_list);
+static int_list_t get_matching_assocs(assoc_list_t *record_list,
+		const char file[]);
+static void collect_ext_candidates(const char ext[], void *arg);
+static int int_sorter(const void *first, const void *second);
+static assoc_index_t * build_index(const assoc_list_t *record_list);
+static void free_index(assoc_index_t *index);
+static void free_int_list(void *list);
+static int int_list_add(int_list_t *list, int item);
+static globals_t * compile_pattern(const char pattern[]);
 static void add_assoc(assoc_list_t *assoc_list, assoc_t assoc);
 static void assoc_viewers(const char pattern[], const assoc_records_t *viewers);
 static assoc_records_t clone_assoc_records(const assoc_records_t *records);
@@ -90,27 +126,25 @@ ft_get_viewer(const char file[])
 /* Finds first existing command which pattern matches given file.  Returns the
  * command (it's lifetime is managed by this unit) or NULL on failure. */
 static const char *
-find_existing_cmd(const assoc_list_t *record_list, const char file[])
+find_existing_cmd(assoc_list_t *record_list, const char file[])
 {
 	int i;
+	const char *cmd = NULL;
+	int_list_t matching = get_matching_assocs(record_list, file);
 
-	for(i = 0; i < record_list->count; ++i)
+	for(i = 0; i < matching.count; ++i)
 	{
-		assoc_record_t prog;
-
-		if(!global_matches(record_list->list[i].pattern, file))
-		{
-			continue;
-		}
-
-		prog = find_existing_cmd_record(&record_list->list[i].records);
+		const assoc_t *const assoc = &record_list->list[matching.items[i]];
+		const assoc_record_t prog = find_existing_cmd_record(&assoc->records);
 		if(!is_assoc_record_empty(&prog))
 		{
-			return prog.command;
+			cmd = prog.command;
+			break;
 		}
 	}
 
-	return NULL;
+	free(matching.items);
+	return cmd;
 }
 
 /* Finds record that corresponds to an external command that is available.
@@ -161,6 +195,7 @@ assoc_programs(const char pattern[], const assoc_records_t *programs, int for_x,
 	const assoc_t assoc =
 	{
 		.pattern = strdup(pattern),
+		.matcher = compile_pattern(pattern),
 		.records = clone_assoc_records(programs),
 	};
 
@@ -273,20 +308,229 @@ ft_get_all_viewers(const char file[])
 /* Clones all records which pattern matches the file.  Returns list of records
  * composed of clones. */
 static assoc_records_t
-clone_all_matching_records(const char file[], const assoc_list_t *record_list)
+clone_all_matching_records(const char file[], assoc_list_t *record_list)
 {
 	int i;
 	assoc_records_t result = {};
+	int_list_t matching = get_matching_assocs(record_list, file);
+
+	for(i = 0; i < matching.count; ++i)
+	{
+		ft_assoc_record_add_all(&result,
+				&record_list->list[matching.items[i]].records);
+	}
+
+	free(matching.items);
+	return result;
+}
+
+/* Finds associations whose patterns match the file.  Only associations that
+ * might match according to the index of the list are checked.  Returns list of
+ * indexes in ascending order, which should be freed by the caller. */
+static int_list_t
+get_matching_assocs(assoc_list_t *record_list, const char file[])
+{
+	int i;
+	int_list_t candidates = {};
+	int_list_t matching = {};
+
+	if(record_list->index == NULL)
+	{
+		record_list->index = build_index(record_list);
+	}
+
+	if(record_list->index == NULL)
+	{
+		/* Fallback to checking every association. */
+		for(i = 0; i < record_list->count; ++i)
+		{
+			(void)int_list_add(&candidates, i);
+		}
+	}
+	else
+	{
+		ext_lookup_t lookup = {
+			.index = record_list->index,
+			.candidates = &candidates,
+		};
+		const int_list_t *const others = &record_list->index->others;
+
+		globals_for_each_ext(file, &collect_ext_candidates, &lookup);
+		for(i = 0; i < others->count; ++i)
+		{
+			(void)int_list_add(&candidates, others->items[i]);
+		}
+
+		qsort(candidates.items, candidates.count, sizeof(*candidates.items),
+				&int_sorter);
+	}
+
+	for(i = 0; i < candidates.count; ++i)
+	{
+		const int idx = candidates.items[i];
+		const globals_t *const matcher = record_list->list[idx].matcher;
+
+		/* Several extensions of one association might match the file. */
+		if(i != 0 && candidates.items[i - 1] == idx)
+		{
+			continue;
+		}
+
+		if(matcher != NULL && globals_match(matcher, file))
+		{
+			(void)int_list_add(&matching, idx);
+		}
+	}
+
+	free(candidates.items);
+	return matching;
+}
+
+/* Appends associations that have the extension to the list of candidates. */
+static void
+collect_ext_candidates(const char ext[], void *arg)
+{
+	ext_lookup_t *const lookup = arg;
+	const int_list_t *const list = string_map_get(lookup->index->by_ext, ext);
+	int i;
+
+	if(list == NULL)
+	{
+		return;
+	}
+
+	for(i = 0; i < list->count; ++i)
+	{
+		(void)int_list_add(lookup->candidates, list->items[i]);
+	}
+}
+
+/* qsort() comparer that sorts integers in ascending order.  Returns standard
+ * -1, 0, 1 for comparisons. */
+static int
+int_sorter(const void *first, const void *second)
+{
+	const int a = *(const int *)first;
+	const int b = *(const int *)second;
+	return (a > b) - (a < b);
+}
+
+/* Builds index of the list of associations.  Returns the index or NULL on
+ * error. */
+static assoc_index_t *
+build_index(const assoc_list_t *record_list)
+{
+	int i;
+	assoc_index_t *const index = malloc(sizeof(*index));
+	if(index == NULL)
+	{
+		return NULL;
+	}
+
+	index->others.items = NULL;
+	index->others.count = 0;
+	index->by_ext = string_map_create();
+	if(index->by_ext == NULL)
+	{
+		free(index);
+		return NULL;
+	}
 
 	for(i = 0; i < record_list->count; ++i)
 	{
-		if(global_matches(record_list->list[i].pattern, file))
+		const globals_t *const matcher = record_list->list[i].matcher;
+		int j;
+
+		if(matcher == NULL)
+		{
+			continue;
+		}
+
+		if(matcher->have_re)
+		{
+			if(int_list_add(&index->others, i) != 0)
+			{
+				free_index(index);
+				return NULL;
+			}
+			continue;
+		}
+
+		for(j = 0; j < matcher->nexts; ++j)
 		{
-			ft_assoc_record_add_all(&result, &record_list->list[i].records);
+			int_list_t *list = string_map_get(index->by_ext, matcher->exts[j]);
+			if(list == NULL)
+			{
+				list = calloc(1, sizeof(*list));
+				if(list == NULL ||
+						string_map_set(index->by_ext, matcher->exts[j], list) != 0)
+				{
+					free(list);
+					free_index(index);
+					return NULL;
+				}
+			}
+
+			if(int_list_add(list, i) != 0)
+			{
+				free_index(index);
+				return NULL;
+			}
 		}
 	}
 
-	return result;
+	return index;
+}
+
+/* Frees index of a list of associations.  Freeing NULL index is OK. */
+static void
+free_index(assoc_index_t *index)
+{
+	if(index != NULL)
+	{
+		string_map_free(index->by_ext, &free_int_list);
+		free(index->others.items);
+		free(index);
+	}
+}
+
+/* Frees list of integers allocated on heap. */
+static void
+free_int_list(void *list)
+{
+	int_list_t *const int_list = list;
+	free(int_list->items);
+	free(int_list);
+}
+
+/* Appends item to the list.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+int_list_add(int_list_t *list, int item)
+{
+	int *const items = realloc(list->items, sizeof(*items)*(list->count + 1));
+	if(items == NULL)
+	{
+		return 1;
+	}
+
+	list->items = items;
+	list->items[list->count++] = item;
+	return 0;
+}
+
+/* Compiles pattern of an association.  Returns compiled pattern or NULL on
+ * error. */
+static globals_t *
+compile_pattern(const char pattern[])
+{
+	globals_t *const matcher = malloc(sizeof(*matcher));
+	if(matcher != NULL && globals_compile(pattern, matcher) != 0)
+	{
+		free(matcher);
+		return NULL;
+	}
+	return matcher;
 }
 
 void
@@ -304,6 +548,7 @@ assoc_viewers(const char pattern[], const assoc_records_t *viewers)
 	const assoc_t assoc =
 	{
 		.pattern = strdup(pattern),
+		.matcher = compile_pattern(pattern),
 		.records = clone_assoc_records(viewers),
 	};
 
@@ -332,6 +577,9 @@ add_assoc(assoc_list_t *assoc_list, assoc_t assoc)
 	assoc_list->list = p;
 	assoc_list->list[assoc_list->count] = assoc;
 	assoc_list->count++;
+
+	free_index(assoc_list->index);
+	assoc_list->index = NULL;
 }
 
 void
@@ -377,12 +625,21 @@ reset_list_head(assoc_list_t *assoc_list)
 	free(assoc_list->list);
 	assoc_list->list = NULL;
 	assoc_list->count = 0;
+
+	free_index(assoc_list->index);
+	assoc_list->index = NULL;
 }
 
 static void
 free_assoc(assoc_t *assoc)
 {
 	safe_free(&assoc->pattern);
+	if(assoc->matcher != NULL)
+	{
+		globals_free(assoc->matcher);
+		free(assoc->matcher);
+		assoc->matcher = NULL;
+	}
 	ft_assoc_records_free(&assoc->records);
 }
 
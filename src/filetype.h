@@ -21,6 +21,7 @@
 #define VIFM__FILETYPE_H__
 
 #include "utils/test_helpers.h"
+#include "globals.h"
 
 #define VIFM_PSEUDO_CMD "vifm"
 
@@ -52,14 +53,18 @@ assoc_records_t;
 typedef struct
 {
 	char *pattern;
+	globals_t *matcher; /* Compiled pattern or NULL if it's invalid. */
 	assoc_records_t records;
 }
 assoc_t;
 
+struct assoc_index_t;
+
 typedef struct
 {
 	assoc_t *list;
 	int count;
+	struct assoc_index_t *index; /* Lookup index, which is built on demand. */
 }
 assoc_list_t;
 
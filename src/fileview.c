@@ -28,6 +28,8 @@
 
 #include <assert.h> /* assert() */
 #include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* uint64_t */
+#include <stdlib.h> /* abs() */
 #include <string.h> /* strcpy() strlen() */
 
 #include "cfg/config.h"
@@ -49,6 +51,9 @@
 /* Mark for a cursor position of inactive pane. */
 #define INACTIVE_CURSOR_MARK "*"
 
+/* Number of slots in the cache of formatted column values, power of two. */
+#define FORMAT_CACHE_SIZE 256U
+
 /* Packet set of parameters to pass as user data for processing columns. */
 typedef struct
 {
@@ -62,6 +67,18 @@ typedef struct
 }
 column_data_t;
 
+/* Slot of the cache of formatted column values.  Values are identified by
+ * themselves, which makes changes of file metadata invalidate cached strings
+ * automatically. */
+typedef struct
+{
+	int id;         /* Id of the column or 0 for unused slot. */
+	uint64_t value; /* Value that was formatted. */
+	int gen;        /* Generation of the cache at the moment of formatting. */
+	char text[64];  /* Formatted value. */
+}
+format_cache_slot_t;
+
 static void calculate_table_conf(FileView *view, size_t *count, size_t *width);
 static void calculate_number_width(FileView *view);
 static int count_digits(int num);
@@ -94,13 +111,24 @@ static void format_mode(int id, const void *data, size_t buf_len, char buf[]);
 static void format_owner(int id, const void *data, size_t buf_len, char buf[]);
 static void format_perms(int id, const void *data, size_t buf_len, char buf[]);
 #endif
+static format_cache_slot_t * get_format_cache_slot(int id, uint64_t value);
+TSTATIC int use_format_cache(int id, uint64_t value, size_t buf_len,
+		char buf[]);
+TSTATIC void fill_format_cache(int id, uint64_t value, size_t buf_len,
+		const char text[]);
 static size_t calculate_column_width(FileView *view);
 static size_t get_max_filename_width(const FileView *view);
 static size_t get_filename_width(const FileView *view, int i);
 static size_t get_filetype_decoration_width(FileType type);
 static int move_curr_line(FileView *view);
+TSTATIC int scroll_view_win(FileView *view);
 static void reset_view_sort(FileView *view);
 
+/* Cache of formatted values of size, time, owner and group columns. */
+static format_cache_slot_t format_cache[FORMAT_CACHE_SIZE];
+/* Current generation of the cache, slots of other generations are stale. */
+static int format_cache_gen = 1;
+
 void
 fview_init(void)
 {
@@ -131,6 +159,7 @@ fview_view_init(FileView *view)
 {
 	view->curr_line = 0;
 	view->top_line = 0;
+	view->drawn_top = -1;
 
 	view->local_cs = 0;
 
@@ -225,6 +254,7 @@ draw_dir_list_only(FileView *view)
 	}
 
 	view->top_line = top;
+	view->drawn_top = top;
 	view->curr_line = view->list_pos - view->top_line;
 
 	if(view == curr_view)
@@ -325,29 +355,11 @@ get_line_color(const FileView *view, int pos)
 		case FT_FIFO:
 			return FIFO_COLOR;
 		case FT_LINK:
-			if(view->on_slow_fs)
+			if(view->on_slow_fs || !view->dir_entry[pos].broken_link)
 			{
 				return LINK_COLOR;
 			}
-			else
-			{
-				char full[PATH_MAX];
-				get_full_path_at(view, pos, sizeof(full), full);
-				if(get_link_target_abs(full, view->dir_entry[pos].origin, full,
-							sizeof(full)) != 0)
-				{
-					return BROKEN_LINK_COLOR;
-				}
-
-				/* Assume that targets on slow file system are not broken as actual
-				 * check might take long time. */
-				if(is_on_slow_fs(full))
-				{
-					return LINK_COLOR;
-				}
-
-				return path_exists(full, DEREF) ? LINK_COLOR : BROKEN_LINK_COLOR;
-			}
+			return BROKEN_LINK_COLOR;
 #ifndef _WIN32
 		case FT_SOCK:
 			return SOCKET_COLOR;
@@ -917,9 +929,15 @@ format_size(int id, const void *data, size_t buf_len, char buf[])
 	const column_data_t *cdt = data;
 	uint64_t size = get_file_size_by_entry(cdt->view, cdt->line_pos);
 
+	if(use_format_cache(id, size, buf_len, buf))
+	{
+		return;
+	}
+
 	str[0] = '\0';
 	friendly_size_notation(size, sizeof(str), str);
 	snprintf(buf, buf_len + 1, " %s", str);
+	fill_format_cache(id, size, buf_len, buf);
 }
 
 /* File extension format callback for column_view unit. */
@@ -939,6 +957,7 @@ static void
 format_time(int id, const void *data, size_t buf_len, char buf[])
 {
 	struct tm *tm_ptr;
+	time_t t;
 	const column_data_t *cdt = data;
 	FileView *view = cdt->view;
 	dir_entry_t *entry = &view->dir_entry[cdt->line_pos];
@@ -946,21 +965,28 @@ format_time(int id, const void *data, size_t buf_len, char buf[])
 	switch(id)
 	{
 		case SK_BY_TIME_MODIFIED:
-			tm_ptr = localtime(&entry->mtime);
+			t = entry->mtime;
 			break;
 		case SK_BY_TIME_ACCESSED:
-			tm_ptr = localtime(&entry->atime);
+			t = entry->atime;
 			break;
 		case SK_BY_TIME_CHANGED:
-			tm_ptr = localtime(&entry->ctime);
+			t = entry->ctime;
 			break;
 
 		default:
 			assert(0 && "Unknown sort by time type");
-			tm_ptr = NULL;
-			break;
+			buf[0] = '\0';
+			return;
+	}
+
+	/* All kinds of time are formatted in the same way, so they share cache. */
+	if(use_format_cache(SK_BY_TIME_MODIFIED, (uint64_t)t, buf_len, buf))
+	{
+		return;
 	}
 
+	tm_ptr = localtime(&t);
 	if(tm_ptr != NULL)
 	{
 		strftime(buf, buf_len + 1, cfg.time_format, tm_ptr);
@@ -969,6 +995,7 @@ format_time(int id, const void *data, size_t buf_len, char buf[])
 	{
 		buf[0] = '\0';
 	}
+	fill_format_cache(SK_BY_TIME_MODIFIED, (uint64_t)t, buf_len, buf);
 }
 
 #ifndef _WIN32
@@ -980,8 +1007,14 @@ format_group(int id, const void *data, size_t buf_len, char buf[])
 	const column_data_t *cdt = data;
 	dir_entry_t *entry = &cdt->view->dir_entry[cdt->line_pos];
 
+	if(use_format_cache(id, entry->gid, buf_len, buf))
+	{
+		return;
+	}
+
 	buf[0] = ' ';
 	get_gid_string(entry, id == SK_BY_GROUP_ID, buf_len - 1, buf + 1);
+	fill_format_cache(id, entry->gid, buf_len, buf);
 }
 
 /* File owner id/name format callback for column_view unit. */
@@ -991,8 +1024,14 @@ format_owner(int id, const void *data, size_t buf_len, char buf[])
 	const column_data_t *cdt = data;
 	dir_entry_t *entry = &cdt->view->dir_entry[cdt->line_pos];
 
+	if(use_format_cache(id, entry->uid, buf_len, buf))
+	{
+		return;
+	}
+
 	buf[0] = ' ';
 	get_uid_string(entry, id == SK_BY_OWNER_ID, buf_len - 1, buf + 1);
+	fill_format_cache(id, entry->uid, buf_len, buf);
 }
 
 /* File mode format callback for column_view unit. */
@@ -1016,6 +1055,51 @@ format_perms(int id, const void *data, size_t buf_len, char buf[])
 
 #endif
 
+/* Finds slot of the format cache for the value of the column.  Returns pointer
+ * to the slot. */
+static format_cache_slot_t *
+get_format_cache_slot(int id, uint64_t value)
+{
+	const uint64_t hash = (value ^ (value >> 29))*0x9e3779b97f4a7c15ULL + id;
+	return &format_cache[(hash >> 32) & (FORMAT_CACHE_SIZE - 1U)];
+}
+
+/* Retrieves previously formatted value of the column from the cache.  Returns
+ * non-zero if buf was filled, otherwise zero is returned. */
+TSTATIC int
+use_format_cache(int id, uint64_t value, size_t buf_len, char buf[])
+{
+	const format_cache_slot_t *const slot = get_format_cache_slot(id, value);
+
+	/* Cached strings aren't truncated, so don't use them for small buffers. */
+	if(buf_len < sizeof(slot->text) || slot->id != id || slot->value != value ||
+			slot->gen != format_cache_gen)
+	{
+		return 0;
+	}
+
+	strcpy(buf, slot->text);
+	return 1;
+}
+
+/* Remembers formatted value of the column in the cache.  Formatting into small
+ * buffer might have truncated the text, such values are not cached. */
+TSTATIC void
+fill_format_cache(int id, uint64_t value, size_t buf_len, const char text[])
+{
+	format_cache_slot_t *const slot = get_format_cache_slot(id, value);
+
+	if(buf_len < sizeof(slot->text) || strlen(text) >= sizeof(slot->text))
+	{
+		return;
+	}
+
+	slot->id = id;
+	slot->value = value;
+	slot->gen = format_cache_gen;
+	strcpy(slot->text, text);
+}
+
 void
 fview_set_lsview(FileView *view, int enabled)
 {
@@ -1033,6 +1117,8 @@ fview_set_lsview(FileView *view, int enabled)
 			.align = AT_LEFT,        .sizing = ST_AUTO, .cropping = CT_ELLIPSIS,
 		};
 
+		view->max_filename_width = get_max_filename_width(view);
+
 		columns_clear(view->columns);
 		columns_add_column(view->columns, column_info);
 		ui_view_schedule_redraw(view);
@@ -1076,7 +1162,11 @@ fview_dir_updated(FileView *view)
 void
 fview_list_updated(FileView *view)
 {
-	view->max_filename_width = get_max_filename_width(view);
+	/* The width is used only by ls-like view and is updated on enabling it. */
+	if(view->ls_view)
+	{
+		view->max_filename_width = get_max_filename_width(view);
+	}
 }
 
 /* Finds maximum filename width (length in character positions on the screen)
@@ -1112,7 +1202,7 @@ get_filename_width(const FileView *view, int i)
 	}
 	else
 	{
-		name_len = get_screen_string_length(view->dir_entry[i].name);
+		name_len = view->dir_entry[i].name_width;
 	}
 	return name_len + get_filetype_decoration_width(target_type);
 }
@@ -1153,7 +1243,7 @@ fview_position_updated(FileView *view)
 		return;
 	}
 
-	if(redraw)
+	if(redraw && !scroll_view_win(view))
 	{
 		draw_dir_list(view);
 		clear_current_line_bar(view, 0);
@@ -1226,12 +1316,77 @@ move_curr_line(FileView *view)
 	return redraw != 0 || (view->num_type & NT_REL);
 }
 
+/* Updates view after its top line changed by scrolling contents of its window
+ * and drawing only lines that became visible instead of redrawing all of them.
+ * Returns non-zero on success, otherwise zero is returned and the view needs to
+ * be redrawn. */
+TSTATIC int
+scroll_view_win(FileView *view)
+{
+	int delta;
+	int first, last;
+	int i;
+	size_t col_width;
+	size_t col_count;
+
+	if(view != curr_view || view->drawn_top < 0 || cfg.scroll_bind ||
+			(view->num_type & NT_REL))
+	{
+		return 0;
+	}
+
+	calculate_table_conf(view, &col_count, &col_width);
+
+	/* Both old and new positions must fill the whole window. */
+	delta = view->top_line - view->drawn_top;
+	if(col_count != 1 || abs(delta) >= (int)view->window_cells ||
+			view->drawn_top + (int)view->window_cells > view->list_rows ||
+			view->top_line + (int)view->window_cells > view->list_rows)
+	{
+		return 0;
+	}
+
+	scrollok(view->win, TRUE);
+	wscrl(view->win, delta);
+	scrollok(view->win, FALSE);
+
+	first = (delta > 0) ? (int)view->window_cells - delta : 0;
+	last = (delta > 0) ? (int)view->window_cells : -delta;
+	for(i = first; i < last; ++i)
+	{
+		const int pos = view->top_line + i;
+		const column_data_t cdt = {
+			.view = view,
+			.line_pos = pos,
+			.line_hi_group = get_line_color(view, pos),
+			.is_current = (pos == view->list_pos),
+			.current_line = i,
+			.column_offset = 0,
+		};
+
+		draw_cell(view, &cdt, col_width,
+				calculate_print_width(view, pos, col_width));
+	}
+
+	view->drawn_top = view->top_line;
+	view->curr_line = view->list_pos - view->top_line;
+
+	ui_view_win_changed(view);
+	return 1;
+}
+
 void
 fview_sorting_updated(FileView *view)
 {
 	reset_view_sort(view);
 }
 
+void
+fview_formatting_updated(void)
+{
+	++format_cache_gen;
+}
+
 /* Reinitializes view columns. */
 static void
 reset_view_sort(FileView *view)
@@ -21,8 +21,10 @@
 #define VIFM__FILEVIEW_H__
 
 #include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
 
 #include "ui/ui.h"
+#include "utils/test_helpers.h"
 
 /* Initialization/termination functions. */
 
@@ -149,6 +151,17 @@ void fview_position_updated(FileView *view);
  * sorting changed. */
 void fview_sorting_updated(FileView *view);
 
+/* Callback-like function which triggers some view-specific updates after
+ * options that affect formatting of column values changed. */
+void fview_formatting_updated(void);
+
+TSTATIC_DEFS(
+	int use_format_cache(int id, uint64_t value, size_t buf_len, char buf[]);
+	void fill_format_cache(int id, uint64_t value, size_t buf_len,
+			const char text[]);
+	int scroll_view_win(FileView *view);
+)
+
 #endif /* VIFM__FILEVIEW_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -19,16 +19,46 @@
 
 #include "filtering.h"
 
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <unistd.h> /* sysconf() */
+#endif
+
 #include <assert.h> /* assert() */
-#include <string.h> /* strdup() */
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* strdup() strlen() strncmp() strpbrk() */
 
 #include "cfg/config.h"
 #include "ui/ui.h"
+#include "utils/filter.h"
+#include "utils/macros.h"
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/utils.h"
 #include "filelist.h"
 
+/* Minimal number of entries matched by a single thread. */
+#define MATCH_CHUNK_SIZE 4096U
+
+/* Maximum number of threads used to match entries against local filter. */
+#define MAX_MATCHERS 8
+
+/* Part of the list of candidates to be matched against local filter by one
+ * thread. */
+typedef struct
+{
+	filter_t *filter;          /* Filter owned by the thread. */
+	const dir_entry_t *entries; /* Unfiltered list of entries. */
+	const int *candidates;     /* Indexes of entries to be matched. */
+	const char *dirs;          /* Whether candidates are directories. */
+	size_t from;               /* First candidate of the chunk. */
+	size_t to;                 /* Candidate past the last one of the chunk. */
+	char *matched;             /* Results of matching for all candidates. */
+}
+match_chunk_t;
+
 static void reset_filter(filter_t *filter);
 static int iter_selection_or_current(FileView *view, dir_entry_t **entry);
 static int is_newly_filtered(FileView *view, const dir_entry_t *entry,
@@ -36,6 +66,14 @@ static int is_newly_filtered(FileView *view, const dir_entry_t *entry,
 static int get_unfiltered_pos(const FileView *const view, int pos);
 static int load_unfiltered_list(FileView *const view);
 static void store_local_filter_position(FileView *const view, int pos);
+static int is_refinement(const filter_t *filter, const char value[],
+		int case_sensitive);
+static void match_unfiltered(FileView *view, int refine);
+static void match_in_parallel(FileView *view, const int candidates[],
+		const char dirs[], size_t count, char matched[]);
+static int get_matcher_count(size_t count);
+static void * match_chunk(void *arg);
+static int name_matches(filter_t *filter, const char name[], int is_dir);
 static void update_filtering_lists(FileView *view, int add, int clear);
 static void ensure_filtered_list_not_empty(FileView *view,
 		dir_entry_t *parent_entry);
@@ -62,6 +100,8 @@ filters_view_reset(FileView *view)
 	view->local_filter.saved = NULL;
 	view->local_filter.poshist = NULL;
 	view->local_filter.poshist_len = 0U;
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_count = 0U;
 }
 
 /* Resets filter to empty state (either initializes or clears it). */
@@ -275,21 +315,219 @@ filters_dir_updated(FileView *view)
 void
 local_filter_set(FileView *view, const char filter[])
 {
+	const int case_sensitive = !regexp_should_ignore_case(filter);
 	const int current_file_pos = view->local_filter.in_progress
 		? get_unfiltered_pos(view, view->list_pos)
 		: load_unfiltered_list(view);
+	const int refine = view->local_filter.matches != NULL
+	                && is_refinement(&view->local_filter.filter, filter,
+	                                 case_sensitive);
 
 	if(current_file_pos >= 0)
 	{
 		store_local_filter_position(view, current_file_pos);
 	}
 
-	(void)filter_change(&view->local_filter.filter, filter,
-			!regexp_should_ignore_case(filter));
+	(void)filter_change(&view->local_filter.filter, filter, case_sensitive);
 
+	match_unfiltered(view, refine);
 	update_filtering_lists(view, 1, 0);
 }
 
+/* Checks whether value (with specified case sensitivity) can match only subset
+ * of what is matched by the filter, which is the case when it just appends
+ * ordinary characters to the current pattern.  Returns non-zero if so,
+ * otherwise zero is returned. */
+static int
+is_refinement(const filter_t *filter, const char value[], int case_sensitive)
+{
+	const size_t len = strlen(filter->raw);
+
+	if(!case_sensitive && !(filter->cflags & REG_ICASE))
+	{
+		return 0;
+	}
+
+	if(strncmp(filter->raw, value, len) != 0)
+	{
+		return 0;
+	}
+
+	if(len != 0U && filter->raw[len - 1U] == '\\')
+	{
+		return 0;
+	}
+
+	return strpbrk(value + len, "\\[](){}+*?^$.|") == NULL;
+}
+
+/* Updates list of entries of the unfiltered list that match local filter.  If
+ * refine is non-zero, only previously matched entries are checked. */
+static void
+match_unfiltered(FileView *view, int refine)
+{
+	size_t i;
+	size_t count;
+	int *candidates;
+	char *matched, *dirs;
+
+	if(refine)
+	{
+		candidates = view->local_filter.matches;
+		count = view->local_filter.matches_count;
+	}
+	else
+	{
+		count = view->local_filter.unfiltered_count;
+		candidates = realloc(view->local_filter.matches,
+				sizeof(*candidates)*MAX(count, 1U));
+		if(candidates == NULL)
+		{
+			return;
+		}
+
+		for(i = 0U; i < count; ++i)
+		{
+			candidates[i] = i;
+		}
+	}
+
+	view->local_filter.matches = candidates;
+	view->local_filter.matches_count = count;
+
+	matched = malloc(MAX(count, 1U)*2U);
+	if(matched == NULL)
+	{
+		return;
+	}
+
+	/* Type of symbolic links is resolved beforehand as it involves querying file
+	 * system, which shouldn't be done from multiple threads. */
+	dirs = matched + count;
+	for(i = 0U; i < count; ++i)
+	{
+		dirs[i] =
+			is_directory_entry(&view->local_filter.unfiltered[candidates[i]]);
+	}
+
+	match_in_parallel(view, candidates, dirs, count, matched);
+
+	view->local_filter.matches_count = 0U;
+	for(i = 0U; i < count; ++i)
+	{
+		if(matched[i])
+		{
+			candidates[view->local_filter.matches_count++] = candidates[i];
+		}
+	}
+
+	free(matched);
+}
+
+/* Matches entries of the unfiltered list specified by candidates against local
+ * filter splitting the work among several threads for long lists.  Result for
+ * each candidate is stored in the matched array. */
+static void
+match_in_parallel(FileView *view, const int candidates[], const char dirs[],
+		size_t count, char matched[])
+{
+	/* Matching against the same regex is serialized by some implementations, so
+	 * each helper thread gets its own copy of the filter. */
+	filter_t filters[MAX_MATCHERS - 1];
+	pthread_t helpers[MAX_MATCHERS - 1];
+	match_chunk_t chunks[MAX_MATCHERS];
+	int nchunks = get_matcher_count(count);
+	int nhelpers = 0;
+	int i;
+
+	for(i = 0; i < nchunks - 1; ++i)
+	{
+		if(filter_init(&filters[i], 1) != 0)
+		{
+			break;
+		}
+		if(filter_assign(&filters[i], &view->local_filter.filter) != 0)
+		{
+			filter_dispose(&filters[i]);
+			break;
+		}
+	}
+	nchunks = i + 1;
+
+	for(i = 0; i < nchunks; ++i)
+	{
+		chunks[i].filter = (i == nchunks - 1) ? &view->local_filter.filter
+		                                      : &filters[i];
+		chunks[i].entries = view->local_filter.unfiltered;
+		chunks[i].candidates = candidates;
+		chunks[i].dirs = dirs;
+		chunks[i].from = count*i/nchunks;
+		chunks[i].to = count*(i + 1)/nchunks;
+		chunks[i].matched = matched;
+	}
+
+	/* Chunks of helpers that failed to start are processed by this thread. */
+	for(i = 0; i < nchunks - 1; ++i)
+	{
+		if(pthread_create(&helpers[i], NULL, &match_chunk, &chunks[i]) != 0)
+		{
+			break;
+		}
+		++nhelpers;
+	}
+
+	for(i = nhelpers; i < nchunks; ++i)
+	{
+		(void)match_chunk(&chunks[i]);
+	}
+
+	for(i = 0; i < nhelpers; ++i)
+	{
+		(void)pthread_join(helpers[i], NULL);
+	}
+
+	for(i = 0; i < nchunks - 1; ++i)
+	{
+		filter_dispose(&filters[i]);
+	}
+}
+
+/* Picks number of threads to match count entries.  Returns at least one. */
+static int
+get_matcher_count(size_t count)
+{
+#ifndef _WIN32
+	const long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	const size_t nchunks = count/MATCH_CHUNK_SIZE;
+
+	if(ncpus <= 1 || nchunks <= 1U)
+	{
+		return 1;
+	}
+
+	return (int)MIN((size_t)MIN(ncpus, (long)MAX_MATCHERS), nchunks);
+#else
+	return 1;
+#endif
+}
+
+/* Matches candidates of a chunk.  Returns NULL. */
+static void *
+match_chunk(void *arg)
+{
+	match_chunk_t *const chunk = arg;
+	size_t i;
+
+	for(i = chunk->from; i < chunk->to; ++i)
+	{
+		const char *const name = chunk->entries[chunk->candidates[i]].name;
+		chunk->matched[i] = is_parent_dir(name)
+		                 || name_matches(chunk->filter, name, chunk->dirs[i]);
+	}
+
+	return NULL;
+}
+
 /* Gets position of an item in dir_entry list at position pos in the unfiltered
  * list.  Returns index on success, otherwise -1 is returned. */
 static int
@@ -352,6 +590,8 @@ load_unfiltered_list(FileView *const view)
 	view->local_filter.unfiltered = view->dir_entry;
 	view->local_filter.unfiltered_count = view->list_rows;
 	view->local_filter.prefiltered_count = view->filtered;
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_count = 0U;
 	view->dir_entry = NULL;
 
 	return current_file_pos;
@@ -371,55 +611,64 @@ store_local_filter_position(FileView *const view, int pos)
 	}
 }
 
-/* Copies/moves elements of the unfiltered list into dir_entry list.  add
- * parameter controls whether entries matching filter are copied into dir_entry
- * list.  clear parameter controls whether entries not matching filter are
- * cleared in unfiltered list. */
+/* Copies/moves elements of the unfiltered list into dir_entry list according
+ * to results of match_unfiltered().  add parameter controls whether entries
+ * matching filter are copied into dir_entry list.  clear parameter controls
+ * whether entries not matching filter are cleared in unfiltered list. */
 static void
 update_filtering_lists(FileView *view, int add, int clear)
 {
+	const int *const matches = view->local_filter.matches;
+	const size_t count = (matches == NULL) ? 0U
+	                                       : view->local_filter.matches_count;
 	size_t i;
 	size_t list_size = 0U;
 	dir_entry_t *parent_entry = NULL;
 
-	for(i = 0; i < view->local_filter.unfiltered_count; i++)
+	if(add)
 	{
-		/* FIXME: some very long file names won't be matched against some
-		 * regexps. */
-		char name_with_slash[NAME_MAX + 1 + 1];
+		dir_entry_t *const list = realloc(view->dir_entry,
+				sizeof(*list)*MAX(count, 1U));
+		if(list == NULL)
+		{
+			/* Old list might be too small to hold all matches.  It contains only
+			 * copies of entries of unfiltered list, so it's safe to just drop it and
+			 * leave the list empty. */
+			free(view->dir_entry);
+		}
+		view->dir_entry = list;
+	}
 
-		dir_entry_t *const entry = &view->local_filter.unfiltered[i];
-		const char *name = entry->name;
+	for(i = 0U; i < count; ++i)
+	{
+		dir_entry_t *const entry = &view->local_filter.unfiltered[matches[i]];
 
-		if(is_parent_dir(name))
+		if(is_parent_dir(entry->name))
 		{
 			parent_entry = entry;
-			if(add && cfg_parent_dir_is_visible(is_root_dir(view->curr_dir)))
+			if(!cfg_parent_dir_is_visible(is_root_dir(view->curr_dir)))
 			{
-				(void)add_dir_entry(&view->dir_entry, &list_size, entry);
+				continue;
 			}
-			continue;
 		}
 
-		if(is_directory_entry(entry))
+		if(add && view->dir_entry != NULL)
 		{
-			append_slash(name, name_with_slash, sizeof(name_with_slash));
-			name = name_with_slash;
+			view->dir_entry[list_size++] = *entry;
 		}
+	}
 
-		if(filter_matches(&view->local_filter.filter, name) != 0)
-		{
-			if(add)
-			{
-				(void)add_dir_entry(&view->dir_entry, &list_size, entry);
-			}
-		}
-		else
+	if(clear)
+	{
+		size_t j = 0U;
+		for(i = 0U; i < view->local_filter.unfiltered_count; ++i)
 		{
-			if(clear)
+			if(j < count && matches[j] == (int)i)
 			{
-				free_dir_entry(view, entry);
+				++j;
+				continue;
 			}
+			free_dir_entry(view, &view->local_filter.unfiltered[i]);
 		}
 	}
 
@@ -445,11 +694,19 @@ ensure_filtered_list_not_empty(FileView *view, dir_entry_t *parent_entry)
 	if(parent_entry == NULL)
 	{
 		add_parent_dir(view);
-		if(view->list_rows > 0)
-		{
-			(void)add_dir_entry(&view->local_filter.unfiltered,
+		if(view->list_rows > 0 &&
+				add_dir_entry(&view->local_filter.unfiltered,
 					&view->local_filter.unfiltered_count,
-					&view->dir_entry[view->list_rows - 1]);
+					&view->dir_entry[view->list_rows - 1]) == 0)
+		{
+			int *const matches = realloc(view->local_filter.matches,
+					sizeof(*matches)*(view->local_filter.matches_count + 1U));
+			if(matches != NULL)
+			{
+				matches[view->local_filter.matches_count++] =
+					view->local_filter.unfiltered_count - 1U;
+				view->local_filter.matches = matches;
+			}
 		}
 	}
 	else
@@ -583,6 +840,7 @@ local_filter_cancel(FileView *view)
 	view->dir_entry = NULL;
 	view->list_rows = 0;
 
+	match_unfiltered(view, 0);
 	update_filtering_lists(view, 1, 1);
 	local_filter_finish(view);
 }
@@ -598,6 +856,10 @@ local_filter_finish(FileView *view)
 	free(view->local_filter.poshist);
 	view->local_filter.poshist = NULL;
 	view->local_filter.poshist_len = 0U;
+
+	free(view->local_filter.matches);
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_count = 0U;
 }
 
 void
@@ -616,18 +878,26 @@ local_filter_restore(FileView *view)
 
 int
 local_filter_matches(FileView *view, const dir_entry_t *entry)
+{
+	return name_matches(&view->local_filter.filter, entry->name,
+			is_directory_entry(entry));
+}
+
+/* Checks whether name matches the filter, directories are matched with trailing
+ * slash.  Returns non-zero if so, otherwise zero is returned. */
+static int
+name_matches(filter_t *filter, const char name[], int is_dir)
 {
 	/* FIXME: some very long file names won't be matched against some
 	 * regexps. */
 	char name_with_slash[NAME_MAX + 1 + 1];
-	const char *filename = entry->name;
-	if(is_directory_entry(entry))
+	if(is_dir)
 	{
-		append_slash(filename, name_with_slash, sizeof(name_with_slash));
-		filename = name_with_slash;
+		append_slash(name, name_with_slash, sizeof(name_with_slash));
+		name = name_with_slash;
 	}
 
-	return filter_matches(&view->local_filter.filter, filename) != 0;
+	return filter_matches(filter, name) != 0;
 }
 
 /* Appends slash to the name and stores result in the buffer. */
@@ -22,10 +22,14 @@
 
 #include <stdlib.h> /* realloc() free() */
 #include <stdio.h> /* sprintf() */
-#include <string.h> /* strdup() */
+#include <string.h> /* strchr() strdup() */
 
+#include "utils/fs_limits.h"
 #include "utils/str.h"
+#include "utils/string_array.h"
 
+static const char * get_simple_ext(const char global[]);
+static void lower_ascii(char str[]);
 static char * globals_to_regex(const char globals[]);
 static char * global_to_regex(const char global[]);
 
@@ -61,6 +65,158 @@ global_compile_as_re(const char global[], regex_t *re)
 	return result;
 }
 
+int
+globals_compile(const char globals[], globals_t *compiled)
+{
+	char *other_globals = NULL;
+	size_t other_len = 0U;
+	char *globals_copy = strdup(globals);
+	char *global = globals_copy, *state = NULL;
+	int result = 0;
+
+	compiled->exts = NULL;
+	compiled->nexts = 0;
+	compiled->have_re = 0;
+
+	if(globals_copy == NULL)
+	{
+		return 1;
+	}
+
+	while((global = split_and_get(global, ',', &state)) != NULL)
+	{
+		const char *const ext = get_simple_ext(global);
+		if(ext != NULL)
+		{
+			const int nexts = add_to_string_array(&compiled->exts, compiled->nexts,
+					1, ext);
+			if(nexts != compiled->nexts)
+			{
+				lower_ascii(compiled->exts[compiled->nexts]);
+				compiled->nexts = nexts;
+				continue;
+			}
+		}
+
+		(void)strappend(&other_globals, &other_len, (other_len == 0U) ? "" : ",");
+		(void)strappend(&other_globals, &other_len, global);
+	}
+	free(globals_copy);
+
+	if(other_globals != NULL)
+	{
+		result = global_compile_as_re(other_globals, &compiled->re);
+		compiled->have_re = (result == 0);
+		free(other_globals);
+	}
+
+	if(result != 0)
+	{
+		globals_free(compiled);
+	}
+	return result;
+}
+
+int
+globals_match(const globals_t *compiled, const char file[])
+{
+	if(compiled->nexts != 0 && file[0] != '.' && file[0] != '\0')
+	{
+		/* "*.ext" is "^[^.].*\.ext$" regular expression, so the extension can
+		 * start after any dot except for the first character. */
+		char lowered[PATH_MAX];
+		const char *dot = lowered;
+
+		copy_str(lowered, sizeof(lowered), file);
+		lower_ascii(lowered);
+
+		while((dot = strchr(dot + 1, '.')) != NULL)
+		{
+			if(is_in_string_array(compiled->exts, compiled->nexts, dot + 1))
+			{
+				return 1;
+			}
+		}
+	}
+
+	return compiled->have_re && regexec(&compiled->re, file, 0, NULL, 0) == 0;
+}
+
+void
+globals_for_each_ext(const char file[],
+		void (*cb)(const char ext[], void *arg), void *arg)
+{
+	char lowered[PATH_MAX];
+	const char *dot;
+
+	if(file[0] == '.' || file[0] == '\0')
+	{
+		return;
+	}
+
+	copy_str(lowered, sizeof(lowered), file);
+	lower_ascii(lowered);
+
+	dot = lowered;
+	while((dot = strchr(dot + 1, '.')) != NULL)
+	{
+		cb(dot + 1, arg);
+	}
+}
+
+void
+globals_free(globals_t *compiled)
+{
+	free_string_array(compiled->exts, compiled->nexts);
+	compiled->exts = NULL;
+	compiled->nexts = 0;
+
+	if(compiled->have_re)
+	{
+		regfree(&compiled->re);
+		compiled->have_re = 0;
+	}
+}
+
+/* Checks whether global is of the form "*.ext" where ext consists only of
+ * ASCII characters that have no special meaning.  Returns pointer to ext part
+ * of the global or NULL. */
+static const char *
+get_simple_ext(const char global[])
+{
+	const char *p;
+
+	if(global[0] != '*' || global[1] != '.')
+	{
+		return NULL;
+	}
+
+	for(p = global + 2; *p != '\0'; ++p)
+	{
+		if((unsigned char)*p >= 0x80 || char_is_one_of("*?[]\\", *p))
+		{
+			return NULL;
+		}
+	}
+
+	return global + 2;
+}
+
+/* Converts ASCII letters of the string to lower case in place.  Other
+ * characters are left as is to match any locale in the same way. */
+static void
+lower_ascii(char str[])
+{
+	while(*str != '\0')
+	{
+		if(*str >= 'A' && *str <= 'Z')
+		{
+			*str += 'a' - 'A';
+		}
+		++str;
+	}
+}
+
 /* Converts comma-separated list of globals into equivalent regular expression.
  * Returns pointer to a newly allocated string, which should be freed by the
  * caller, or NULL if there is not enough memory or no patters are given. */
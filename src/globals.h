@@ -24,10 +24,38 @@
 /* Implements globals by converting them into regular expressions.  They are
  * treated as case insensitive. */
 
+/* Comma-separated list of globals compiled for repeated matching. */
+typedef struct
+{
+	char **exts;  /* Lower-cased suffixes of "*.ext" globals (without "*."). */
+	int nexts;    /* Number of elements in exts. */
+	regex_t re;   /* Regular expression that matches the rest of globals. */
+	int have_re;  /* Whether re field is initialized. */
+}
+globals_t;
+
 /* Checks whether file name matches comma-separated list of globals.  Returns
  * non-zero if so, otherwise zero is returned. */
 int global_matches(const char globals[], const char file[]);
 
+/* Compiles comma-separated list of globals.  Globals of the form "*.ext" are
+ * matched without regular expressions.  Returns zero on success, otherwise
+ * non-zero is returned. */
+int globals_compile(const char globals[], globals_t *compiled);
+
+/* Checks whether file name matches compiled globals.  Returns non-zero if so,
+ * otherwise zero is returned. */
+int globals_match(const globals_t *compiled, const char file[]);
+
+/* Lists suffixes of the file that can match "*.ext" globals (i.e., parts that
+ * follow dots).  Calls the callback with each lower-cased suffix from the
+ * longest to the shortest one. */
+void globals_for_each_ext(const char file[],
+		void (*cb)(const char ext[], void *arg), void *arg);
+
+/* Frees resources of compiled globals. */
+void globals_free(globals_t *compiled);
+
 /* Compiles global into regular expression.  Returns zero on success, on error
  * result of regcomp() is returned, which is non-zero. */
 int global_compile_as_re(const char global[], regex_t *re);
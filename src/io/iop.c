@@ -24,15 +24,23 @@
 
 #include "iop.h"
 
-#include <sys/stat.h> /* stat */
-#include <sys/types.h> /* mode_t */
-#include <unistd.h> /* rmdir() symlink() unlink() */
+#ifdef __linux__
+#include <linux/fs.h> /* FICLONE */
+#include <sys/ioctl.h> /* ioctl() */
+#include <sys/sendfile.h> /* sendfile() */
+#include <sys/syscall.h> /* SYS_copy_file_range */
+#endif
+
+#include <sys/stat.h> /* stat fstat() */
+#include <sys/types.h> /* mode_t off_t ssize_t */
+#include <unistd.h> /* read() rmdir() symlink() syscall() unlink() write() */
 
-#include <errno.h> /* EEXIST errno */
+#include <errno.h> /* EBADF EEXIST EINTR EINVAL ENOSYS ENOTSUP EOPNOTSUPP EXDEV
+                     errno */
 #include <stddef.h> /* NULL size_t */
 #include <stdio.h> /* FILE fpos_t fclose() fgetpos() fread() fseek() fsetpos()
                       fwrite() snprintf() */
-#include <stdlib.h> /* free() */
+#include <stdlib.h> /* free() malloc() */
 #include <string.h> /* strchr() */
 
 #include "../compat/os.h"
@@ -50,7 +58,38 @@
 #include "ioc.h"
 
 /* Amount of data to transfer at once. */
-#define BLOCK_SIZE 32*1024
+#define COPY_BLOCK_SIZE 32*1024
+
+/* Amount of data to transfer at once when copying is done by the kernel.  It's
+ * bigger as there is no buffer involved, but it also defines how often progress
+ * is updated and cancellation is checked. */
+#define KERNEL_BLOCK_SIZE 8*1024*1024
+
+/* Size of buffer for copying via read() and write(). */
+#define RW_BLOCK_SIZE 1024*1024
+
+#ifndef _WIN32
+
+/* Result of an attempt to copy data using one of the methods. */
+typedef enum
+{
+	CR_DONE,        /* All data was copied. */
+	CR_FAILED,      /* Copying failed. */
+	CR_UNSUPPORTED, /* Method can't be used, next one should be tried. */
+}
+CopyResult;
+
+#endif
+
+#ifndef _WIN32
+static int copy_file_data(io_args_t *const args, int in, int out, int append);
+static CopyResult clone_file(io_args_t *const args, int in, int out);
+static CopyResult copy_in_kernel(io_args_t *const args, int in, int out,
+		int use_sendfile);
+static CopyResult copy_via_buffer(io_args_t *const args, int in, int out);
+static int is_unsupported_error(int error);
+static int write_all(int fd, const char buf[], size_t len);
+#endif
 
 #ifdef _WIN32
 static DWORD CALLBACK win_progress_cb(LARGE_INTEGER total,
@@ -183,9 +222,11 @@ iop_cp(io_args_t *const args)
 	const io_confirm confirm = args->confirm;
 	const int cancellable = args->cancellable;
 
-	char block[BLOCK_SIZE];
-	FILE *in, *out;
+#ifdef _WIN32
+	char block[COPY_BLOCK_SIZE];
 	size_t nread;
+#endif
+	FILE *in, *out;
 	int error;
 	struct stat src_st;
 	const char *open_mode = "wb";
@@ -311,8 +352,15 @@ iop_cp(io_args_t *const args)
 		}
 	}
 
-	/* TODO: use sendfile() if platform supports it. */
-
+#ifndef _WIN32
+	if(!error)
+	{
+		/* Nothing was read or written through the streams, so it's safe to work
+		 * with underlying file descriptors directly. */
+		error = copy_file_data(args, fileno(in), fileno(out),
+				crs == IO_CRS_APPEND_TO_FILES);
+	}
+#else
 	while((nread = fread(&block, 1, sizeof(block), in)) != 0U)
 	{
 		if(cancellable && ui_cancellation_requested())
@@ -329,6 +377,7 @@ iop_cp(io_args_t *const args)
 
 		ioeta_update(args->estim, NULL, NULL, 0, nread);
 	}
+#endif
 
 	fclose(in);
 	fclose(out);
@@ -343,7 +392,211 @@ iop_cp(io_args_t *const args)
 	return error;
 }
 
-#ifdef _WIN32
+#ifndef _WIN32
+
+/* Copies data from current position of in file descriptor to out file
+ * descriptor trying the fastest methods first: cloning of the file (only when
+ * not appending), copying in the kernel and copying via a buffer.  Returns zero
+ * on success, otherwise non-zero is returned. */
+static int
+copy_file_data(io_args_t *const args, int in, int out, int append)
+{
+	CopyResult result = CR_UNSUPPORTED;
+
+	if(!append)
+	{
+		result = clone_file(args, in, out);
+	}
+	if(result == CR_UNSUPPORTED)
+	{
+		result = copy_in_kernel(args, in, out, 0);
+	}
+	if(result == CR_UNSUPPORTED)
+	{
+		result = copy_in_kernel(args, in, out, 1);
+	}
+	if(result == CR_UNSUPPORTED)
+	{
+		result = copy_via_buffer(args, in, out);
+	}
+
+	return result != CR_DONE;
+}
+
+/* Makes out a clone of in sharing data blocks (a "reflink"), which is possible
+ * only within single file system that supports it.  Returns status of the
+ * operation. */
+static CopyResult
+clone_file(io_args_t *const args, int in, int out)
+{
+#if defined(__linux__) && defined(FICLONE)
+	struct stat in_st, out_st;
+
+	if(fstat(in, &in_st) != 0 || fstat(out, &out_st) != 0 ||
+			in_st.st_dev != out_st.st_dev)
+	{
+		return CR_UNSUPPORTED;
+	}
+
+	if(ioctl(out, FICLONE, in) != 0)
+	{
+		return CR_UNSUPPORTED;
+	}
+
+	ioeta_update(args->estim, NULL, NULL, 0, in_st.st_size);
+	return CR_DONE;
+#else
+	return CR_UNSUPPORTED;
+#endif
+}
+
+/* Copies data without passing it through user space using either
+ * copy_file_range() or sendfile().  On failure due to lack of support by the
+ * system or file system, some data might already be copied, but file offsets
+ * are updated accordingly.  Returns status of the operation. */
+static CopyResult
+copy_in_kernel(io_args_t *const args, int in, int out, int use_sendfile)
+{
+#ifdef __linux__
+	int copied_any = 0;
+
+	for(;;)
+	{
+		ssize_t ncopied;
+
+		if(args->cancellable && ui_cancellation_requested())
+		{
+			return CR_FAILED;
+		}
+
+		if(use_sendfile)
+		{
+			ncopied = sendfile(out, in, NULL, KERNEL_BLOCK_SIZE);
+		}
+		else
+		{
+#ifdef SYS_copy_file_range
+			ncopied = syscall(SYS_copy_file_range, in, NULL, out, NULL,
+					(size_t)KERNEL_BLOCK_SIZE, 0U);
+#else
+			return CR_UNSUPPORTED;
+#endif
+		}
+
+		if(ncopied == 0)
+		{
+			/* Files of pseudo file systems like /proc and /sys report zero size and
+			 * aren't copied by the kernel, so let reading them be tried in case
+			 * there is some data. */
+			return copied_any ? CR_DONE : CR_UNSUPPORTED;
+		}
+
+		if(ncopied < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			return is_unsupported_error(errno) ? CR_UNSUPPORTED : CR_FAILED;
+		}
+
+		copied_any = 1;
+		ioeta_update(args->estim, NULL, NULL, 0, ncopied);
+	}
+#else
+	return CR_UNSUPPORTED;
+#endif
+}
+
+/* Copies data by reading it into a buffer and writing it out.  Returns status
+ * of the operation. */
+static CopyResult
+copy_via_buffer(io_args_t *const args, int in, int out)
+{
+	CopyResult result = CR_DONE;
+	char *const block = malloc(RW_BLOCK_SIZE);
+	if(block == NULL)
+	{
+		return CR_FAILED;
+	}
+
+	for(;;)
+	{
+		ssize_t nread;
+
+		if(args->cancellable && ui_cancellation_requested())
+		{
+			result = CR_FAILED;
+			break;
+		}
+
+		nread = read(in, block, RW_BLOCK_SIZE);
+		if(nread == 0)
+		{
+			break;
+		}
+
+		if(nread < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			result = CR_FAILED;
+			break;
+		}
+
+		if(write_all(out, block, nread) != 0)
+		{
+			result = CR_FAILED;
+			break;
+		}
+
+		ioeta_update(args->estim, NULL, NULL, 0, nread);
+	}
+
+	free(block);
+	return result;
+}
+
+/* Checks whether error code signals that the operation isn't supported for
+ * given file descriptors.  Returns non-zero if so, otherwise zero is
+ * returned. */
+static int
+is_unsupported_error(int error)
+{
+	return error == ENOSYS
+	    || error == EXDEV
+	    || error == EINVAL
+	    || error == EBADF
+	    || error == EOPNOTSUPP
+	    || error == ENOTSUP;
+}
+
+/* Writes all len bytes of the buffer into fd handling partial writes.  Returns
+ * zero on success, otherwise non-zero is returned. */
+static int
+write_all(int fd, const char buf[], size_t len)
+{
+	while(len != 0U)
+	{
+		const ssize_t nwritten = write(fd, buf, len);
+		if(nwritten < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			return 1;
+		}
+
+		buf += nwritten;
+		len -= nwritten;
+	}
+	return 0;
+}
+
+#else
 
 static DWORD CALLBACK win_progress_cb(LARGE_INTEGER total,
 		LARGE_INTEGER transferred, LARGE_INTEGER stream_size,
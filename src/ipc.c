@@ -30,6 +30,12 @@ ipc_check(void)
 {
 }
 
+int
+ipc_get_fd(void)
+{
+	return -1;
+}
+
 void
 ipc_send(char *data[])
 {
@@ -157,6 +163,16 @@ ipc_check(void)
 		receive_data();
 }
 
+int
+ipc_get_fd(void)
+{
+#ifndef _WIN32
+	return (initialized > 0 && server) ? sock : -1;
+#else
+	return -1;
+#endif
+}
+
 static void
 try_become_a_server(void)
 {
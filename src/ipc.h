@@ -28,6 +28,11 @@ void ipc_init(recieve_callback callback_func);
 /* Checks for incoming messages.  Calls callback passed to ipc_init(). */
 void ipc_check(void);
 
+/* Retrieves descriptor that becomes readable when there are incoming messages
+ * for ipc_check() to process.  Returns the descriptor or -1 if there is no
+ * such descriptor (e.g., current instance is not a server). */
+int ipc_get_fd(void);
+
 /* Sends data to server.  The data array should end with NULL. */
 void ipc_send(char *data[]);
 
@@ -21,16 +21,25 @@
 
 #include <curses.h>
 
+#ifndef _WIN32
+#include <fcntl.h> /* F_GETFL F_SETFL O_NONBLOCK fcntl() */
+#include <signal.h> /* SIGTERM kill() */
+#include <unistd.h> /* read() */
+#endif
+
 #include <assert.h> /* assert() */
+#include <errno.h> /* EAGAIN EINTR EWOULDBLOCK errno */
+#include <regex.h> /* regcomp() regexec() regfree() */
 #include <stddef.h> /* NULL size_t */
 #include <stdio.h> /* FILE */
-#include <stdlib.h> /* free() malloc() */
-#include <string.h> /* memmove() memset() strdup() strcat() strncat() strchr()
-                       strlen() strrchr() */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memchr() memcpy() memmove() memset() strdup() strcat()
+                       strncat() strchr() strlen() strrchr() */
 #include <wchar.h> /* wchar_t wcscmp() */
 
 #include "../cfg/config.h"
 #include "../compat/os.h"
+#include "../engine/mode.h"
 #include "../modes/dialogs/msg_dialog.h"
 #include "../modes/cmdline.h"
 #include "../modes/menu.h"
@@ -64,11 +73,38 @@
 static void open_selected_file(const char path[], int line_num);
 static void navigate_to_selected_file(FileView *view, const char path[]);
 static void normalize_top(menu_info *m);
+#ifndef _WIN32
+static int start_capture(FileView *view, pid_t pid, FILE *out, FILE *err,
+		menu_info *m);
+static int read_capture(void);
+static void add_captured_data(const char data[], size_t len);
+static void add_captured_line(const char data[], size_t len);
+static void finish_capture(void);
+static void stop_capture(void);
+static void update_matches(menu_info *m, int from);
+#endif
+static int append_item(menu_info *m, int *capacity, char item[]);
 static void append_to_string(char **str, const char suffix[]);
+static char * expand_item(const char item[]);
 static char * expand_tabulation_a(const char line[], size_t tab_stops);
 static size_t chars_in_str(const char s[], char c);
 TSTATIC char * parse_file_spec(const char spec[], int *line_num);
 
+#ifndef _WIN32
+/* Command, output of which is being put into a menu in background. */
+static struct
+{
+	menu_info *m;    /* Menu that receives the output or NULL. */
+	pid_t pid;       /* Process of the command. */
+	FILE *out;       /* Output of the command (in non-blocking mode). */
+	FILE *err;       /* Error stream of the command. */
+	char *line;      /* Incomplete last line or NULL. */
+	size_t line_len; /* Length of the incomplete last line. */
+	int capacity;    /* Number of allocated elements of m->items. */
+}
+capture;
+#endif
+
 static void
 show_position_in_menu(menu_info *m)
 {
@@ -104,32 +140,29 @@ clean_menu_position(menu_info *m)
 	int off = 0;
 	char * buf = (char *)NULL;
 	col_attr_t col;
+	char *const item = expand_item(m->items[m->pos]);
 
-	x = getmaxx(menu_win) + get_utf8_overhead(m->items[m->pos]);
+	x = getmaxx(menu_win) + get_utf8_overhead(item);
 
 	buf = malloc(x + 2);
 
 	/* TODO: check if this can ever be false. */
-	if(m->items[m->pos] != NULL)
+	if(item != NULL)
 	{
 		z = m->hor_pos;
-		while(z-- > 0 && m->items[m->pos][off] != '\0')
+		while(z-- > 0 && item[off] != '\0')
 		{
-			size_t l = get_char_width(m->items[m->pos] + off);
+			size_t l = get_char_width(item + off);
 			off += l;
 			x -= l - 1;
 		}
-		snprintf(buf, x, " %s", m->items[m->pos] + off);
+		snprintf(buf, x, " %s", item + off);
 	}
 	else
 	{
 		buf[0] = '\0';
 	}
 
-	for(z = 0; buf[z] != '\0'; z++)
-		if(buf[z] == '\t')
-			buf[z] = ' ';
-
 	for(z = strlen(buf); z < x; z++)
 		buf[z] = ' ';
 
@@ -146,7 +179,8 @@ clean_menu_position(menu_info *m)
 	wattrset(menu_win, COLOR_PAIR(colmgr_get_pair(col.fg, col.bg)) | col.attr);
 
 	checked_wmove(menu_win, m->current, 1);
-	if(get_screen_string_length(m->items[m->pos] + off) > getmaxx(menu_win) - 4)
+	if(item != NULL &&
+			get_screen_string_length(item + off) > getmaxx(menu_win) - 4)
 	{
 		size_t len = get_normal_utf8_string_widthn(buf,
 				getmaxx(menu_win) - 3 - 4 + 1);
@@ -169,6 +203,7 @@ clean_menu_position(menu_info *m)
 	wattroff(menu_win, COLOR_PAIR(colmgr_get_pair(col.fg, col.bg)) | col.attr);
 
 	free(buf);
+	free(item);
 }
 
 void
@@ -198,6 +233,13 @@ init_menu_info(menu_info *m, int menu_type, char empty_msg[])
 void
 reset_popup_menu(menu_info *m)
 {
+#ifndef _WIN32
+	if(capture.m == m)
+	{
+		stop_capture();
+	}
+#endif
+
 	free(m->args);
 	/* Menu elements don't always have data associated with them.  That's why we
 	 * need this check. */
@@ -234,6 +276,7 @@ move_to_menu_pos(int pos, menu_info *m)
 	int redraw = 0;
 	int x, z;
 	char *buf = NULL;
+	char *item;
 	col_attr_t col;
 	int off = 0;
 
@@ -276,32 +319,32 @@ move_to_menu_pos(int pos, menu_info *m)
 	if(redraw)
 		draw_menu(m);
 
-	x = getmaxx(menu_win) + get_utf8_overhead(m->items[pos]);
+	item = expand_item(m->items[pos]);
+	x = getmaxx(menu_win) + get_utf8_overhead(item);
 	buf = malloc(x + 2);
 	if(buf == NULL)
+	{
+		free(item);
 		return;
+	}
 	/* TODO: check if this can be false. */
-	if(m->items[pos] != NULL)
+	if(item != NULL)
 	{
 		z = m->hor_pos;
-		while(z-- > 0 && m->items[pos][off] != '\0')
+		while(z-- > 0 && item[off] != '\0')
 		{
-			size_t l = get_char_width(m->items[pos] + off);
+			size_t l = get_char_width(item + off);
 			off += l;
 			x -= l - 1;
 		}
 
-		snprintf(buf, x, " %s", m->items[pos] + off);
+		snprintf(buf, x, " %s", item + off);
 	}
 	else
 	{
 		buf[0] = '\0';
 	}
 
-	for(z = 0; buf[z] != '\0'; z++)
-		if(buf[z] == '\t')
-			buf[z] = ' ';
-
 	for(z = strlen(buf); z < x; z++)
 		buf[z] = ' ';
 
@@ -318,7 +361,8 @@ move_to_menu_pos(int pos, menu_info *m)
 	wattrset(menu_win, COLOR_PAIR(colmgr_get_pair(col.fg, col.bg)) | col.attr);
 
 	checked_wmove(menu_win, m->current, 1);
-	if(get_screen_string_length(m->items[pos] + off) > getmaxx(menu_win) - 4)
+	if(item != NULL &&
+			get_screen_string_length(item + off) > getmaxx(menu_win) - 4)
 	{
 		size_t len = get_normal_utf8_string_widthn(buf,
 				getmaxx(menu_win) - 3 - 4 + 1);
@@ -342,6 +386,7 @@ move_to_menu_pos(int pos, menu_info *m)
 
 	m->pos = pos;
 	free(buf);
+	free(item);
 	show_position_in_menu(m);
 }
 
@@ -475,7 +520,7 @@ draw_menu(menu_info *m)
 	for(i = 1; x < m->len; i++, x++)
 	{
 		int z, off;
-		char *buf;
+		char *item, *buf;
 		char *ptr = NULL;
 		col_attr_t col;
 
@@ -490,20 +535,22 @@ draw_menu(menu_info *m)
 			mix_colors(&col, &cfg.cs.color[SELECTED_COLOR]);
 		}
 
+		item = expand_item(m->items[x]);
+		if(item == NULL)
+		{
+			continue;
+		}
+
 		wattron(menu_win, COLOR_PAIR(colmgr_get_pair(col.fg, col.bg)) | col.attr);
 
 		z = m->hor_pos;
 		off = 0;
-		while(z-- > 0 && m->items[x][off] != '\0')
+		while(z-- > 0 && item[off] != '\0')
 		{
-			size_t l = get_char_width(m->items[x] + off);
+			size_t l = get_char_width(item + off);
 			off += l;
 		}
-
-		buf = strdup(m->items[x] + off);
-		for(z = 0; buf[z] != '\0'; z++)
-			if(buf[z] == '\t')
-				buf[z] = ' ';
+		buf = item + off;
 
 		checked_wmove(menu_win, i, 2);
 		if(get_screen_string_length(buf) > win_len - 4)
@@ -522,7 +569,7 @@ draw_menu(menu_info *m)
 		}
 		waddstr(menu_win, " ");
 
-		free(buf);
+		free(item);
 
 		wattroff(menu_win, COLOR_PAIR(colmgr_get_pair(col.fg, col.bg)) | col.attr);
 
@@ -543,19 +590,33 @@ capture_output_to_menu(FileView *view, const char cmd[], int user_sh,
 		menu_info *m)
 {
 	FILE *file, *err;
-	char *line = NULL;
-	int x;
 	pid_t pid;
+#ifdef _WIN32
+	char *line = NULL;
+	int capacity = 0;
+#endif
 
 	LOG_INFO_MSG("Capturing output of the command to a menu: %s", cmd);
 
-	pid = background_and_capture((char *)cmd, user_sh, &file, &err);
+#ifndef _WIN32
+	if(capture.m != NULL)
+	{
+		stop_capture();
+	}
+#endif
+
+	/* Command gets its own group to be able to kill its children on
+	 * stop_capture(). */
+	pid = background_and_capture((char *)cmd, user_sh, 1, &file, &err);
 	if(pid == (pid_t)-1)
 	{
 		show_error_msgf("Trouble running command", "Unable to run: %s", cmd);
 		return 0;
 	}
 
+#ifndef _WIN32
+	return start_capture(view, pid, file, err, m);
+#else
 	show_progress("", 0);
 
 	ui_cancellation_reset();
@@ -563,21 +624,16 @@ capture_output_to_menu(FileView *view, const char cmd[], int user_sh,
 
 	wait_for_data_from(pid, file, 0);
 
-	x = 0;
 	while((line = read_line(file, line)) != NULL)
 	{
-		char *expanded_line;
 		show_progress("Loading menu", 1000);
-		m->items = realloc(m->items, sizeof(char *)*(x + 1));
-		expanded_line = expand_tabulation_a(line, cfg.tab_stop);
-		if(expanded_line != NULL)
+		if(append_item(m, &capacity, line) == 0)
 		{
-			m->items[x++] = expanded_line;
+			line = NULL;
 		}
 
 		wait_for_data_from(pid, file, 0);
 	}
-	m->len = x;
 
 	ui_cancellation_disable();
 
@@ -590,9 +646,288 @@ capture_output_to_menu(FileView *view, const char cmd[], int user_sh,
 		append_to_string(&m->empty_msg, " (cancelled)");
 	}
 
+	return display_menu(m, view);
+#endif
+}
+
+int
+menu_capture_fd(void)
+{
+#ifndef _WIN32
+	return (capture.m == NULL) ? -1 : fileno(capture.out);
+#else
+	return -1;
+#endif
+}
+
+void
+menu_check_capture(void)
+{
+#ifndef _WIN32
+	menu_info *const m = capture.m;
+	int len;
+	int finished;
+
+	if(m == NULL)
+	{
+		return;
+	}
+
+	len = m->len;
+	finished = read_capture();
+	update_matches(m, len);
+
+	if(finished)
+	{
+		finish_capture();
+	}
+
+	if(vle_mode_is(MENU_MODE) && (finished || m->len != len))
+	{
+		redraw_menu(m);
+	}
+#endif
+}
+
+#ifndef _WIN32
+/* Puts output of the command into the menu and displays it as soon as there is
+ * something to show.  The rest of the output is collected by
+ * menu_check_capture() while the menu is being used.  Returns non-zero if
+ * status bar message should be saved. */
+static int
+start_capture(FileView *view, pid_t pid, FILE *out, FILE *err, menu_info *m)
+{
+	const int fd = fileno(out);
+	int finished;
+
+	(void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	capture.m = m;
+	capture.pid = pid;
+	capture.out = out;
+	capture.err = err;
+	capture.line = NULL;
+	capture.line_len = 0U;
+	capture.capacity = m->len;
+
+	show_progress("", 0);
+
+	ui_cancellation_reset();
+	ui_cancellation_enable();
+
+	/* Output is collected in background only after there is something to
+	 * display and there is main loop to do the collecting.  Cancelled command
+	 * is waited for to not lose its output.  Cancellation interrupts whole
+	 * process group (hence negative pid), otherwise children of the shell would
+	 * keep the pipe open. */
+	do
+	{
+		wait_for_data_from(-pid, NULL, fd);
+		show_progress("Loading menu", 1000);
+		finished = read_capture();
+	}
+	while(!finished && (m->len == 0 || curr_stats.load_stage < 2 ||
+				ui_cancellation_requested()));
+
+	ui_cancellation_disable();
+
+	if(finished)
+	{
+		finish_capture();
+	}
+
+	if(ui_cancellation_requested())
+	{
+		append_to_string(&m->title, "(cancelled) ");
+		append_to_string(&m->empty_msg, " (cancelled)");
+	}
+
 	return display_menu(m, view);
 }
 
+/* Reads output of the command that is available without blocking.  Returns
+ * non-zero if the output has ended, otherwise zero is returned. */
+static int
+read_capture(void)
+{
+	/* Limit on number of reads at a time, so that fast command doesn't make
+	 * the menu unresponsive. */
+	enum { MAX_READS = 64 };
+
+	char buf[4096];
+	int i;
+
+	for(i = 0; i < MAX_READS; ++i)
+	{
+		const ssize_t nread = read(fileno(capture.out), buf, sizeof(buf));
+		if(nread > 0)
+		{
+			add_captured_data(buf, nread);
+			continue;
+		}
+
+		if(nread == 0)
+		{
+			if(capture.line != NULL)
+			{
+				add_captured_line("", 0U);
+			}
+			return 1;
+		}
+
+		if(errno == EINTR)
+		{
+			continue;
+		}
+
+		return (errno != EAGAIN && errno != EWOULDBLOCK);
+	}
+
+	return 0;
+}
+
+/* Splits piece of output into lines adding complete ones to the menu. */
+static void
+add_captured_data(const char data[], size_t len)
+{
+	const char *const end = data + len;
+	while(data != end)
+	{
+		const char *const eol = memchr(data, '\n', end - data);
+		if(eol == NULL)
+		{
+			const size_t part_len = end - data;
+			char *const line = realloc(capture.line, capture.line_len + part_len);
+			if(line != NULL)
+			{
+				memcpy(line + capture.line_len, data, part_len);
+				capture.line = line;
+				capture.line_len += part_len;
+			}
+			break;
+		}
+
+		add_captured_line(data, eol - data);
+		data = eol + 1;
+	}
+}
+
+/* Completes last line with the data and adds it to the menu. */
+static void
+add_captured_line(const char data[], size_t len)
+{
+	const size_t line_len = capture.line_len + len;
+	char *const line = realloc(capture.line, line_len + 1U);
+	if(line == NULL)
+	{
+		return;
+	}
+
+	memcpy(line + capture.line_len, data, len);
+	line[line_len] = '\0';
+	if(line_len > 0U && line[line_len - 1U] == '\r')
+	{
+		line[line_len - 1U] = '\0';
+	}
+
+	capture.line = NULL;
+	capture.line_len = 0U;
+
+	if(append_item(capture.m, &capture.capacity, line) != 0)
+	{
+		free(line);
+	}
+}
+
+/* Releases resources of the command, output of which was read completely. */
+static void
+finish_capture(void)
+{
+	FILE *const err = capture.err;
+
+	free(capture.line);
+	fclose(capture.out);
+	capture.m = NULL;
+
+	show_errors_from_file(err, "Menu source error");
+}
+
+/* Terminates the command along with its children and releases resources. */
+static void
+stop_capture(void)
+{
+	(void)kill(-capture.pid, SIGTERM);
+
+	free(capture.line);
+	fclose(capture.out);
+	fclose(capture.err);
+	capture.m = NULL;
+}
+
+/* Extends results of search in the menu to items starting with the from one. */
+static void
+update_matches(menu_info *m, int from)
+{
+	int *matches;
+	regex_t re;
+	int x;
+
+	if(m->matches == NULL || from == m->len)
+	{
+		return;
+	}
+
+	matches = realloc(m->matches, sizeof(int)*m->len);
+	if(matches == NULL)
+	{
+		free(m->matches);
+		m->matches = NULL;
+		m->matching_entries = 0;
+		return;
+	}
+	m->matches = matches;
+	memset(m->matches + from, 0, sizeof(int)*(m->len - from));
+
+	if(m->regexp == NULL || m->regexp[0] == '\0' ||
+			regcomp(&re, m->regexp, get_regexp_cflags(m->regexp)) != 0)
+	{
+		return;
+	}
+
+	for(x = from; x < m->len; ++x)
+	{
+		if(regexec(&re, m->items[x], 0, NULL, 0) == 0)
+		{
+			m->matches[x] = 1;
+			++m->matching_entries;
+		}
+	}
+	regfree(&re);
+}
+#endif
+
+/* Adds the item to the end of the menu growing storage geometrically, *capacity
+ * is number of allocated items.  Returns zero on success, otherwise non-zero is
+ * returned and the item is left untouched. */
+static int
+append_item(menu_info *m, int *capacity, char item[])
+{
+	if(m->len == *capacity)
+	{
+		const int new_capacity = (*capacity == 0) ? 64 : *capacity*2;
+		char **const items = realloc(m->items, sizeof(char *)*new_capacity);
+		if(items == NULL)
+		{
+			return 1;
+		}
+		m->items = items;
+		*capacity = new_capacity;
+	}
+
+	m->items[m->len++] = item;
+	return 0;
+}
+
 /* Replaces *str with a copy of the with string extended by the suffix.  *str
  * can be NULL in which case it's treated as empty string. equal to the with (then function does nothing).  Returns non-zero if memory allocation
  * failed. */
@@ -608,6 +943,15 @@ append_to_string(char **str, const char suffix[])
 	}
 }
 
+/* Prepares text of menu item for displaying.  Tabulation is expanded only here,
+ * so that it's done only for items that are drawn.  Returns newly allocated
+ * string or NULL. */
+static char *
+expand_item(const char item[])
+{
+	return (item == NULL) ? NULL : expand_tabulation_a(item, cfg.tab_stop);
+}
+
 /* Clones the line replacing all occurrences of horizontal tabulation character
  * with appropriate number of spaces.  The tab_stops parameter shows how many
  * character position are taken by one tabulation.  Returns newly allocated
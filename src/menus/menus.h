@@ -148,6 +148,14 @@ char * prepare_targets(FileView *view);
 int capture_output_to_menu(FileView *view, const char cmd[], int user_sh,
 		menu_info *m);
 
+/* Retrieves descriptor of output of command that is still being put into a
+ * menu, which becomes readable when menu_check_capture() has something to
+ * process.  Returns the descriptor or -1 if there is no such command. */
+int menu_capture_fd(void);
+
+/* Adds available output of command to its menu and redraws the menu. */
+void menu_check_capture(void);
+
 /* Prepares menu, draws it and switches to the menu mode.  Returns non-zero if
  * status bar message should be saved. */
 int display_menu(menu_info *m, FileView *view);
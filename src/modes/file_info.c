@@ -38,7 +38,6 @@
 #include "../utils/fs_limits.h"
 #include "../utils/macros.h"
 #include "../utils/str.h"
-#include "../utils/tree.h"
 #include "../utils/utils.h"
 #include "../filelist.h"
 #include "../file_magic.h"
@@ -133,7 +132,7 @@ redraw_file_info_dialog(void)
 	{
 		char full_path[PATH_MAX];
 		get_current_full_path(view, sizeof(full_path), full_path);
-		tree_get_data(curr_stats.dirsize_cache, full_path, &size);
+		dcache_get_size(full_path, &size);
 	}
 
 	if(size == 0)
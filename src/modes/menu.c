@@ -25,7 +25,7 @@
 
 #include <assert.h> /* assert() */
 #include <stddef.h> /* NULL wchar_t */
-#include <stdlib.h> /* free() malloc() */
+#include <stdlib.h> /* free() realloc() */
 #include <string.h>
 
 #include "../cfg/config.h"
@@ -909,9 +909,13 @@ search_menu(menu_info *m, int start_pos)
 	int cflags;
 	regex_t re;
 	int err;
+	int *matches;
 
-	if(m->matches == NULL)
-		m->matches = malloc(sizeof(int)*m->len);
+	/* Menu can grow while its command is running. */
+	matches = realloc(m->matches, sizeof(int)*m->len);
+	if(matches == NULL)
+		return -1;
+	m->matches = matches;
 
 	memset(m->matches, 0, sizeof(int)*m->len);
 	m->matching_entries = 0;
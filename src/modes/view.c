@@ -23,8 +23,10 @@
 #include <regex.h>
 
 #include <assert.h> /* assert() */
+#include <ctype.h> /* isalpha() */
 #include <stddef.h> /* ptrdiff_t size_t */
-#include <string.h> /* memset() strdup() */
+#include <string.h> /* memchr() memcmp() memcpy() memset() strchr() strdup()
+                       strlen() strpbrk() strstr() */
 #include <stdio.h>  /* fclose() snprintf() */
 #include <stdlib.h> /* free() malloc() */
 
@@ -33,12 +35,14 @@
 #include "../engine/keys.h"
 #include "../engine/mode.h"
 #include "../modes/dialogs/msg_dialog.h"
+#include "../ui/cancellation.h"
 #include "../ui/statusbar.h"
 #include "../ui/ui.h"
 #include "../utils/filemon.h"
 #include "../utils/fs.h"
 #include "../utils/fs_limits.h"
 #include "../utils/macros.h"
+#include "../utils/paged_file.h"
 #include "../utils/path.h"
 #include "../utils/str.h"
 #include "../utils/string_array.h"
@@ -62,6 +66,13 @@
 /* Column at which view content should be displayed. */
 #define COL 1
 
+/* Files of this size and larger are read in windows of lines instead of being
+ * loaded into memory at once. */
+#define PAGED_VIEW_MIN_SIZE (16*1024*1024)
+
+/* Number of lines in a window of large file that are kept in memory. */
+#define PAGED_WINDOW 4096
+
 /* Named boolean values of "silent" parameter for better readability. */
 enum
 {
@@ -82,6 +93,13 @@ typedef struct
 	int width;
 	FileView *view;
 	regex_t re;
+	/* Search pattern if it can be matched as a plain string, otherwise NULL. */
+	char *literal;
+	/* Whether lines that don't match as a whole can be skipped on search. */
+	int prefilter;
+	/* Lazily filled index of lines that contain matches of search pattern: -1
+	 * for unknown, 0 for no match and 1 for match.  Can be NULL. */
+	signed char *matches;
 	int last_search_backward; /* Value -1 means no search was performed. */
 	int search_repeat; /* Saved count prefix of search commands. */
 	int wrap;
@@ -91,9 +109,24 @@ typedef struct
 
 	int auto_forward;   /* Whether auto forwarding (tail -F) is enabled. */
 	filemon_t file_mon; /* File monitor for auto forwarding mode. */
+
+	/* For large files lines contain only a window of the file that starts at
+	 * base line of the paged file. */
+	paged_file_t *pf; /* Source of lines or NULL if whole file is loaded. */
+	int base;         /* Number of the first line of the window in the file. */
 }
 view_info_t;
 
+/* State of search in a large file. */
+typedef struct
+{
+	char *buf;          /* Buffer for null-terminated copy of a line. */
+	size_t buf_len;     /* Size of the buffer. */
+	size_t literal_len; /* Length of literal pattern. */
+	int counter;        /* Number of processed lines. */
+}
+pf_search_state_t;
+
 /* View information structure indexes and count. */
 enum
 {
@@ -112,7 +145,17 @@ static void redraw(void);
 static void calc_vlines(void);
 static void calc_vlines_wrapped(view_info_t *vi);
 static void calc_vlines_non_wrapped(view_info_t *vi);
+static void recalc_vlines(view_info_t *vi);
 static void draw(void);
+static void shift_window(view_info_t *vi);
+static void goto_line(view_info_t *vi, int line);
+static int load_window(view_info_t *vi, int first);
+static int find_in_other_windows(int backward);
+static int count_lines(view_info_t *vi, const char msg[]);
+static void start_indexing(view_info_t *vi, const char msg[]);
+static void finish_indexing(view_info_t *vi, int clear_msg);
+static void set_search_pattern(const char pattern[], int cflags);
+static void set_linev(view_info_t *vi, int linev);
 static int get_part(const char line[], int offset, size_t max_len, char part[]);
 static void display_error(const char error_msg[]);
 static void cmd_ctrl_l(key_info_t key_info, keys_info_t *keys_info);
@@ -162,6 +205,16 @@ static void goto_search_result(int repeat_count, int inverse_direction);
 static void search(int repeat_count, int backward);
 static void find_previous(int vline_offset);
 static void find_next(void);
+static void report_search_result(int found);
+static int get_vline_count(int line);
+static int find_part(int line, int from, int to, int last);
+static int line_may_match(int line);
+static int line_has_match(int line);
+static void reset_matches(view_info_t *vi);
+static int text_matches(const char text[]);
+static int pf_line_matches(const char line[], size_t len, void *arg);
+static int contains_literal(const char text[], size_t len,
+		const char literal[], size_t literal_len);
 static void cmd_q(key_info_t key_info, keys_info_t *keys_info);
 static void cmd_u(key_info_t key_info, keys_info_t *keys_info);
 static void update_with_half_win(key_info_t *const key_info);
@@ -400,8 +453,21 @@ view_post(void)
 void
 view_ruler_update(void)
 {
-	char buf[POS_WIN_MIN_WIDTH + 1];
-	snprintf(buf, sizeof(buf), "%d-%d ", vi->line + 1, vi->nlines);
+	/* Enough for two integers, dash, plus and space. */
+	char buf[2*(sizeof("-2147483648") - 1U) + sizeof("-+ ")];
+
+	if(vi->pf != NULL)
+	{
+		/* Number of lines is unknown until whole file is indexed. */
+		int complete;
+		const int nlines = pf_known_lines(vi->pf, &complete);
+		snprintf(buf, sizeof(buf), "%d-%d%s ", vi->base + vi->line + 1, nlines,
+				complete ? "" : "+");
+	}
+	else
+	{
+		snprintf(buf, sizeof(buf), "%d-%d ", vi->line + 1, vi->nlines);
+	}
 
 	ui_ruler_set(buf);
 }
@@ -506,7 +572,10 @@ free_view_info(view_info_t *vi)
 	{
 		regfree(&vi->re);
 	}
+	free(vi->literal);
+	free(vi->matches);
 	free(vi->filename);
+	pf_close(vi->pf);
 }
 
 /* Updates line width and redraws the view. */
@@ -540,6 +609,26 @@ calc_vlines(void)
 	}
 }
 
+/* Recalculates virtual lines of a view after its lines were changed, if they
+ * were calculated before. */
+static void
+recalc_vlines(view_info_t *vi)
+{
+	if(vi->width <= 0)
+	{
+		return;
+	}
+
+	if(vi->wrap)
+	{
+		calc_vlines_wrapped(vi);
+	}
+	else
+	{
+		calc_vlines_non_wrapped(vi);
+	}
+}
+
 /* Recalculates virtual lines of a view with line wrapping. */
 static void
 calc_vlines_wrapped(view_info_t *vi)
@@ -575,7 +664,7 @@ draw(void)
 	const col_scheme_t *cs = ui_view_get_cs(vi->view);
 	const int height = vi->view->window_rows - 1;
 	const int width = vi->view->window_width - 1;
-	const int max_l = MIN(vi->line + height, vi->nlines);
+	int max_l;
 	const int searched = (vi->last_search_backward != -1);
 	esc_state state;
 
@@ -583,10 +672,14 @@ draw(void)
 	{
 		ui_view_clear(vi->view);
 		free_string_array(vi->lines, vi->nlines);
+		reset_matches(vi);
 		(void)get_view_data(vi, vi->filename);
 		return;
 	}
 
+	shift_window(vi);
+	max_l = MIN(vi->line + height, vi->nlines);
+
 	esc_state_init(&state, &cs->color[WIN_COLOR]);
 
 	ui_view_erase(vi->view);
@@ -596,7 +689,9 @@ draw(void)
 		int offset = 0;
 		int t = 0;
 		char *const line = vi->lines[l];
-		char *p = searched ? esc_highlight_pattern(line, &vi->re) : line;
+		/* Highlighting allocates memory, so do it only if there are matches. */
+		const int highlight = searched && line_has_match(l);
+		char *p = highlight ? esc_highlight_pattern(line, &vi->re) : line;
 		do
 		{
 			int printed;
@@ -607,7 +702,7 @@ draw(void)
 			t++;
 		}
 		while(vi->wrap && p[offset] != '\0' && vl < height);
-		if(searched)
+		if(highlight)
 		{
 			free(p);
 		}
@@ -615,10 +710,189 @@ draw(void)
 	refresh_view_win(vi->view);
 }
 
+/* Moves window of lines of a large file if position in the view gets close to
+ * its boundaries. */
+static void
+shift_window(view_info_t *vi)
+{
+	const int margin = PAGED_WINDOW/4;
+	const int height = vi->view->window_rows - 1;
+	int abs_line;
+	int sub_line;
+
+	if(vi->pf == NULL)
+	{
+		return;
+	}
+
+	if(vi->line >= margin || vi->base == 0)
+	{
+		if(vi->line + height + margin <= vi->nlines ||
+				!pf_has_line(vi->pf, vi->base + vi->nlines))
+		{
+			return;
+		}
+	}
+
+	abs_line = vi->base + vi->line;
+	sub_line = vi->linev - vi->widths[vi->line][0];
+
+	if(load_window(vi, MAX(0, abs_line - PAGED_WINDOW/2)) != 0)
+	{
+		return;
+	}
+
+	vi->line = MIN(abs_line - vi->base, vi->nlines - 1);
+	vi->linev = vi->widths[vi->line][0] + sub_line;
+}
+
+/* Moves position of the view to the line of a large file loading lines around
+ * it. */
+static void
+goto_line(view_info_t *vi, int line)
+{
+	if(load_window(vi, MAX(0, line - PAGED_WINDOW/2)) != 0)
+	{
+		return;
+	}
+
+	vi->line = MAX(0, MIN(line - vi->base, vi->nlines - 1));
+	vi->linev = vi->widths[vi->line][0];
+}
+
+/* Replaces lines of the view with a window of lines of a large file that
+ * starts with the first line.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+load_window(view_info_t *vi, int first)
+{
+	int nlines;
+	int (*widths)[2];
+	char **const lines = pf_read_lines(vi->pf, first, PAGED_WINDOW, &nlines);
+
+	if(lines == NULL || nlines == 0)
+	{
+		free(lines);
+		return 1;
+	}
+
+	widths = malloc(sizeof(*widths)*nlines);
+	if(widths == NULL)
+	{
+		free_string_array(lines, nlines);
+		return 1;
+	}
+
+	free_string_array(vi->lines, vi->nlines);
+	free(vi->widths);
+	reset_matches(vi);
+
+	vi->lines = lines;
+	vi->nlines = nlines;
+	vi->widths = widths;
+	vi->base = first;
+
+	recalc_vlines(vi);
+	return 0;
+}
+
+/* Looks for a match of the last search outside of window of lines of a large
+ * file and moves position of the view to it.  Returns non-zero if a match was
+ * found, otherwise zero is returned. */
+static int
+find_in_other_windows(int backward)
+{
+	pf_search_state_t state = {};
+	int line;
+
+	if(vi->pf == NULL || (backward && vi->base == 0))
+	{
+		return 0;
+	}
+
+	if(vi->literal != NULL)
+	{
+		state.literal_len = strlen(vi->literal);
+	}
+
+	start_indexing(vi, "Searching... (Ctrl-C to cancel)");
+
+	line = backward
+	     ? pf_find(vi->pf, vi->base - 1, 1, &pf_line_matches, &state)
+	     : pf_find(vi->pf, vi->base + vi->nlines, 0, &pf_line_matches, &state);
+
+	finish_indexing(vi, 1);
+	free(state.buf);
+
+	if(line == -2)
+	{
+		display_error("Search was cancelled");
+		/* Pretend that something was found to avoid another error message. */
+		return 1;
+	}
+
+	if(line < 0)
+	{
+		return 0;
+	}
+
+	goto_line(vi, line);
+	return 1;
+}
+
+/* Counts lines of large file letting user cancel indexing.  The msg is
+ * displayed while lines are being indexed unless it's NULL.  Returns number of
+ * lines, which is less than the real one if indexing was cancelled. */
+static int
+count_lines(view_info_t *vi, const char msg[])
+{
+	int complete;
+	int nlines;
+
+	(void)pf_known_lines(vi->pf, &complete);
+	if(complete)
+	{
+		return pf_count_lines(vi->pf);
+	}
+
+	start_indexing(vi, msg);
+	nlines = pf_count_lines(vi->pf);
+	finish_indexing(vi, msg != NULL);
+	return nlines;
+}
+
+/* Prepares for an operation on large file that might need to index many lines
+ * and lets user cancel it.  The msg is displayed unless it's NULL. */
+static void
+start_indexing(view_info_t *vi, const char msg[])
+{
+	if(msg != NULL)
+	{
+		ui_sb_quick_msgf("%s", msg);
+	}
+	ui_cancellation_reset();
+	ui_cancellation_enable();
+	pf_set_cancellable(vi->pf, 1);
+}
+
+/* Finishes operation started by start_indexing().  Message of the operation is
+ * removed if clear_msg is non-zero. */
+static void
+finish_indexing(view_info_t *vi, int clear_msg)
+{
+	pf_set_cancellable(vi->pf, 0);
+	ui_cancellation_disable();
+	if(clear_msg)
+	{
+		clean_status_bar();
+	}
+}
+
 int
 find_vwpattern(const char *pattern, int backward)
 {
 	int err;
+	int cflags;
 
 	if(pattern == NULL)
 		return 0;
@@ -626,7 +900,8 @@ find_vwpattern(const char *pattern, int backward)
 	if(vi->last_search_backward != -1)
 		regfree(&vi->re);
 	vi->last_search_backward = -1;
-	if((err = regcomp(&vi->re, pattern, get_regexp_cflags(pattern))) != 0)
+	cflags = get_regexp_cflags(pattern);
+	if((err = regcomp(&vi->re, pattern, cflags)) != 0)
 	{
 		status_bar_errorf("Invalid pattern: %s", get_regexp_error(err, &vi->re));
 		regfree(&vi->re);
@@ -635,12 +910,33 @@ find_vwpattern(const char *pattern, int backward)
 	}
 
 	vi->last_search_backward = backward;
+	set_search_pattern(pattern, cflags);
 
 	search(vi->search_repeat, backward);
 
 	return curr_stats.save_msg;
 }
 
+/* Analyzes search pattern, which was compiled with the cflags, to pick faster
+ * way of matching it. */
+static void
+set_search_pattern(const char pattern[], int cflags)
+{
+	const char *p;
+	int literal = (strpbrk(pattern, ".[]()*+?{}|^$\\") == NULL);
+
+	/* Case-insensitive comparison is left to regular expressions. */
+	for(p = pattern; *p != '\0' && literal && (cflags & REG_ICASE); ++p)
+	{
+		literal = !isalpha((unsigned char)*p) && (unsigned char)*p < 0x80;
+	}
+
+	free(vi->literal);
+	vi->literal = literal ? strdup(pattern) : NULL;
+	vi->prefilter = (strpbrk(pattern, "^$\\") == NULL);
+	reset_matches(vi);
+}
+
 static void
 cmd_ctrl_l(key_info_t key_info, keys_info_t *keys_info)
 {
@@ -873,6 +1169,14 @@ cmd_percent(key_info_t key_info, keys_info_t *keys_info)
 	if(key_info.count > 100)
 		key_info.count = 100;
 
+	if(vi->pf != NULL)
+	{
+		const int nlines = count_lines(vi, "Counting lines... (Ctrl-C to cancel)");
+		goto_line(vi, ((long long)key_info.count*nlines)/100);
+		draw();
+		return;
+	}
+
 	vi->line = (key_info.count*vi->nlinesv)/100;
 	if(vi->line >= vi->nlines)
 		vi->line = vi->nlines - 1;
@@ -1003,6 +1307,12 @@ load_view_data(view_info_t *vi, const char action[], const char file_to_view[],
 			return 1;
 	}
 
+	if(vi->pf != NULL)
+	{
+		/* Widths were allocated along with the window of lines. */
+		return 0;
+	}
+
 	vi->widths = malloc(sizeof(*vi->widths)*vi->nlines);
 	if(vi->widths == NULL)
 	{
@@ -1035,6 +1345,15 @@ get_view_data(view_info_t *vi, const char file_to_view[])
 			return 1;
 		}
 
+		if(get_file_size(file_to_view) >= PAGED_VIEW_MIN_SIZE)
+		{
+			vi->pf = pf_open(file_to_view);
+			if(vi->pf != NULL)
+			{
+				return (load_window(vi, 0) == 0) ? 0 : 4;
+			}
+		}
+
 		fp = os_fopen(file_to_view, "rb");
 		if(fp == NULL)
 		{
@@ -1090,7 +1409,10 @@ replace_vi(view_info_t *const orig, view_info_t *const new)
 	{
 		new->last_search_backward = orig->last_search_backward;
 		new->re = orig->re;
+		new->literal = orig->literal;
+		new->prefilter = orig->prefilter;
 		orig->last_search_backward = -1;
+		orig->literal = NULL;
 	}
 
 	new->win_size = orig->win_size;
@@ -1101,6 +1423,15 @@ replace_vi(view_info_t *const orig, view_info_t *const new)
 	new->auto_forward = orig->auto_forward;
 	filemon_assign(&new->file_mon, &orig->file_mon);
 
+	if(new->pf != NULL)
+	{
+		if(orig->base != 0)
+		{
+			(void)load_window(new, orig->base);
+		}
+		new->line = MIN(new->line, new->nlines - 1);
+	}
+
 	free_view_info(orig);
 	*orig = *new;
 }
@@ -1142,6 +1473,30 @@ cmd_g(key_info_t key_info, keys_info_t *keys_info)
 	if(key_info.count == NO_COUNT_GIVEN)
 		key_info.count = 1;
 
+	if(vi->pf != NULL)
+	{
+		int complete;
+		int line = key_info.count - 1;
+
+		/* Only lines that aren't indexed yet can take a while to find. */
+		if(line >= pf_known_lines(vi->pf, &complete) && !complete)
+		{
+			start_indexing(vi, "Looking for line... (Ctrl-C to cancel)");
+			(void)pf_has_line(vi->pf, line);
+			finish_indexing(vi, 1);
+		}
+
+		/* Last line of the file or last indexed one on cancellation. */
+		line = MIN(line, pf_known_lines(vi->pf, &complete) - 1);
+
+		goto_line(vi, line);
+		/* Don't leave empty space at the bottom. */
+		set_linev(vi, MIN(vi->linev,
+					MAX(0, vi->nlinesv - (vi->view->window_rows - 1))));
+		draw();
+		return;
+	}
+
 	key_info.count = MIN(vi->nlinesv - (vi->view->window_rows - 1),
 			key_info.count);
 	key_info.count = MAX(1, key_info.count);
@@ -1251,92 +1606,241 @@ search(int repeat_count, int backward)
 	}
 }
 
+/* Looks for a match of the last search above current position. */
 static void
 find_previous(int vline_offset)
 {
-	int i;
-	int offset = 0;
-	char buf[(vi->view->window_width - 1)*4];
-	int vl, l;
-
-	vl = vi->linev - vline_offset;
-	l = vi->line;
-
-	if(l > 0 && vl < vi->widths[l][0])
-		l--;
-
-	for(i = 0; i <= vl - vi->widths[l][0]; i++)
-		offset = get_part(vi->lines[l], offset, vi->view->window_width - 1, buf);
+	int l = vi->line;
+	int part = vi->linev - vi->widths[l][0] - vline_offset;
 
 	/* Don't stop until we go above first virtual line of the first line. */
-	while(l >= 0 && vl >= 0)
+	while(l >= 0)
 	{
-		if(regexec(&vi->re, buf, 0, NULL, 0) == 0)
+		if(part < 0)
 		{
-			vi->linev = vl;
-			vi->line = l;
-			break;
+			if(--l >= 0)
+			{
+				part = get_vline_count(l) - 1;
+			}
+			continue;
 		}
-		if(l > 0 && vl - 1 < vi->widths[l][0])
+
+		if(line_may_match(l))
 		{
-			l--;
-			offset = 0;
-			for(i = 0; i <= vl - 1 - vi->widths[l][0]; i++)
-				offset = get_part(vi->lines[l], offset, vi->view->window_width - 1,
-						buf);
+			const int found = find_part(l, 0, part, 1);
+			if(found >= 0)
+			{
+				vi->line = l;
+				vi->linev = vi->widths[l][0] + found;
+				draw();
+				return;
+			}
+		}
+
+		part = -1;
+	}
+
+	report_search_result(find_in_other_windows(1));
+}
+
+/* Looks for a match of the last search below current position. */
+static void
+find_next(void)
+{
+	int l = vi->line;
+	int part = vi->linev - vi->widths[l][0] + 1;
+
+	for(; l < vi->nlines; ++l, part = 0)
+	{
+		const int nparts = get_vline_count(l);
+		if(part < nparts && line_may_match(l))
+		{
+			const int found = find_part(l, part, nparts - 1, 0);
+			if(found >= 0)
+			{
+				vi->line = l;
+				vi->linev = vi->widths[l][0] + found;
+				draw();
+				return;
+			}
 		}
-		else
-			offset = get_part(vi->lines[l], offset, vi->view->window_width - 1, buf);
-		vl--;
 	}
+
+	report_search_result(find_in_other_windows(0));
+}
+
+/* Redraws the view and reports failed search if found is zero. */
+static void
+report_search_result(int found)
+{
 	draw();
-	if(vi->line != l)
+	if(!found)
 	{
 		display_error("Pattern not found");
 	}
 }
 
-static void
-find_next(void)
+/* Counts number of virtual lines that the line occupies.  Returns the
+ * number. */
+static int
+get_vline_count(int line)
+{
+	const int next = (line == vi->nlines - 1) ? vi->nlinesv
+	                                          : vi->widths[line + 1][0];
+	return next - vi->widths[line][0];
+}
+
+/* Looks for a virtual line of the line in [from, to] range that matches last
+ * search pattern.  Finds the last such virtual line if last is non-zero.
+ * Returns index of the virtual line or -1 if there is no match. */
+static int
+find_part(int line, int from, int to, int last)
 {
-	int i;
-	int offset = 0;
 	char buf[(vi->view->window_width - 1)*4];
-	int vl, l;
+	int offset = 0;
+	int found = -1;
+	int i;
 
-	vl = vi->linev + 1;
-	l = vi->line;
+	for(i = 0; i <= to; ++i)
+	{
+		offset = get_part(vi->lines[line], offset, vi->view->window_width - 1,
+				buf);
+		if(i >= from && text_matches(buf))
+		{
+			found = i;
+			if(!last)
+			{
+				break;
+			}
+		}
+	}
 
-	if(l < vi->nlines - 1 && vl == vi->widths[l + 1][0])
-		l++;
+	return found;
+}
 
-	for(i = 0; i <= vl - vi->widths[l][0]; i++)
-		offset = get_part(vi->lines[l], offset, vi->view->window_width - 1, buf);
+/* Checks whether line might contain a match of the last search pattern in one
+ * of its virtual lines.  Returns non-zero if so, otherwise zero is returned. */
+static int
+line_may_match(int line)
+{
+	/* Anchors and expanded tabulation can make a virtual line match while the
+	 * whole line doesn't. */
+	if(!vi->prefilter || strchr(vi->lines[line], '\t') != NULL)
+	{
+		return 1;
+	}
+	return line_has_match(line);
+}
 
-	while(l < vi->nlines)
+/* Checks whether line contains a match of the last search pattern consulting
+ * and updating index of matches.  Returns non-zero if so, otherwise zero is
+ * returned. */
+static int
+line_has_match(int line)
+{
+	if(vi->matches == NULL)
 	{
-		if(regexec(&vi->re, buf, 0, NULL, 0) == 0)
+		vi->matches = malloc(vi->nlines);
+		if(vi->matches == NULL)
 		{
-			vi->linev = vl;
-			vi->line = l;
-			break;
+			return 1;
 		}
-		if(l < vi->nlines && (l == vi->nlines - 1 ||
-				vl + 1 >= vi->widths[l + 1][0]))
+		memset(vi->matches, -1, vi->nlines);
+	}
+
+	if(vi->matches[line] < 0)
+	{
+		char *const no_esc = esc_remove(vi->lines[line]);
+		vi->matches[line] = text_matches(no_esc);
+		free(no_esc);
+	}
+
+	return vi->matches[line];
+}
+
+/* Forgets all matches of the last search pattern, which is needed when lines
+ * or the pattern change. */
+static void
+reset_matches(view_info_t *vi)
+{
+	free(vi->matches);
+	vi->matches = NULL;
+}
+
+/* Checks whether the text matches last search pattern.  Returns non-zero if
+ * so, otherwise zero is returned. */
+static int
+text_matches(const char text[])
+{
+	if(vi->literal != NULL)
+	{
+		return strstr(text, vi->literal) != NULL;
+	}
+	return regexec(&vi->re, text, 0, NULL, 0) == 0;
+}
+
+/* pf_find() callback that matches line against last search pattern and checks
+ * for cancellation requests. */
+static int
+pf_line_matches(const char line[], size_t len, void *arg)
+{
+	pf_search_state_t *const state = arg;
+
+	if(++state->counter%4096 == 0 && ui_cancellation_requested())
+	{
+		return -1;
+	}
+
+	if(vi->literal != NULL)
+	{
+		return contains_literal(line, len, vi->literal, state->literal_len);
+	}
+
+	if(len + 1U > state->buf_len)
+	{
+		char *const buf = realloc(state->buf, len + 1U);
+		if(buf == NULL)
 		{
-			if(l == vi->nlines - 1)
-				break;
-			l++;
-			offset = 0;
+			return -1;
 		}
-		offset = get_part(vi->lines[l], offset, vi->view->window_width - 1, buf);
-		vl++;
+		state->buf = buf;
+		state->buf_len = len + 1U;
 	}
-	draw();
-	if(vi->line != l)
+
+	memcpy(state->buf, line, len);
+	state->buf[len] = '\0';
+	return regexec(&vi->re, state->buf, 0, NULL, 0) == 0;
+}
+
+/* Checks whether the text of length len contains the literal of length
+ * literal_len.  Returns non-zero if so, otherwise zero is returned. */
+static int
+contains_literal(const char text[], size_t len, const char literal[],
+		size_t literal_len)
+{
+	const char *const end = text + len;
+	const char *p = text;
+
+	if(literal_len == 0U)
 	{
-		display_error("Pattern not found");
+		return 1;
 	}
+
+	while((size_t)(end - p) >= literal_len)
+	{
+		p = memchr(p, literal[0], (end - p) - literal_len + 1U);
+		if(p == NULL)
+		{
+			return 0;
+		}
+		if(memcmp(p, literal, literal_len) == 0)
+		{
+			return 1;
+		}
+		++p;
+	}
+
+	return 0;
 }
 
 /* Extracts part of the line replacing all occurrences of horizontal tabulation
@@ -1398,7 +1902,8 @@ cmd_v(key_info_t key_info, keys_info_t *keys_info)
 {
 	char path[PATH_MAX];
 	get_current_full_path(curr_view, sizeof(path), path);
-	(void)vim_view_file(path, vi->line + (vi->view->window_rows - 1)/2, -1, 1);
+	(void)vim_view_file(path, vi->base + vi->line + (vi->view->window_rows - 1)/2,
+			-1, 1);
 	/* In some cases two redraw operations are needed, otherwise TUI is not fully
 	 * redrawn. */
 	update_screen(UT_REDRAW);
@@ -1547,7 +2052,25 @@ forward_if_changed(view_info_t *vi)
 	}
 
 	filemon_assign(&vi->file_mon, &mon);
-	reload_view(vi, SILENT);
+
+	if(vi->pf != NULL)
+	{
+		/* Index of lines is reused if the file was only appended to. */
+		if(pf_refresh(vi->pf) != 0 || load_window(vi, vi->base) != 0)
+		{
+			reload_view(vi, SILENT);
+		}
+		else
+		{
+			vi->line = MIN(vi->line, vi->nlines - 1);
+			set_linev(vi, MIN(vi->linev, vi->nlinesv - 1));
+		}
+	}
+	else
+	{
+		reload_view(vi, SILENT);
+	}
+
 	return scroll_to_bottom(vi);
 }
 
@@ -1556,12 +2079,32 @@ forward_if_changed(view_info_t *vi)
 static int
 scroll_to_bottom(view_info_t *vi)
 {
+	if(vi->pf != NULL)
+	{
+		/* This is also called on automatic forwarding, so no message to avoid
+		 * flickering. */
+		const int first = MAX(0, count_lines(vi, NULL) - PAGED_WINDOW);
+		if(first != vi->base && load_window(vi, first) == 0)
+		{
+			vi->line = 0;
+			vi->linev = 0;
+		}
+	}
+
 	if(vi->linev + 1 + vi->view->window_rows - 1 > vi->nlinesv)
 	{
 		return 0;
 	}
 
-	vi->linev = vi->nlinesv - (vi->view->window_rows - 1);
+	set_linev(vi, vi->nlinesv - (vi->view->window_rows - 1));
+	return 1;
+}
+
+/* Sets virtual line of the view updating its line accordingly. */
+static void
+set_linev(view_info_t *vi, int linev)
+{
+	vi->linev = linev;
 	for(vi->line = 0; vi->line < vi->nlines - 1; ++vi->line)
 	{
 		if(vi->linev < vi->widths[vi->line + 1][0])
@@ -1569,8 +2112,6 @@ scroll_to_bottom(view_info_t *vi)
 			break;
 		}
 	}
-
-	return 1;
 }
 
 /* Reloads contents of the specified view by rerunning corresponding viewer or
@@ -117,12 +117,14 @@ static void hlsearch_handler(OPT_OP op, optval_t val);
 static void iec_handler(OPT_OP op, optval_t val);
 static void ignorecase_handler(OPT_OP op, optval_t val);
 static void incsearch_handler(OPT_OP op, optval_t val);
+static void iothreads_handler(OPT_OP op, optval_t val);
 static int parse_range(const char range[], int *from, int *to);
 static int parse_endpoint(const char **str, int *endpoint);
 static void laststatus_handler(OPT_OP op, optval_t val);
 static void lines_handler(OPT_OP op, optval_t val);
 static void locateprg_handler(OPT_OP op, optval_t val);
 static void mintimeoutlen_handler(OPT_OP op, optval_t val);
+static void previewtimeout_handler(OPT_OP op, optval_t val);
 static void scroll_line_down(FileView *view);
 static void rulerformat_handler(OPT_OP op, optval_t val);
 static void runexec_handler(OPT_OP op, optval_t val);
@@ -362,6 +364,10 @@ options[] = {
 	  OPT_BOOL, 0, NULL, &incsearch_handler ,
 	  { .ref.bool_val = &cfg.inc_search },
 	},
+	{ "iothreads", "",
+	  OPT_INT, 0, NULL, &iothreads_handler,
+	  { .ref.int_val = &cfg.io_threads },
+	},
 	{ "laststatus", "ls",
 	  OPT_BOOL, 0, NULL, &laststatus_handler,
 	  { .ref.bool_val = &cfg.display_statusline },
@@ -378,6 +384,10 @@ options[] = {
 	  OPT_INT, 0, NULL, &mintimeoutlen_handler,
 	  { .ref.int_val = &cfg.min_timeout_len },
 	},
+	{ "previewtimeout", "",
+	  OPT_INT, 0, NULL, &previewtimeout_handler,
+	  { .ref.int_val = &cfg.preview_timeout },
+	},
 	{ "rulerformat", "ruf",
 	  OPT_STR, 0, NULL, &rulerformat_handler,
 	  { .ref.str_val = &cfg.ruler_format },
@@ -1174,6 +1184,7 @@ iec_handler(OPT_OP op, optval_t val)
 {
 	cfg.use_iec_prefixes = val.bool_val;
 
+	fview_formatting_updated();
 	redraw_lists();
 }
 
@@ -1189,6 +1200,23 @@ incsearch_handler(OPT_OP op, optval_t val)
 	cfg.inc_search = val.bool_val;
 }
 
+/* Maximum number of files copied or moved at the same time by background
+ * operations. */
+static void
+iothreads_handler(OPT_OP op, optval_t val)
+{
+	if(val.int_val <= 0)
+	{
+		vle_tb_append_linef(vle_err, "Argument must be > 0: %d", val.int_val);
+		error = 1;
+		val.int_val = 1;
+		set_option("iothreads", val);
+		return;
+	}
+
+	cfg.io_threads = val.int_val;
+}
+
 /* Parses range, which can be shortened to single endpoint if first element
  * matches last one.  Returns non-zero on error, otherwise zero is returned. */
 static int
@@ -1328,6 +1356,23 @@ mintimeoutlen_handler(OPT_OP op, optval_t val)
 	cfg.min_timeout_len = val.int_val;
 }
 
+/* Time to wait for external viewer before displaying its output in
+ * background. */
+static void
+previewtimeout_handler(OPT_OP op, optval_t val)
+{
+	if(val.int_val < 0)
+	{
+		vle_tb_append_linef(vle_err, "Argument must be >= 0: %d", val.int_val);
+		error = 1;
+		val.int_val = 0;
+		set_option("previewtimeout", val);
+		return;
+	}
+
+	cfg.preview_timeout = val.int_val;
+}
+
 static void
 scroll_line_down(FileView *view)
 {
@@ -1685,6 +1730,7 @@ timefmt_handler(OPT_OP op, optval_t val)
 	strcpy(cfg.time_format, " ");
 	strcat(cfg.time_format, val.str_val);
 
+	fview_formatting_updated();
 	redraw_lists();
 }
 
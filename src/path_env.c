@@ -19,28 +19,53 @@
 #include "path_env.h"
 
 #include <stdio.h> /* snprintf() sprintf() */
-#include <stdlib.h> /* malloc() free() */
-#include <string.h> /* strchr() strlen() */
+#include <stdlib.h> /* calloc() malloc() free() */
+#include <string.h> /* strchr() strcmp() strlen() */
+#include <time.h> /* time() time_t */
 
 #include "cfg/config.h"
 #include "compat/os.h"
 #include "engine/variables.h"
 #include "utils/env.h"
+#include "utils/filemon.h"
 #include "utils/fs.h"
 #include "utils/fs_limits.h"
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/string_array.h"
+#include "utils/string_map.h"
+
+/* Cached list of files of a directory from PATH. */
+typedef struct
+{
+	char **names;        /* Names of files or NULL if not read. */
+	int count;           /* Number of elements in the names array. */
+	string_map_t *index; /* Set of names for fast lookups. */
+	filemon_t mon;       /* State of the directory when it was read. */
+	time_t checked;      /* Last time the state was compared with the cache. */
+}
+path_dir_t;
 
 static int path_env_was_changed(int force);
 static void append_scripts_dirs(void);
 static void add_dirs_to_path(const char *path);
 static void add_to_path(const char *path);
 static void split_path_list(void);
+static void reset_path_dirs(void);
+static path_dir_t * get_path_dir(size_t index);
+#ifndef _WIN32
+static int read_path_dir(path_dir_t *dir, const char path[]);
+#endif
+static void free_path_dir(path_dir_t *dir);
 
 static char **paths;
 static int paths_count;
 
+/* Caches of directories from the paths array, has paths_count elements. */
+static path_dir_t *path_dirs;
+/* Number of elements in the path_dirs array. */
+static int path_dirs_count;
+
 static char *clean_path;
 static char *real_path;
 
@@ -52,6 +77,26 @@ get_paths(size_t *count)
 	return paths;
 }
 
+char **
+get_path_dir_files(size_t index, int *count)
+{
+	path_dir_t *const dir = get_path_dir(index);
+	if(dir == NULL)
+	{
+		return NULL;
+	}
+
+	*count = dir->count;
+	return dir->names;
+}
+
+int
+path_dir_may_contain(size_t index, const char name[])
+{
+	path_dir_t *const dir = get_path_dir(index);
+	return dir == NULL || string_map_get(dir->index, name) != NULL;
+}
+
 void
 update_path_env(int force)
 {
@@ -233,6 +278,145 @@ split_path_list(void)
 	}
 	while(q[0] != '\0');
 	paths_count = i;
+
+	reset_path_dirs();
+}
+
+/* Drops caches of directories and prepares them for the new list of paths. */
+static void
+reset_path_dirs(void)
+{
+	int i;
+
+	for(i = 0; i < path_dirs_count; ++i)
+	{
+		free_path_dir(&path_dirs[i]);
+	}
+	free(path_dirs);
+
+	path_dirs = calloc(paths_count, sizeof(*path_dirs));
+	path_dirs_count = (path_dirs == NULL) ? 0 : paths_count;
+}
+
+/* Retrieves up to date cache of index-th directory of PATH.  Returns the cache
+ * or NULL if it's not available. */
+static path_dir_t *
+get_path_dir(size_t index)
+{
+#ifndef _WIN32
+	path_dir_t *dir;
+	filemon_t mon;
+	const time_t now = time(NULL);
+
+	update_path_env(0);
+
+	/* Contents of "." depends on current directory. */
+	if(index >= (size_t)path_dirs_count || strcmp(paths[index], ".") == 0)
+	{
+		return NULL;
+	}
+
+	dir = &path_dirs[index];
+	if(dir->names != NULL && dir->checked == now)
+	{
+		return dir;
+	}
+	dir->checked = now;
+
+	if(filemon_from_file(paths[index], &mon) != 0)
+	{
+		free_path_dir(dir);
+		return NULL;
+	}
+
+	if(dir->names != NULL && filemon_equal(&mon, &dir->mon))
+	{
+		return dir;
+	}
+
+	free_path_dir(dir);
+	if(read_path_dir(dir, paths[index]) != 0)
+	{
+		free_path_dir(dir);
+		return NULL;
+	}
+
+	filemon_assign(&dir->mon, &mon);
+	return dir;
+#else
+	/* Names of executables don't match names of files on Windows because of
+	 * extensions, so directories are always examined directly. */
+	return NULL;
+#endif
+}
+
+#ifndef _WIN32
+
+/* Reads list of files of the directory into the cache.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+read_path_dir(path_dir_t *dir, const char path[])
+{
+	DIR *d;
+	struct dirent *dentry;
+
+	dir->index = string_map_create();
+	if(dir->index == NULL)
+	{
+		return 1;
+	}
+
+	d = os_opendir(path);
+	if(d == NULL)
+	{
+		return 1;
+	}
+
+	while((dentry = os_readdir(d)) != NULL)
+	{
+		const int count = dir->count;
+
+		if(is_builtin_dir(dentry->d_name))
+		{
+			continue;
+		}
+
+		dir->count = add_to_string_array(&dir->names, count, 1, dentry->d_name);
+		if(dir->count == count ||
+				string_map_set(dir->index, dentry->d_name, dir) != 0)
+		{
+			os_closedir(d);
+			return 1;
+		}
+	}
+
+	os_closedir(d);
+
+	/* Empty directory is also a valid list. */
+	if(dir->names == NULL)
+	{
+		dir->names = malloc(sizeof(*dir->names));
+		if(dir->names == NULL)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+#endif
+
+/* Frees contents of the cache leaving it empty. */
+static void
+free_path_dir(path_dir_t *dir)
+{
+	free_string_array(dir->names, dir->count);
+	dir->names = NULL;
+	dir->count = 0;
+
+	string_map_free(dir->index, NULL);
+	dir->index = NULL;
 }
 
 void
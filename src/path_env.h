@@ -29,6 +29,18 @@ void update_path_env(int force);
  * the count argument. */
 char ** get_paths(size_t *count);
 
+/* Retrieves names of files in index-th directory of the list returned by
+ * get_paths().  Lists are cached and reread when modification time of the
+ * directory changes (which is checked at most once a second).  Returns the
+ * list, which shouldn't be freed by the caller, or NULL if the directory
+ * should be examined directly. */
+char ** get_path_dir_files(size_t index, int *count);
+
+/* Checks whether index-th directory of the list returned by get_paths() might
+ * contain file with the name.  Returns zero only if the file definitely isn't
+ * there. */
+int path_dir_may_contain(size_t index, const char name[]);
+
 /* Sets PATH to its value that was set by user or another program. Use
  * load_real_path_env() function to revert this effect. */
 void load_clean_path_env(void);
@@ -21,10 +21,22 @@
 
 #include <curses.h> /* mvwaddstr() werase() wattrset() */
 
+#ifndef _WIN32
+#include <poll.h> /* POLLIN poll() pollfd */
+#include <sys/time.h> /* gettimeofday() timeval */
+#include <sys/types.h> /* pid_t ssize_t */
+#include <signal.h> /* SIGTERM kill() */
+#include <unistd.h> /* close() read() */
+#endif
+#include <sys/stat.h> /* stat */
+
+#include <errno.h> /* EAGAIN EINTR EWOULDBLOCK errno */
+
 #include <stddef.h> /* NULL size_t */
-#include <stdio.h> /* FILE fclose() fdopen() feof() */
-#include <stdlib.h> /* free() */
-#include <string.h> /* memmove() strlen() strncat() */
+#include <stdio.h> /* FILE fclose() fdopen() feof() ferror() fileno() stdin */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memchr() memcpy() memmove() strcmp() strlen() strncat()
+                      strdup() */
 
 #include "cfg/config.h"
 #include "compat/os.h"
@@ -36,6 +48,7 @@
 #include "utils/file_streams.h"
 #include "utils/fs.h"
 #include "utils/fs_limits.h"
+#include "utils/lru_cache.h"
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/utf8.h"
@@ -45,6 +58,7 @@
 #include "colors.h"
 #include "escape.h"
 #include "filelist.h"
+#include "background.h"
 #include "filetype.h"
 #include "fileview.h"
 #include "macros.h"
@@ -59,17 +73,129 @@
 /* Size of buffer holding preview line (in characters). */
 #define PREVIEW_LINE_BUF_LEN 4096
 
-static void view_file(FILE *fp, int wrapped);
+/* Maximum amount of memory occupied by cached output of viewers. */
+#define PREVIEW_CACHE_SIZE (8*1024*1024)
+
+/* Maximum length of cached output of a single viewer, the rest is dropped. */
+#define MAX_PREVIEW_LEN (256*1024)
+
+/* Maximum time a viewer is allowed to run in advance (in milliseconds). */
+#define PREFETCH_TIMEOUT 5000
+
+/* Output of a viewer with line endings converted to '\n'. */
+typedef struct
+{
+	int complete; /* Whether this is whole output of the viewer. */
+	int nlines;   /* Number of complete lines in the text. */
+	size_t len;   /* Length of the text. */
+	char text[];  /* The output. */
+}
+preview_t;
+
+/* Source of lines for the preview: a stream or output of a viewer. */
+typedef struct
+{
+	FILE *fp;                 /* Stream to read from or NULL. */
+	const preview_t *preview; /* Output to read from if fp is NULL. */
+	size_t pos;               /* Current position within the output. */
+}
+preview_src_t;
+
+/* State of collecting output of a viewer. */
+typedef struct
+{
+	preview_t *preview; /* Output with space for MAX_PREVIEW_LEN characters. */
+	int rows;           /* Number of lines to collect. */
+	int cr;             /* Whether last processed character was '\r'. */
+}
+collector_t;
+
+#ifndef _WIN32
+/* Viewer, output of which is collected in background. */
+typedef struct
+{
+	pid_t pid;             /* Process of the viewer, leader of its group. */
+	int fd;                /* Read end of pipe with the output or -1. */
+	char *key;             /* Key of the output in the cache. */
+	collector_t collector; /* Output collected so far. */
+	struct timeval start;  /* Time at which the viewer was started. */
+}
+bg_viewer_t;
+
+/* Viewer to run in advance to have its output cached. */
+typedef struct
+{
+	char *key; /* Key of the output in the cache. */
+	char *cmd; /* Command to run. */
+}
+prefetch_item_t;
+#endif
+
+static void draw_preview(const preview_t *preview, int running);
+static void view_file(preview_src_t *src, int wrapped);
 static int shift_line(char line[], size_t len, size_t offset);
-static size_t add_to_line(FILE *fp, size_t max, char line[], size_t len);
+static size_t add_to_line(preview_src_t *src, size_t max, char line[],
+		size_t len);
+static char * src_get_line(preview_src_t *src, char buf[], size_t buf_len);
+static void src_skip_until_eol(preview_src_t *src);
+static int src_eof(const preview_src_t *src);
+static preview_t * get_preview(const char viewer[], const char path[],
+		int *running);
+static char * make_cache_key(const char cmd[], const char path[]);
+static preview_t * find_preview(const char key[], int rows);
+static const preview_t * lookup_preview(const char key[], int rows);
+static void store_preview(const char key[], preview_t *preview);
+static preview_t * copy_preview(const preview_t *preview);
+static preview_t * run_viewer(const char cmd[], int rows);
+static int collector_init(collector_t *collector, int rows);
+static int collect(collector_t *collector, const char data[], size_t len);
+static preview_t * collector_finish(collector_t *collector);
+static preview_t * run_cached_viewer(char cmd[], const char key[], int rows,
+		int *running);
+static void stop_viewer(void);
+static void prefetch_neighbours(FileView *view);
+static void stop_prefetching(void);
+#ifndef _WIN32
+static int start_viewer(bg_viewer_t *viewer, char cmd[], const char key[],
+		int rows);
+static int wait_for_viewer(int timeout);
+static int read_viewer_output(bg_viewer_t *viewer);
+static void finish_viewer(bg_viewer_t *viewer);
+static void kill_viewer(bg_viewer_t *viewer);
+static void release_viewer(bg_viewer_t *viewer, int kill_it);
+static int can_show_preview(void);
+static int ms_since(const struct timeval *since);
+static void add_prefetch_item(FileView *view, int pos);
+static void start_prefetching(void);
+static void check_prefetching(void);
+static void clear_prefetch_queue(void);
+#endif
 static char * get_viewer_command(const char viewer[]);
 
+/* Cached output of viewers, created on first use. */
+static lru_cache_t *preview_cache;
+
+#ifndef _WIN32
+/* Viewer of the file under the cursor. */
+static bg_viewer_t bg_viewer = { .fd = -1 };
+/* Viewer of a file next to the cursor, runs only while bg_viewer doesn't. */
+static bg_viewer_t prefetcher = { .fd = -1 };
+/* Viewers that are waiting to be run by the prefetcher. */
+static prefetch_item_t prefetch_queue[2];
+/* Number of elements in prefetch_queue. */
+static int prefetch_count;
+/* Number of lines that prefetched viewers should produce. */
+static int prefetch_rows;
+#endif
+
 void
 toggle_quick_view(void)
 {
 	if(curr_stats.view)
 	{
 		curr_stats.view = 0;
+		stop_viewer();
+		stop_prefetching();
 
 		if(ui_view_is_visible(other_view))
 		{
@@ -89,6 +215,8 @@ quick_view_file(FileView *view)
 {
 	char path[PATH_MAX];
 	const dir_entry_t *entry;
+	int running = 0;
+	int prefetch = 0;
 
 	if(curr_stats.load_stage < 2)
 	{
@@ -146,7 +274,8 @@ quick_view_file(FileView *view)
 		default:
 			{
 				const char *viewer;
-				FILE *fp;
+				FILE *fp = NULL;
+				preview_t *preview = NULL;
 
 				char *const typed_fname = get_typed_fname(path);
 				viewer = ft_get_viewer(typed_fname);
@@ -163,33 +292,72 @@ quick_view_file(FileView *view)
 				}
 				else
 				{
-					fp = use_info_prog(viewer);
+					preview = get_preview(viewer, path, &running);
 				}
 
-				if(fp == NULL)
+				if(fp == NULL && preview == NULL)
 				{
 					mvwaddstr(other_view->win, LINE, COL, "Cannot open file");
 					break;
 				}
 
 				ui_view_clear(other_view);
-				wattrset(other_view->win, 0);
-				view_file(fp, cfg.wrap_quick_view);
+				if(fp != NULL)
+				{
+					preview_src_t src = { .fp = fp };
+					wattrset(other_view->win, 0);
+					view_file(&src, cfg.wrap_quick_view);
+					fclose(fp);
+				}
+				else
+				{
+					draw_preview(preview, running);
+					free(preview);
+				}
 
-				fclose(fp);
+				prefetch = 1;
 				break;
 			}
 	}
+
+	/* Viewer of previous file is of no use anymore. */
+	if(!running)
+	{
+		stop_viewer();
+	}
+
+	if(prefetch)
+	{
+		prefetch_neighbours(view);
+	}
+
 	refresh_view_win(other_view);
 
 	ui_view_title_update(other_view);
 }
 
-/* Displays contents read from the fp in the other pane starting from the second
- * line and second column.  The wrapped parameter determines whether lines
- * should be wrapped. */
+/* Displays output of a viewer in the other pane.  The running parameter
+ * specifies whether the viewer is still running. */
+static void
+draw_preview(const preview_t *preview, int running)
+{
+	preview_src_t src = { .fp = NULL, .preview = preview, .pos = 0U };
+
+	wattrset(other_view->win, 0);
+	if(running && preview->len == 0U)
+	{
+		mvwaddstr(other_view->win, LINE, COL, "Viewer is running...");
+		return;
+	}
+
+	view_file(&src, cfg.wrap_quick_view);
+}
+
+/* Displays contents read from the src in the other pane starting from the
+ * second line and second column.  The wrapped parameter determines whether
+ * lines should be wrapped. */
 static void
-view_file(FILE *fp, int wrapped)
+view_file(preview_src_t *src, int wrapped)
 {
 	const size_t max_width = other_view->window_width - 1;
 	const size_t max_y = other_view->window_rows - 1;
@@ -198,7 +366,7 @@ view_file(FILE *fp, int wrapped)
 	char line[PREVIEW_LINE_BUF_LEN];
 	int line_continued = 0;
 	int y = LINE;
-	const char *res = get_line(fp, line, sizeof(line));
+	const char *res = src_get_line(src, line, sizeof(line));
 	esc_state state;
 
 	esc_state_init(&state, &cs->color[WIN_COLOR]);
@@ -207,10 +375,10 @@ view_file(FILE *fp, int wrapped)
 	{
 		int offset;
 		int printed;
-		const size_t len = add_to_line(fp, max_width, line, sizeof(line));
+		const size_t len = add_to_line(src, max_width, line, sizeof(line));
 		if(!wrapped && line[len - 1] != '\n')
 		{
-			skip_until_eol(fp);
+			src_skip_until_eol(src);
 		}
 
 		offset = esc_print_line(line, other_view->win, COL, y, max_width, 0, &state,
@@ -220,7 +388,7 @@ view_file(FILE *fp, int wrapped)
 
 		if(!wrapped || shift_line(line, len, offset))
 		{
-			res = get_line(fp, line, sizeof(line));
+			res = src_get_line(src, line, sizeof(line));
 		}
 	}
 }
@@ -240,17 +408,17 @@ shift_line(char line[], size_t len, size_t offset)
 	return 1;
 }
 
-/* Tries to add more characters from the fp file, but not exceed length of the
+/* Tries to add more characters from the src, but not exceed length of the
  * line buffer (the len parameter) and maximum number of printable character
  * positions (the max parameter).  Returns new length of the line buffer. */
 static size_t
-add_to_line(FILE *fp, size_t max, char line[], size_t len)
+add_to_line(preview_src_t *src, size_t max, char line[], size_t len)
 {
 	size_t n_len = get_normal_utf8_string_length(line) - esc_str_overhead(line);
 	size_t curr_len = strlen(line);
-	while(n_len < max && line[curr_len - 1] != '\n' && !feof(fp))
+	while(n_len < max && line[curr_len - 1] != '\n' && !src_eof(src))
 	{
-		if(get_line(fp, line + curr_len, len - curr_len) == NULL)
+		if(src_get_line(src, line + curr_len, len - curr_len) == NULL)
 		{
 			break;
 		}
@@ -260,6 +428,710 @@ add_to_line(FILE *fp, size_t max, char line[], size_t len)
 	return curr_len;
 }
 
+/* Reads next line or its part from the src like get_line() does.  Returns buf
+ * or NULL if there is nothing to read. */
+static char *
+src_get_line(preview_src_t *src, char buf[], size_t buf_len)
+{
+	const preview_t *const preview = src->preview;
+	const char *text;
+	const char *eol;
+	size_t len;
+
+	if(src->fp != NULL)
+	{
+		return get_line(src->fp, buf, buf_len);
+	}
+
+	if(buf_len <= 1U || src->pos >= preview->len)
+	{
+		return NULL;
+	}
+
+	text = preview->text + src->pos;
+	len = preview->len - src->pos;
+	if(len > buf_len - 1U)
+	{
+		len = buf_len - 1U;
+	}
+	eol = memchr(text, '\n', len);
+	if(eol != NULL)
+	{
+		len = eol - text + 1U;
+	}
+
+	memcpy(buf, text, len);
+	buf[len] = '\0';
+	src->pos += len;
+	return buf;
+}
+
+/* Skips the rest of current line of the src. */
+static void
+src_skip_until_eol(preview_src_t *src)
+{
+	const preview_t *const preview = src->preview;
+	const char *eol;
+
+	if(src->fp != NULL)
+	{
+		skip_until_eol(src->fp);
+		return;
+	}
+
+	eol = memchr(preview->text + src->pos, '\n', preview->len - src->pos);
+	src->pos = (eol == NULL) ? preview->len : (size_t)(eol - preview->text) + 1U;
+}
+
+/* Checks whether end of the src is reached.  Returns non-zero if so, otherwise
+ * zero is returned. */
+static int
+src_eof(const preview_src_t *src)
+{
+	return (src->fp != NULL) ? feof(src->fp) : src->pos >= src->preview->len;
+}
+
+/* Retrieves output of the viewer for the path, running it only if there is
+ * no suitable output in the cache.  Sets *running to non-zero if the viewer
+ * keeps running in background.  Returns newly allocated output or NULL on
+ * error. */
+static preview_t *
+get_preview(const char viewer[], const char path[], int *running)
+{
+	const int rows = other_view->window_rows;
+	char *const cmd = get_viewer_command(viewer);
+	char *const key = make_cache_key(cmd, path);
+	preview_t *preview = (key == NULL) ? NULL : find_preview(key, rows);
+
+	if(preview == NULL)
+	{
+		preview = (key == NULL)
+		        ? run_viewer(cmd, rows)
+		        : run_cached_viewer(cmd, key, rows, running);
+	}
+
+	free(key);
+	free(cmd);
+	return preview;
+}
+
+/* Makes key of output of the command for the path.  The key includes size and
+ * modification time of the file, so that changed files don't match old
+ * entries.  Returns newly allocated string or NULL on error. */
+static char *
+make_cache_key(const char cmd[], const char path[])
+{
+	struct stat st;
+	if(os_stat(path, &st) != 0)
+	{
+		return NULL;
+	}
+
+	return format_str("%s|%llu|%lld|%s", path, (unsigned long long)st.st_size,
+			(long long)st.st_mtime, cmd);
+}
+
+/* Looks up output of a viewer that fills at least rows lines.  Returns its
+ * newly allocated copy or NULL if there is no such entry. */
+static preview_t *
+find_preview(const char key[], int rows)
+{
+	const preview_t *const preview = lookup_preview(key, rows);
+	return (preview == NULL) ? NULL : copy_preview(preview);
+}
+
+/* Looks up output of a viewer that fills at least rows lines.  Returns the
+ * entry or NULL. */
+static const preview_t *
+lookup_preview(const char key[], int rows)
+{
+	const preview_t *preview;
+
+	if(preview_cache == NULL)
+	{
+		return NULL;
+	}
+
+	preview = lru_cache_get(preview_cache, key);
+	if(preview == NULL || (!preview->complete && preview->nlines < rows))
+	{
+		return NULL;
+	}
+	return preview;
+}
+
+/* Puts output of a viewer into the cache, which takes ownership of it. */
+static void
+store_preview(const char key[], preview_t *preview)
+{
+	if(preview_cache == NULL)
+	{
+		preview_cache = lru_cache_create(PREVIEW_CACHE_SIZE);
+	}
+	if(preview_cache == NULL)
+	{
+		free(preview);
+	}
+	else
+	{
+		(void)lru_cache_put(preview_cache, key, preview,
+				sizeof(*preview) + preview->len);
+	}
+}
+
+/* Makes a copy of output of a viewer.  Returns the copy or NULL on error. */
+static preview_t *
+copy_preview(const preview_t *preview)
+{
+	const size_t size = sizeof(*preview) + preview->len;
+	preview_t *const copy = malloc(size);
+	if(copy != NULL)
+	{
+		memcpy(copy, preview, size);
+	}
+	return copy;
+}
+
+/* Runs viewer command and collects its output until there are at least rows
+ * lines.  Returns newly allocated output or NULL on error. */
+static preview_t *
+run_viewer(const char cmd[], int rows)
+{
+	char line[PREVIEW_LINE_BUF_LEN];
+	collector_t collector;
+	FILE *const fp = read_cmd_output(cmd);
+	if(fp == NULL)
+	{
+		return NULL;
+	}
+
+	if(collector_init(&collector, rows) != 0)
+	{
+		fclose(fp);
+		return NULL;
+	}
+
+	while(1)
+	{
+		if(get_line(fp, line, sizeof(line)) == NULL)
+		{
+			collector.preview->complete = !ferror(fp);
+			break;
+		}
+
+		if(collect(&collector, line, strlen(line)))
+		{
+			break;
+		}
+	}
+
+	fclose(fp);
+	return collector_finish(&collector);
+}
+
+/* Prepares collector for receiving output of a viewer.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+collector_init(collector_t *collector, int rows)
+{
+	preview_t *const preview = malloc(sizeof(*preview) + MAX_PREVIEW_LEN);
+	if(preview == NULL)
+	{
+		return 1;
+	}
+
+	preview->complete = 0;
+	preview->nlines = 0;
+	preview->len = 0U;
+
+	collector->preview = preview;
+	collector->rows = rows;
+	collector->cr = 0;
+	return 0;
+}
+
+/* Appends piece of output converting line endings to '\n'.  Returns non-zero
+ * when no more output is needed. */
+static int
+collect(collector_t *collector, const char data[], size_t len)
+{
+	preview_t *const preview = collector->preview;
+	size_t i;
+
+	for(i = 0U; i < len; ++i)
+	{
+		char c = data[i];
+
+		/* "\r\n" is reduced to a single '\n', which is added on seeing '\r'. */
+		if(c == '\n' && collector->cr)
+		{
+			collector->cr = 0;
+			continue;
+		}
+		collector->cr = (c == '\r');
+		if(c == '\r')
+		{
+			c = '\n';
+		}
+
+		if(preview->len == MAX_PREVIEW_LEN)
+		{
+			return 1;
+		}
+
+		preview->text[preview->len++] = c;
+		if(c == '\n' && ++preview->nlines >= collector->rows)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Finishes collecting output.  Returns the output. */
+static preview_t *
+collector_finish(collector_t *collector)
+{
+	preview_t *const preview = collector->preview;
+
+	/* Release unused part of the buffer, which can be quite large. */
+	preview_t *const shrunk = realloc(preview, sizeof(*preview) + preview->len);
+	collector->preview = NULL;
+	return (shrunk == NULL) ? preview : shrunk;
+}
+
+/* Runs viewer and puts its output into the cache.  On *nix viewer that
+ * doesn't finish in time keeps running in background and *running is set to
+ * non-zero.  Returns newly allocated copy of output collected so far or NULL
+ * on error. */
+static preview_t *
+run_cached_viewer(char cmd[], const char key[], int rows, int *running)
+{
+#ifndef _WIN32
+	preview_t *preview;
+	int finished;
+
+	if(bg_viewer.fd != -1 && strcmp(bg_viewer.key, key) == 0)
+	{
+		/* Output is being collected already, it's just a redraw. */
+		*running = 1;
+		return copy_preview(bg_viewer.collector.preview);
+	}
+
+	stop_viewer();
+
+	if(prefetcher.fd != -1 && strcmp(prefetcher.key, key) == 0 &&
+			prefetcher.collector.rows >= rows)
+	{
+		/* The viewer was started in advance, continue collecting its output. */
+		bg_viewer = prefetcher;
+		prefetcher.fd = -1;
+		prefetcher.key = NULL;
+	}
+	else if(start_viewer(&bg_viewer, cmd, key, rows) != 0)
+	{
+		return NULL;
+	}
+
+	finished = wait_for_viewer(cfg.preview_timeout);
+	preview = copy_preview(bg_viewer.collector.preview);
+	if(finished)
+	{
+		finish_viewer(&bg_viewer);
+	}
+	*running = !finished;
+	return preview;
+#else
+	preview_t *const preview = run_viewer(cmd, rows);
+	if(preview != NULL)
+	{
+		preview_t *const copy = copy_preview(preview);
+		if(copy != NULL)
+		{
+			store_preview(key, copy);
+		}
+	}
+	return preview;
+#endif
+}
+
+/* Kills viewer running in background, if any. */
+static void
+stop_viewer(void)
+{
+#ifndef _WIN32
+	kill_viewer(&bg_viewer);
+#endif
+}
+
+/* Starts running viewers of files around cursor in background, so that moving
+ * cursor there doesn't need to wait for them.  Viewers are run one by one from
+ * the main loop and only while there is no viewer of the current file. */
+static void
+prefetch_neighbours(FileView *view)
+{
+#ifndef _WIN32
+	int i;
+	int wanted = 0;
+
+	/* Commands are expanded for the current file of the current view. */
+	if(view != curr_view || curr_stats.preview_hint != NULL)
+	{
+		return;
+	}
+
+	clear_prefetch_queue();
+	prefetch_rows = other_view->window_rows;
+	/* The queue is processed from its end, so the next file goes last. */
+	add_prefetch_item(view, view->list_pos - 1);
+	add_prefetch_item(view, view->list_pos + 1);
+
+	if(prefetcher.fd == -1)
+	{
+		start_prefetching();
+		return;
+	}
+
+	/* Viewer that's already running is kept if its output is still needed. */
+	for(i = 0; i < prefetch_count; ++i)
+	{
+		if(strcmp(prefetch_queue[i].key, prefetcher.key) == 0)
+		{
+			free(prefetch_queue[i].key);
+			free(prefetch_queue[i].cmd);
+			prefetch_queue[i] = prefetch_queue[--prefetch_count];
+			wanted = 1;
+			break;
+		}
+	}
+
+	if(!wanted || ms_since(&prefetcher.start) > PREFETCH_TIMEOUT)
+	{
+		kill_viewer(&prefetcher);
+		start_prefetching();
+	}
+#endif
+}
+
+/* Stops running viewers in advance and forgets about the pending ones. */
+static void
+stop_prefetching(void)
+{
+#ifndef _WIN32
+	clear_prefetch_queue();
+	kill_viewer(&prefetcher);
+#endif
+}
+
+#ifndef _WIN32
+
+/* Starts viewer in background.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+start_viewer(bg_viewer_t *viewer, char cmd[], const char key[], int rows)
+{
+	if(collector_init(&viewer->collector, rows) != 0)
+	{
+		return 1;
+	}
+
+	viewer->key = strdup(key);
+	if(viewer->key == NULL)
+	{
+		free(viewer->collector.preview);
+		return 1;
+	}
+
+	viewer->pid = bg_run_and_capture(cmd, &viewer->fd);
+	if(viewer->pid == (pid_t)-1)
+	{
+		free(viewer->collector.preview);
+		free(viewer->key);
+		viewer->key = NULL;
+		viewer->fd = -1;
+		return 1;
+	}
+
+	(void)gettimeofday(&viewer->start, NULL);
+	return 0;
+}
+
+/* Collects output of the viewer of current file for at most timeout
+ * milliseconds, stopping early if a key is pressed.  Returns non-zero if all
+ * output was collected. */
+static int
+wait_for_viewer(int timeout)
+{
+	struct timeval start;
+	(void)gettimeofday(&start, NULL);
+
+	while(1)
+	{
+		struct pollfd fds[2];
+		int wait_time;
+
+		if(read_viewer_output(&bg_viewer))
+		{
+			return 1;
+		}
+
+		wait_time = timeout - ms_since(&start);
+		if(wait_time <= 0)
+		{
+			return 0;
+		}
+
+		fds[0].fd = bg_viewer.fd;
+		fds[0].events = POLLIN;
+		fds[1].fd = fileno(stdin);
+		fds[1].events = POLLIN;
+
+		/* Signals (e.g., SIGCHLD) interrupt the wait, which is fine. */
+		if(poll(fds, 2, wait_time) > 0 && fds[1].revents != 0)
+		{
+			return 0;
+		}
+	}
+}
+
+/* Reads output of the viewer that's available at the moment.  Returns non-zero
+ * if the viewer shouldn't run anymore. */
+static int
+read_viewer_output(bg_viewer_t *viewer)
+{
+	char buf[PREVIEW_LINE_BUF_LEN];
+
+	while(1)
+	{
+		const ssize_t nread = read(viewer->fd, buf, sizeof(buf));
+		if(nread > 0)
+		{
+			if(collect(&viewer->collector, buf, nread))
+			{
+				return 1;
+			}
+			continue;
+		}
+
+		if(nread == 0)
+		{
+			viewer->collector.preview->complete = 1;
+			return 1;
+		}
+
+		if(errno != EINTR)
+		{
+			return (errno != EAGAIN && errno != EWOULDBLOCK);
+		}
+	}
+}
+
+/* Puts output of the viewer into the cache and releases the viewer. */
+static void
+finish_viewer(bg_viewer_t *viewer)
+{
+	const int complete = viewer->collector.preview->complete;
+	store_preview(viewer->key, collector_finish(&viewer->collector));
+	release_viewer(viewer, !complete);
+}
+
+/* Kills the viewer along with its children dropping its output, if it's
+ * running. */
+static void
+kill_viewer(bg_viewer_t *viewer)
+{
+	if(viewer->fd != -1)
+	{
+		free(viewer->collector.preview);
+		release_viewer(viewer, 1);
+	}
+}
+
+/* Frees resources of the viewer optionally killing it (along with its
+ * children). */
+static void
+release_viewer(bg_viewer_t *viewer, int kill_it)
+{
+	if(kill_it)
+	{
+		(void)kill(-viewer->pid, SIGTERM);
+	}
+	close(viewer->fd);
+	viewer->fd = -1;
+	free(viewer->key);
+	viewer->key = NULL;
+}
+
+/* Checks whether preview pane is visible and can be redrawn.  Returns non-zero
+ * if so, otherwise zero is returned. */
+static int
+can_show_preview(void)
+{
+	return curr_stats.view
+	    && curr_stats.number_of_windows != 1
+	    && (vle_primary_mode_is(NORMAL_MODE) || vle_primary_mode_is(VISUAL_MODE));
+}
+
+/* Computes time passed since the moment in time.  Returns the difference in
+ * milliseconds. */
+static int
+ms_since(const struct timeval *since)
+{
+	struct timeval now;
+	(void)gettimeofday(&now, NULL);
+	return (now.tv_sec - since->tv_sec)*1000
+	     + (now.tv_usec - since->tv_usec)/1000;
+}
+
+/* Queues viewer of file at the pos to be run in advance if the file is shown
+ * by an external viewer with output that's not in the cache. */
+static void
+add_prefetch_item(FileView *view, int pos)
+{
+	char path[PATH_MAX];
+	const dir_entry_t *entry;
+	const char *viewer;
+	char *typed_fname;
+	char *cmd;
+	char *key;
+	const int list_pos = view->list_pos;
+
+	if(pos < 0 || pos >= view->list_rows)
+	{
+		return;
+	}
+
+	entry = &view->dir_entry[pos];
+	if(entry->type != FT_REG && entry->type != FT_EXEC && entry->type != FT_DIR)
+	{
+		return;
+	}
+
+	get_full_path_of(entry, sizeof(path), path);
+	typed_fname = get_typed_fname(path);
+	viewer = ft_get_viewer(typed_fname);
+	free(typed_fname);
+	if(is_null_or_empty(viewer))
+	{
+		return;
+	}
+
+	view->list_pos = pos;
+	cmd = get_viewer_command(viewer);
+	view->list_pos = list_pos;
+
+	key = (cmd == NULL) ? NULL : make_cache_key(cmd, path);
+	if(key == NULL || lookup_preview(key, prefetch_rows) != NULL)
+	{
+		free(key);
+		free(cmd);
+		return;
+	}
+
+	prefetch_queue[prefetch_count].key = key;
+	prefetch_queue[prefetch_count].cmd = cmd;
+	++prefetch_count;
+}
+
+/* Runs next queued viewer in advance if nothing else is running. */
+static void
+start_prefetching(void)
+{
+	while(prefetcher.fd == -1 && bg_viewer.fd == -1 && prefetch_count != 0)
+	{
+		prefetch_item_t *const item = &prefetch_queue[--prefetch_count];
+		(void)start_viewer(&prefetcher, item->cmd, item->key, prefetch_rows);
+		free(item->key);
+		free(item->cmd);
+	}
+}
+
+/* Collects output of viewer that runs in advance and starts the next one when
+ * it's done. */
+static void
+check_prefetching(void)
+{
+	if(prefetcher.fd == -1)
+	{
+		return;
+	}
+
+	if(read_viewer_output(&prefetcher))
+	{
+		finish_viewer(&prefetcher);
+		start_prefetching();
+	}
+}
+
+/* Frees viewers that are waiting to be run in advance. */
+static void
+clear_prefetch_queue(void)
+{
+	while(prefetch_count != 0)
+	{
+		--prefetch_count;
+		free(prefetch_queue[prefetch_count].key);
+		free(prefetch_queue[prefetch_count].cmd);
+	}
+}
+
+#endif
+
+int
+qv_viewer_fd(void)
+{
+#ifndef _WIN32
+	return (bg_viewer.fd != -1) ? bg_viewer.fd : prefetcher.fd;
+#else
+	return -1;
+#endif
+}
+
+void
+qv_check_viewer(void)
+{
+#ifndef _WIN32
+	int finished;
+
+	if(bg_viewer.fd == -1)
+	{
+		check_prefetching();
+		return;
+	}
+
+	finished = read_viewer_output(&bg_viewer);
+
+	if(can_show_preview())
+	{
+		ui_view_erase(other_view);
+		draw_preview(bg_viewer.collector.preview, !finished);
+		refresh_view_win(other_view);
+	}
+
+	if(finished)
+	{
+		finish_viewer(&bg_viewer);
+		start_prefetching();
+	}
+#endif
+}
+
+int
+qv_check_prefetching(void)
+{
+#ifndef _WIN32
+	if(prefetcher.fd != -1 && ms_since(&prefetcher.start) > PREFETCH_TIMEOUT)
+	{
+		kill_viewer(&prefetcher);
+		start_prefetching();
+	}
+	return (prefetcher.fd != -1);
+#else
+	return 0;
+#endif
+}
+
 void
 preview_close(void)
 {
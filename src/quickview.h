@@ -33,6 +33,20 @@ void preview_close(void);
 
 FILE * use_info_prog(const char viewer[]);
 
+/* Retrieves descriptor of output of viewer running in background, which
+ * becomes readable when qv_check_viewer() has something to process.  Returns
+ * the descriptor or -1 if there is no such viewer. */
+int qv_viewer_fd(void);
+
+/* Collects output of viewer running in background and updates preview pane or
+ * puts output of viewer that was run in advance into the cache. */
+void qv_check_viewer(void);
+
+/* Stops viewer run in advance if it's been running for too long.  Returns
+ * non-zero if a viewer is still running in advance, otherwise zero is
+ * returned. */
+int qv_check_prefetching(void);
+
 #endif /* VIFM__QUICKVIEW_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
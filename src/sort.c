@@ -20,299 +20,548 @@
 #include "sort.h"
 
 #include <assert.h> /* assert() */
-#include <ctype.h>
-#include <stdlib.h> /* abs() qsort() */
-#include <string.h> /* strrchr() */
+#include <ctype.h> /* isdigit() */
+#include <stdlib.h> /* abs() free() malloc() qsort() */
+#include <string.h> /* memcmp() memcpy() strcmp() strdup() strlen()
+                       strrchr() */
 
 #include "cfg/config.h"
 #include "ui/ui.h"
 #include "utils/fs_limits.h"
+#include "utils/log.h"
+#include "utils/macros.h"
 #include "utils/path.h"
 #include "utils/str.h"
 #include "utils/test_helpers.h"
-#include "utils/tree.h"
 #include "utils/utils.h"
 #include "filelist.h"
 #include "status.h"
 #include "types.h"
 
+/* Precomputed data of an entry that is used during sorting, so that it's
+ * computed once per entry rather than once per comparison. */
+typedef struct
+{
+	dir_entry_t *entry; /* Entry this record corresponds to. */
+	int index;          /* Original position of the entry, makes sorting stable. */
+	int is_parent;      /* Whether entry is a reference to parent directory. */
+	int is_dir;         /* Whether entry is a directory or a link to one. */
+	const char *name;   /* Name to sort by, short path for custom views. */
+	char *short_path;   /* Allocated short path of custom view entry or NULL. */
+	char *iname;        /* Lower case version of the name or NULL. */
+	const char *ext;    /* Extension of the name or NULL. */
+
+	/* Natural sorting keys, used when cfg.sort_numbers is set. */
+	const sort_key_t *name_key;  /* Key of the name or NULL. */
+	const sort_key_t *iname_key; /* Key of lower case name or NULL. */
+	const sort_key_t *fname_key; /* Key of entry->name or NULL. */
+	sort_key_t path_key;         /* Key of short path (owned by the record). */
+	sort_key_t ipath_key;        /* Key of lower case short path (owned). */
+	sort_key_t ext_key;          /* Key of the extension (owned). */
+#ifndef _WIN32
+	char perms[11];     /* Permissions string or empty string. */
+#endif
+}
+sort_rec_t;
+
 /* View which is being sorted. */
 static FileView* view;
 /* Whether the view displays custom file list. */
 static int custom_view;
-static int sort_descending;
-static int sort_type;
-
-static void sort_by_key(char key);
-static int sort_dir_list(const void *one, const void *two);
-TSTATIC int strnumcmp(const char s[], const char t[]);
-#if !defined(HAVE_STRVERSCMP_FUNC) || !HAVE_STRVERSCMP_FUNC
-static int vercmp(const char s[], const char t[]);
-#else
-static char * skip_leading_zeros(const char str[]);
-#endif
-static int compare_entry_names(const dir_entry_t *a, const dir_entry_t *b,
-		int ignore_case);
-static int compare_full_file_names(const char s[], const char t[],
+/* Keys to sort by in the order of their significance. */
+static char sort_keys[SK_COUNT + 1];
+/* Number of elements in sort_keys array. */
+static int nsort_keys;
+
+static void collect_sort_keys(void);
+static int has_sort_key(int key);
+static int fill_sort_rec(sort_rec_t *rec, dir_entry_t *entry, int index);
+static void free_sort_recs(sort_rec_t recs[], int count);
+static int sort_recs(const void *one, const void *two);
+static int fill_natural_keys(sort_rec_t *rec);
+static const sort_key_t * get_cached_key(sort_key_t *key, const char name[],
 		int ignore_case);
-static int compare_file_names(const char s[], const char t[], int ignore_case);
+static int compare_by_key(const sort_rec_t *first, const sort_rec_t *second,
+		int sort_type);
+TSTATIC int strnumcmp(const char s[], const char t[]);
+TSTATIC int make_natural_key(const char str[], sort_key_t *key);
+static int compare_full_file_names(const char s[], const sort_key_t *s_key,
+		const char t[], const sort_key_t *t_key);
+static int compare_file_names(const char s[], const sort_key_t *s_key,
+		const char t[], const sort_key_t *t_key);
+static int compare_keys(const sort_key_t *a, const sort_key_t *b);
 
 void
 sort_view(FileView *v)
 {
+	sort_rec_t *recs;
+	dir_entry_t *sorted;
 	int i;
 
+	if(v->list_rows < 2)
+	{
+		return;
+	}
+
 	view = v;
 	custom_view = flist_custom_active(v);
+	collect_sort_keys();
 
-	i = SK_COUNT;
-	while(--i >= 0)
+	recs = malloc(sizeof(*recs)*view->list_rows);
+	sorted = malloc(sizeof(*sorted)*view->list_rows);
+	if(recs == NULL || sorted == NULL)
 	{
-		const char sorting_key = view->sort[i];
+		LOG_ERROR_MSG("Not enough memory to sort file list");
+		free(recs);
+		free(sorted);
+		return;
+	}
 
-		if(abs(sorting_key) > SK_LAST)
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		if(fill_sort_rec(&recs[i], &view->dir_entry[i], i) != 0)
 		{
-			continue;
+			LOG_ERROR_MSG("Not enough memory to sort file list");
+			free_sort_recs(recs, i + 1);
+			free(sorted);
+			return;
 		}
-
-		sort_by_key(sorting_key);
 	}
 
-	if(!ui_view_sort_list_contains(v->sort, SK_BY_TYPE))
+	/* All keys are compared at once, so one pass is enough. */
+	qsort(recs, view->list_rows, sizeof(*recs), &sort_recs);
+
+	for(i = 0; i < view->list_rows; ++i)
 	{
-		sort_by_key(SK_BY_TYPE);
+		sorted[i] = *recs[i].entry;
 	}
+	memcpy(view->dir_entry, sorted, sizeof(*sorted)*view->list_rows);
+
+	free_sort_recs(recs, view->list_rows);
+	free(sorted);
 }
 
-/* Sorts view by the key in a stable way. */
+/* Fills sort_keys array from sort option of the view. */
 static void
-sort_by_key(char key)
+collect_sort_keys(void)
 {
-	int j;
+	int i;
 
-	sort_descending = (key < 0);
-	sort_type = abs(key);
+	nsort_keys = 0;
 
-	for(j = 0; j < view->list_rows; j++)
+	/* Entries are always grouped by type, unless it's requested explicitly. */
+	if(!ui_view_sort_list_contains(view->sort, SK_BY_TYPE))
 	{
-		view->dir_entry[j].list_num = j;
+		sort_keys[nsort_keys++] = SK_BY_TYPE;
 	}
 
-	qsort(view->dir_entry, view->list_rows, sizeof(dir_entry_t), sort_dir_list);
+	for(i = 0; i < SK_COUNT; ++i)
+	{
+		const char sorting_key = view->sort[i];
+		if(abs(sorting_key) <= SK_LAST)
+		{
+			sort_keys[nsort_keys++] = sorting_key;
+		}
+	}
 }
 
-/* Compares file names containing numbers correctly. */
-TSTATIC int
-strnumcmp(const char s[], const char t[])
+/* Checks whether key is among collected sort keys (in any direction).  Returns
+ * non-zero if so, otherwise zero is returned. */
+static int
+has_sort_key(int key)
 {
-#if !defined(HAVE_STRVERSCMP_FUNC) || !HAVE_STRVERSCMP_FUNC
-	return vercmp(s, t);
-#else
-	const char *new_s = skip_leading_zeros(s);
-	const char *new_t = skip_leading_zeros(t);
-	return strverscmp(new_s, new_t);
-#endif
+	int i;
+	for(i = 0; i < nsort_keys; ++i)
+	{
+		if(abs(sort_keys[i]) == key)
+		{
+			return 1;
+		}
+	}
+	return 0;
 }
 
-#if !defined(HAVE_STRVERSCMP_FUNC) || !HAVE_STRVERSCMP_FUNC
+/* Computes data of the entry needed by collected sort keys.  Record is left in
+ * a state suitable for free_sort_recs() even on failure.  Returns zero on
+ * success, otherwise non-zero is returned. */
 static int
-vercmp(const char s[], const char t[])
+fill_sort_rec(sort_rec_t *rec, dir_entry_t *entry, int index)
 {
-	while(*s != '\0' && *t != '\0')
+	rec->entry = entry;
+	rec->index = index;
+	rec->is_parent = is_parent_dir(entry->name);
+	rec->is_dir = is_directory_entry(entry);
+	rec->name = entry->name;
+	rec->short_path = NULL;
+	rec->iname = NULL;
+	rec->ext = NULL;
+#ifndef _WIN32
+	rec->perms[0] = '\0';
+#endif
+	rec->name_key = NULL;
+	rec->iname_key = NULL;
+	rec->fname_key = NULL;
+	rec->path_key.data = NULL;
+	rec->ipath_key.data = NULL;
+	rec->ext_key.data = NULL;
+
+	if(has_sort_key(SK_BY_EXTENSION))
 	{
-		if(isdigit(*s) && isdigit(*t))
+		rec->ext = strrchr(entry->name, '.');
+		if(rec->ext != NULL)
 		{
-			int num_a, num_b;
-			const char *os = s, *ot = t;
-			char *p;
+			++rec->ext;
+		}
+	}
 
-			num_a = strtol(s, &p, 10);
-			s = p;
+	if(has_sort_key(SK_BY_SIZE) && rec->is_dir)
+	{
+		char full_path[PATH_MAX];
+		get_full_path_of(entry, sizeof(full_path), full_path);
+		dcache_get_size(full_path, &entry->size);
+	}
 
-			num_b = strtol(t, &p, 10);
-			t = p;
+#ifndef _WIN32
+	if(has_sort_key(SK_BY_PERMISSIONS))
+	{
+		get_perm_string(rec->perms, sizeof(rec->perms), entry->mode);
+	}
+#endif
 
-			if(num_a != num_b)
-				return num_a - num_b;
-			else if(*os != *ot)
-				return *os - *ot;
+	if(custom_view && (has_sort_key(SK_BY_NAME) || has_sort_key(SK_BY_INAME)))
+	{
+		char short_path[PATH_MAX];
+		get_short_path_of(view, entry, 1, sizeof(short_path), short_path);
+		rec->short_path = strdup(short_path);
+		if(rec->short_path == NULL)
+		{
+			return 1;
+		}
+		rec->name = rec->short_path;
+	}
+
+	if(cfg.sort_numbers)
+	{
+		return fill_natural_keys(rec);
+	}
+
+	if(has_sort_key(SK_BY_INAME))
+	{
+		rec->iname = strdup(rec->name);
+		if(rec->iname == NULL)
+		{
+			return 1;
+		}
+		str_to_lower(rec->iname);
+	}
+
+	return 0;
+}
+
+/* Fills natural sorting keys of the record.  Keys of file names are cached in
+ * entries, so that they are computed only once per file name.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+fill_natural_keys(sort_rec_t *rec)
+{
+	dir_entry_t *const entry = rec->entry;
+
+	if(has_sort_key(SK_BY_EXTENSION))
+	{
+		if(rec->ext != NULL)
+		{
+			if(make_natural_key(rec->ext, &rec->ext_key) != 0)
+			{
+				return 1;
+			}
+		}
+		else if((rec->fname_key = get_cached_key(&entry->name_key, entry->name,
+						0)) == NULL)
+		{
+			return 1;
+		}
+	}
+
+	if(has_sort_key(SK_BY_NAME))
+	{
+		if(rec->short_path != NULL)
+		{
+			if(make_natural_key(rec->short_path, &rec->path_key) != 0)
+			{
+				return 1;
+			}
+			rec->name_key = &rec->path_key;
+		}
+		else if((rec->name_key = get_cached_key(&entry->name_key, entry->name,
+						0)) == NULL)
+		{
+			return 1;
+		}
+	}
+
+	if(has_sort_key(SK_BY_INAME))
+	{
+		if(rec->short_path != NULL)
+		{
+			char *const lower = strdup(rec->short_path);
+			int failed;
+			if(lower == NULL)
+			{
+				return 1;
+			}
+			str_to_lower(lower);
+			failed = make_natural_key(lower, &rec->ipath_key);
+			free(lower);
+			if(failed)
+			{
+				return 1;
+			}
+			rec->iname_key = &rec->ipath_key;
 		}
-		else if(*s == *t)
+		else if((rec->iname_key = get_cached_key(&entry->iname_key, entry->name,
+						1)) == NULL)
 		{
-			s++;
-			t++;
+			return 1;
 		}
-		else
-			break;
 	}
 
-	return *s - *t;
+	return 0;
 }
-#else
-/* Skips all zeros in front of numbers (correctly handles zero).  Returns str, a
- * pointer to '0' or a pointer to non-zero digit. */
-static char *
-skip_leading_zeros(const char str[])
+
+/* Retrieves natural sorting key of the name computing it if necessary.
+ * Returns the key or NULL on failure. */
+static const sort_key_t *
+get_cached_key(sort_key_t *key, const char name[], int ignore_case)
 {
-	while(str[0] == '0' && isdigit(str[1]))
+	char *lower;
+	int failed;
+
+	if(key->data != NULL)
 	{
-		str++;
+		return key;
 	}
-	return (char *)str;
+
+	if(!ignore_case)
+	{
+		return (make_natural_key(name, key) == 0) ? key : NULL;
+	}
+
+	lower = strdup(name);
+	if(lower == NULL)
+	{
+		return NULL;
+	}
+	str_to_lower(lower);
+	failed = make_natural_key(lower, key);
+	free(lower);
+	return failed ? NULL : key;
+}
+
+/* Frees resources allocated for array of sort records. */
+static void
+free_sort_recs(sort_rec_t recs[], int count)
+{
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		free(recs[i].short_path);
+		free(recs[i].iname);
+		free(recs[i].path_key.data);
+		free(recs[i].ipath_key.data);
+		free(recs[i].ext_key.data);
+	}
+	free(recs);
 }
-#endif
 
+/* qsort() comparer that compares sort records by all collected keys.  Returns
+ * standard -1, 0, 1 for comparisons. */
 static int
-sort_dir_list(const void *one, const void *two)
+sort_recs(const void *one, const void *two)
 {
-	int retval;
-	char *pfirst, *psecond;
-	dir_entry_t *const first = (dir_entry_t *)one;
-	dir_entry_t *const second = (dir_entry_t *)two;
-	int first_is_dir;
-	int second_is_dir;
-
-	if(is_parent_dir(first->name))
+	const sort_rec_t *const first = one;
+	const sort_rec_t *const second = two;
+	int i;
+
+	if(first->is_parent)
 	{
 		return -1;
 	}
-	else if(is_parent_dir(second->name))
+	else if(second->is_parent)
 	{
 		return 1;
 	}
 
-	first_is_dir = is_directory_entry(first);
-	second_is_dir = is_directory_entry(second);
+	for(i = 0; i < nsort_keys; ++i)
+	{
+		const char key = sort_keys[i];
+		const int retval = compare_by_key(first, second, abs(key));
+		if(retval != 0)
+		{
+			return (key < 0) ? -retval : retval;
+		}
+	}
+
+	return first->index - second->index;
+}
+
+/* Compares two sort records by a single key in ascending order.  Returns
+ * positive value if first is greater than second, zero if they are equal,
+ * otherwise negative value is returned. */
+static int
+compare_by_key(const sort_rec_t *first, const sort_rec_t *second,
+		int sort_type)
+{
+	const dir_entry_t *const a = first->entry;
+	const dir_entry_t *const b = second->entry;
 
-	retval = 0;
 	switch(sort_type)
 	{
 		case SK_BY_NAME:
+			return compare_full_file_names(first->name, first->name_key,
+					second->name, second->name_key);
 		case SK_BY_INAME:
-			if(custom_view)
-			{
-				retval = compare_entry_names(first, second, sort_type == SK_BY_INAME);
-			}
-			else
-			{
-				retval = compare_full_file_names(first->name, second->name,
-						sort_type == SK_BY_INAME);
-			}
-			break;
+			/* Lower case name isn't built when natural sorting keys are used. */
+			return compare_full_file_names(
+					(first->iname == NULL) ? first->name : first->iname,
+					first->iname_key,
+					(second->iname == NULL) ? second->name : second->iname,
+					second->iname_key);
 
 		case SK_BY_TYPE:
-			if(first_is_dir != second_is_dir)
+			if(first->is_dir != second->is_dir)
 			{
-				retval = first_is_dir ? -1 : 1;
+				return first->is_dir ? -1 : 1;
 			}
-			break;
+			return 0;
 
 		case SK_BY_EXTENSION:
-			pfirst = strrchr(first->name,  '.');
-			psecond = strrchr(second->name, '.');
-
-			if(pfirst && psecond)
-				retval = compare_file_names(++pfirst, ++psecond, 0);
-			else if(pfirst || psecond)
-				retval = pfirst ? -1 : 1;
-			else
-				retval = compare_file_names(first->name, second->name, 0);
-			break;
-
-		case SK_BY_SIZE:
+			if(first->ext != NULL && second->ext != NULL)
 			{
-				if(first_is_dir)
-				{
-					char full_path[PATH_MAX];
-					get_full_path_of(first, sizeof(full_path), full_path);
-					tree_get_data(curr_stats.dirsize_cache, full_path, &first->size);
-				}
-
-				if(second_is_dir)
-				{
-					char full_path[PATH_MAX];
-					get_full_path_of(second, sizeof(full_path), full_path);
-					tree_get_data(curr_stats.dirsize_cache, full_path, &second->size);
-				}
-
-				retval = (first->size < second->size)
-				       ? -1
-				       : (first->size > second->size);
+				return compare_file_names(first->ext, &first->ext_key, second->ext,
+						&second->ext_key);
 			}
-			break;
+			else if(first->ext != NULL || second->ext != NULL)
+			{
+				return (first->ext != NULL) ? -1 : 1;
+			}
+			return compare_file_names(a->name, first->fname_key, b->name,
+					second->fname_key);
 
-		case SK_BY_TIME_MODIFIED:
-			retval = first->mtime - second->mtime;
-			break;
+		case SK_BY_SIZE:
+			return (a->size < b->size) ? -1 : (a->size > b->size);
 
+		case SK_BY_TIME_MODIFIED:
+			return (a->mtime < b->mtime) ? -1 : (a->mtime > b->mtime);
 		case SK_BY_TIME_ACCESSED:
-			retval = first->atime - second->atime;
-			break;
-
+			return (a->atime < b->atime) ? -1 : (a->atime > b->atime);
 		case SK_BY_TIME_CHANGED:
-			retval = first->ctime - second->ctime;
-			break;
+			return (a->ctime < b->ctime) ? -1 : (a->ctime > b->ctime);
 #ifndef _WIN32
 		case SK_BY_MODE:
-			retval = first->mode - second->mode;
-			break;
+			return (int)a->mode - (int)b->mode;
 
 		case SK_BY_OWNER_NAME: /* FIXME */
 		case SK_BY_OWNER_ID:
-			retval = first->uid - second->uid;
-			break;
+			return (a->uid < b->uid) ? -1 : (a->uid > b->uid);
 
 		case SK_BY_GROUP_NAME: /* FIXME */
 		case SK_BY_GROUP_ID:
-			retval = first->gid - second->gid;
-			break;
+			return (a->gid < b->gid) ? -1 : (a->gid > b->gid);
 
 		case SK_BY_PERMISSIONS:
-			{
-				char first_perm[11], second_perm[11];
-				get_perm_string(first_perm, sizeof(first_perm), first->mode);
-				get_perm_string(second_perm, sizeof(second_perm), second->mode);
-				retval = strcmp(first_perm, second_perm);
-			}
-			break;
+			return strcmp(first->perms, second->perms);
 #endif
 
 		default:
 			assert(0 && "All possible sort options should be handled");
-			break;
+			return 0;
 	}
+}
 
-	if(retval == 0)
-	{
-		retval = first->list_num - second->list_num;
-	}
-	else if(sort_descending)
+/* Compares file names containing numbers correctly. */
+TSTATIC int
+strnumcmp(const char s[], const char t[])
+{
+	sort_key_t s_key = { .data = NULL }, t_key = { .data = NULL };
+	int result;
+
+	if(make_natural_key(s, &s_key) != 0 || make_natural_key(t, &t_key) != 0)
 	{
-		retval = -retval;
+		free(s_key.data);
+		return strcmp(s, t);
 	}
 
-	return retval;
+	result = compare_keys(&s_key, &t_key);
+	free(s_key.data);
+	free(t_key.data);
+	return result;
 }
 
-/* Compares names of two file entries.  Returns positive value if a is greater
- * than b, zero if they are equal, otherwise negative value is returned. */
-static int
-compare_entry_names(const dir_entry_t *a, const dir_entry_t *b, int ignore_case)
+/* Builds natural sorting key for the str, so that comparing such keys with
+ * compare_keys() orders strings with numbers in them as one would expect.
+ * Each run of digits is replaced with '0', two bytes of length of the number
+ * without leading zeros, its digits and a byte that makes numbers with more
+ * leading zeros go first.  Using '0' makes numbers compare with other
+ * characters as digits do.  Returns zero on success, otherwise non-zero is
+ * returned. */
+TSTATIC int
+make_natural_key(const char str[], sort_key_t *key)
 {
-	char a_short_path[PATH_MAX];
-	char b_short_path[PATH_MAX];
+	/* The worst case is a single digit, which turns into five bytes. */
+	char *const data = malloc(strlen(str)*5U + 1U);
+	char *p = data;
 
-	get_short_path_of(view, a, 1, sizeof(a_short_path), a_short_path);
-	get_short_path_of(view, b, 1, sizeof(b_short_path), b_short_path);
+	if(data == NULL)
+	{
+		return 1;
+	}
+
+	while(*str != '\0')
+	{
+		const char *digits;
+		size_t zeros, len;
 
-	return compare_full_file_names(a_short_path, b_short_path, ignore_case);
+		if(!isdigit((unsigned char)*str))
+		{
+			*p++ = *str++;
+			continue;
+		}
+
+		zeros = 0U;
+		while(*str == '0')
+		{
+			++zeros;
+			++str;
+		}
+
+		digits = str;
+		while(isdigit((unsigned char)*str))
+		{
+			++str;
+		}
+		len = str - digits;
+
+		*p++ = '0';
+		*p++ = (char)((len >> 8) & 0xff);
+		*p++ = (char)(len & 0xff);
+		memcpy(p, digits, len);
+		p += len;
+		/* Zero itself has no leading zeros, so all its spellings are equal. */
+		*p++ = (char)(0xff - ((len == 0U) ? 0U : MIN(zeros, 0xfeU)));
+	}
+
+	key->len = p - data;
+	key->data = data;
+	return 0;
 }
 
 /* Compares two full filenames and assumes that dot character is smaller than
- * any other character.  Returns positive value if s is greater than t, zero if
- * they are equal, otherwise negative value is returned. */
+ * any other character.  Keys are used instead of strings when natural sorting
+ * is enabled.  Returns positive value if s is greater than t, zero if they are
+ * equal, otherwise negative value is returned. */
 static int
-compare_full_file_names(const char s[], const char t[], int ignore_case)
+compare_full_file_names(const char s[], const sort_key_t *s_key,
+		const char t[], const sort_key_t *t_key)
 {
 	if(s[0] == '.' && t[0] != '.')
 	{
@@ -324,32 +573,28 @@ compare_full_file_names(const char s[], const char t[], int ignore_case)
 	}
 	else
 	{
-		return compare_file_names(s, t, ignore_case);
+		return compare_file_names(s, s_key, t, t_key);
 	}
 }
 
-/* Compares two file names or their parts (e.g. extensions).  Returns positive
- * value if s is greater than t, zero if they are equal, otherwise negative
- * value is returned. */
+/* Compares two file names or their parts (e.g. extensions).  Keys are used
+ * instead of strings when natural sorting is enabled.  Returns positive value
+ * if s is greater than t, zero if they are equal, otherwise negative value is
+ * returned. */
 static int
-compare_file_names(const char s[], const char t[], int ignore_case)
+compare_file_names(const char s[], const sort_key_t *s_key, const char t[],
+		const sort_key_t *t_key)
 {
-	char s_buf[NAME_MAX];
-	char t_buf[NAME_MAX];
-
-	if(ignore_case)
-	{
-		copy_str(s_buf, sizeof(s_buf), s);
-		s = s_buf;
-
-		copy_str(t_buf, sizeof(t_buf), t);
-		t = t_buf;
-
-		str_to_lower(s_buf);
-		str_to_lower(t_buf);
-	}
+	return cfg.sort_numbers ? compare_keys(s_key, t_key) : strcmp(s, t);
+}
 
-	return cfg.sort_numbers ? strnumcmp(s, t) : strcmp(s, t);
+/* Compares two natural sorting keys.  Returns positive value if a is greater
+ * than b, zero if they are equal, otherwise negative value is returned. */
+static int
+compare_keys(const sort_key_t *a, const sort_key_t *b)
+{
+	const int result = memcmp(a->data, b->data, MIN(a->len, b->len));
+	return (result != 0) ? result : (a->len - b->len);
 }
 
 int
@@ -29,6 +29,7 @@ int get_secondary_key(int primary_key);
 
 TSTATIC_DEFS(
 	int strnumcmp(const char s[], const char t[]);
+	int make_natural_key(const char str[], sort_key_t *key);
 )
 
 #endif /* VIFM__SORT_H__ */
@@ -26,9 +26,12 @@
 #undef MIN
 #endif
 
+#include <pthread.h>
+
 #include <assert.h> /* assert() */
 #include <limits.h> /* INT_MIN */
 #include <stddef.h> /* NULL */
+#include <stdlib.h> /* malloc() realpath() */
 #include <string.h>
 
 #include "cfg/config.h"
@@ -49,10 +52,25 @@
 #define SCREEN_ENVVAR "STY"
 #define TMUX_ENVVAR "TMUX"
 
+/* Maximum number of directories whose sizes are cached, least recently used
+ * ones are forgotten on overflow. */
+#define DCACHE_MAX_ENTRIES (256*1024)
+
+/* Value of directory size cache. */
+typedef struct
+{
+	uint64_t size; /* Size of the directory with all its content. */
+	time_t mtime;  /* Modification time of the directory at calculation time. */
+	ino_t inode;   /* Inode number of the directory at calculation time. */
+}
+dcache_entry_t;
+
 static void load_def_values(status_t *stats, config_t *config);
 static void determine_fuse_umount_cmd(status_t *stats);
 static void set_gtk_available(status_t *stats);
 static int reset_dircache(status_t *stats);
+static int dcache_resolve(const char path[], char buf[]);
+static dcache_entry_t * dcache_find(const char path[]);
 static void set_last_cmdline_command(const char cmd[]);
 
 status_t curr_stats;
@@ -61,6 +79,10 @@ static int pending_redraw;
 static int inside_screen;
 static int inside_tmux;
 
+/* Protects curr_stats.dirsize_cache, which is accessed from background
+ * threads. */
+static pthread_mutex_t dcache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 int
 init_status(config_t *config)
 {
@@ -185,9 +207,158 @@ reset_status(const config_t *config)
 static int
 reset_dircache(status_t *stats)
 {
+	int result;
+
+	pthread_mutex_lock(&dcache_mutex);
 	tree_free(stats->dirsize_cache);
-	stats->dirsize_cache = tree_create(0, 0);
-	return stats->dirsize_cache == NULL_TREE;
+	stats->dirsize_cache = tree_create(0, 1);
+	result = (stats->dirsize_cache == NULL_TREE);
+	if(!result)
+	{
+		tree_set_limit(stats->dirsize_cache, DCACHE_MAX_ENTRIES);
+		/* Paths are resolved by dcache_*() functions before taking the lock. */
+		tree_set_canonical(stats->dirsize_cache, 1);
+	}
+	pthread_mutex_unlock(&dcache_mutex);
+
+	return result;
+}
+
+void
+dcache_get_size(const char path[], uint64_t *size)
+{
+	char real_path[PATH_MAX];
+	const dcache_entry_t *entry;
+
+	if(dcache_resolve(path, real_path) != 0)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&dcache_mutex);
+	entry = dcache_find(real_path);
+	if(entry != NULL)
+	{
+		*size = entry->size;
+	}
+	pthread_mutex_unlock(&dcache_mutex);
+}
+
+int
+dcache_get_valid_size(const char path[], time_t mtime, ino_t inode,
+		uint64_t *size)
+{
+	char real_path[PATH_MAX];
+	const dcache_entry_t *entry;
+	int result = 1;
+
+	if(dcache_resolve(path, real_path) != 0)
+	{
+		return 1;
+	}
+
+	pthread_mutex_lock(&dcache_mutex);
+	entry = dcache_find(real_path);
+	if(entry != NULL && entry->mtime == mtime && entry->inode == inode)
+	{
+		*size = entry->size;
+		result = 0;
+	}
+	pthread_mutex_unlock(&dcache_mutex);
+
+	return result;
+}
+
+void
+dcache_set_size(const char path[], uint64_t size, time_t mtime, ino_t inode)
+{
+	char real_path[PATH_MAX];
+	dcache_entry_t *entry;
+
+	if(dcache_resolve(path, real_path) != 0)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&dcache_mutex);
+
+	entry = dcache_find(real_path);
+	if(entry == NULL && curr_stats.dirsize_cache != NULL_TREE)
+	{
+		union
+		{
+			tree_val_t l;
+			void *p;
+		}
+		u = {
+			.p = malloc(sizeof(*entry)),
+		};
+
+		if(u.p != NULL &&
+				tree_set_data(curr_stats.dirsize_cache, real_path, u.l) != 0)
+		{
+			free(u.p);
+			u.p = NULL;
+		}
+		entry = u.p;
+	}
+
+	if(entry != NULL)
+	{
+		entry->size = size;
+		entry->mtime = mtime;
+		entry->inode = inode;
+	}
+
+	pthread_mutex_unlock(&dcache_mutex);
+}
+
+void
+dcache_invalidate(const char path[])
+{
+	char real_path[PATH_MAX];
+
+	/* The path might not exist anymore, in which case it's used as is. */
+	if(dcache_resolve(path, real_path) != 0)
+	{
+		copy_str(real_path, sizeof(real_path), path);
+	}
+
+	pthread_mutex_lock(&dcache_mutex);
+	if(curr_stats.dirsize_cache != NULL_TREE)
+	{
+		tree_remove(curr_stats.dirsize_cache, real_path);
+	}
+	pthread_mutex_unlock(&dcache_mutex);
+}
+
+/* Resolves path into its canonical form in buf of PATH_MAX length.  This is
+ * done outside of dcache_mutex as it might take a while.  Returns non-zero on
+ * error. */
+static int
+dcache_resolve(const char path[], char buf[])
+{
+	return realpath(path, buf) != buf;
+}
+
+/* Looks up entry of directory size cache.  Must be called with dcache_mutex
+ * locked.  Returns the entry or NULL if there is none. */
+static dcache_entry_t *
+dcache_find(const char path[])
+{
+	union
+	{
+		tree_val_t l;
+		void *p;
+	}
+	u;
+
+	if(curr_stats.dirsize_cache == NULL_TREE ||
+			tree_get_data(curr_stats.dirsize_cache, path, &u.l) != 0)
+	{
+		return NULL;
+	}
+	return u.p;
 }
 
 void
@@ -20,7 +20,11 @@
 #ifndef VIFM__STATUS_H__
 #define VIFM__STATUS_H__
 
+#include <sys/types.h> /* ino_t */
+
+#include <stdint.h> /* uint64_t */
 #include <stdio.h> /* FILE */
+#include <time.h> /* time_t */
 
 #include "utils/tree.h"
 #include "utils/fs_limits.h"
@@ -105,7 +109,7 @@ typedef struct
 	/* Describes terminal state with regard to its dimensions. */
 	TermState term_state;
 
-	tree_t dirsize_cache; /* ga command results */
+	tree_t dirsize_cache; /* ga command results, use dcache_*() functions. */
 
 	int last_search_backward;
 
@@ -175,6 +179,26 @@ int init_status(struct config_t *config);
  * Returns non-zero on error. */
 int reset_status(const struct config_t *config);
 
+/* Queries cached size of a directory in a thread-safe way.  Leaves *size
+ * untouched if there is no cached value. */
+void dcache_get_size(const char path[], uint64_t *size);
+
+/* Queries cached size of a directory in a thread-safe way.  Cached value is
+ * considered valid only if modification time and inode number of the directory
+ * are the same as at the moment of its calculation.  Returns non-zero if there
+ * is no valid cached value, in which case *size is left untouched. */
+int dcache_get_valid_size(const char path[], time_t mtime, ino_t inode,
+		uint64_t *size);
+
+/* Caches size of a directory along with its modification time and inode number
+ * in a thread-safe way. */
+void dcache_set_size(const char path[], uint64_t size, time_t mtime,
+		ino_t inode);
+
+/* Forgets cached sizes of the directory and all directories under it in
+ * a thread-safe way. */
+void dcache_invalidate(const char path[]);
+
 /* Sets internal flag to schedule postponed redraw operation of the UI. */
 void schedule_redraw(void);
 
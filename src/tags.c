@@ -55,6 +55,7 @@ const char *tags[] = {
 	"vifm-'iec'",
 	"vifm-'ignorecase'",
 	"vifm-'incsearch'",
+	"vifm-'iothreads'",
 	"vifm-'is'",
 	"vifm-'laststatus'",
 	"vifm-'lines'",
@@ -66,6 +67,7 @@ const char *tags[] = {
 	"vifm-'number'",
 	"vifm-'numberwidth'",
 	"vifm-'nuw'",
+	"vifm-'previewtimeout'",
 	"vifm-'relativenumber'",
 	"vifm-'rnu'",
 	"vifm-'ruf'",
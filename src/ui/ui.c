@@ -82,6 +82,7 @@ static void update_view(FileView *view);
 static void update_window_lazy(WINDOW *win);
 static void update_term_size(void);
 static void update_statusbar_layout(void);
+static void layout_statusbar(int ruler_width);
 static int get_ruler_width(FileView *view);
 static char * expand_ruler_macros(FileView *view, const char format[]);
 static void switch_panes_content(void);
@@ -106,7 +107,16 @@ ui_ruler_update(FileView *view)
 void
 ui_ruler_set(const char val[])
 {
-	const int x = getmaxx(ruler_win) - strlen(val);
+	const int len = strlen(val);
+	int x;
+
+	/* Ruler is sized for file list, values of other modes might be longer. */
+	if(len > getmaxx(ruler_win))
+	{
+		layout_statusbar(len);
+	}
+
+	x = getmaxx(ruler_win) - len;
 
 	werase(ruler_win);
 	mvwaddstr(ruler_win, 0, MAX(x, 0), val);
@@ -939,14 +949,18 @@ update_term_size(void)
 static void
 update_statusbar_layout(void)
 {
-	int screen_x, screen_y;
+	layout_statusbar(get_ruler_width(curr_view));
+}
 
-	int ruler_width;
+/* Places windows of status bar giving the ruler specified width. */
+static void
+layout_statusbar(int ruler_width)
+{
+	int screen_x, screen_y;
 	int fields_pos;
 
 	getmaxyx(stdscr, screen_y, screen_x);
 
-	ruler_width = get_ruler_width(curr_view);
 	fields_pos = screen_x - (INPUT_WIN_WIDTH + ruler_width);
 
 	wresize(status_bar, 1, fields_pos);
@@ -1256,6 +1270,10 @@ ui_view_title_update(FileView *view)
 		title = format_str("[%s] @ %s", view->custom.title,
 				replace_home_part(view->custom.orig_dir));
 	}
+	else if(view->list_incomplete)
+	{
+		title = format_str("%s (incomplete)", replace_home_part(view->curr_dir));
+	}
 	else
 	{
 		title = strdup(replace_home_part(view->curr_dir));
@@ -1417,6 +1435,7 @@ ui_view_erase(FileView *view)
 	const int bg = COLOR_PAIR(cs->pair[WIN_COLOR]) | cs->color[WIN_COLOR].attr;
 	wbkgdset(view->win, bg);
 	werase(view->win);
+	view->drawn_top = -1;
 }
 
 void
@@ -1442,6 +1461,7 @@ ui_view_clear(FileView *view)
 	}
 	redrawwin(view->win);
 	wrefresh(view->win);
+	view->drawn_top = -1;
 }
 
 void
@@ -34,6 +34,7 @@
 #include "../utils/filemon.h"
 #include "../utils/filter.h"
 #include "../utils/fs_limits.h"
+#include "../utils/string_map.h"
 #include "../color_scheme.h"
 #include "../column_view.h"
 #include "../status.h"
@@ -127,6 +128,15 @@ typedef struct
 }
 history_t;
 
+/* Collation key for natural sorting, such keys can be compared with memcmp().
+ * Key that wasn't computed yet has data field set to NULL. */
+typedef struct
+{
+	char *data; /* Bytes of the key. */
+	int len;    /* Number of bytes in data. */
+}
+sort_key_t;
+
 typedef struct
 {
 	char *name;
@@ -149,11 +159,22 @@ typedef struct
 
 	int search_match;
 
-	int list_num;     /* Used by sorting comparer to perform stable sort. */
-
 	int marked;       /* Whether file should be processed. */
 
 	int hi_num;       /* File highlighting parameters cache (initially -1). */
+
+	/* Whether target of symbolic link is missing.  Determined on loading, so
+	 * that drawing doesn't need to query file system. */
+	int broken_link;
+
+	/* Width of the name on the screen (in character positions), computed on
+	 * setting the name so that ls-like view doesn't need to measure names. */
+	size_t name_width;
+
+	/* Natural sorting keys of the name and of its lower case version, which are
+	 * computed on demand and dropped when name changes. */
+	sort_key_t name_key;
+	sort_key_t iname_key;
 }
 dir_entry_t;
 
@@ -172,6 +193,11 @@ typedef struct
 		dir_entry_t *entries;
 		/* Number of file entries. */
 		int entry_count;
+		/* Number of entries for which memory is allocated. */
+		int capacity;
+		/* Set of canonical paths of added entries while the list is being built,
+		 * NULL otherwise. */
+		string_map_t *paths;
 
 		/* Directory we were in before custom view activation. */
 		char *orig_dir;
@@ -183,11 +209,18 @@ typedef struct
 #ifndef _WIN32
 	/* Monitor that checks for directory changes. */
 	filemon_t mon;
+	/* Watcher that reports changed entries of the directory, can be NULL. */
+	filemon_watch_t *dir_watcher;
+	/* Directory for which dir_watcher was created. */
+	char watched_dir[PATH_MAX];
 #else
 	FILETIME dir_mtime;
 	HANDLE dir_watcher;
 	char watched_dir[PATH_MAX];
 #endif
+	/* Whether loading of the list was interrupted by the user, such list isn't
+	 * updated automatically until it's reloaded explicitly. */
+	int list_incomplete;
 	char last_dir[PATH_MAX];
 
 	int matches;
@@ -197,6 +230,7 @@ typedef struct
 	int invert; /* whether to invert the filename pattern */
 	int curr_line; /* current line # of the window  */
 	int top_line; /* # of the list position that is the top line in window */
+	int drawn_top; /* top_line as of the last drawing of the list or -1 */
 	int list_pos; /* actual position in the file list */
 	int list_rows; /* size of the file list */
 	int window_rows; /* number of rows shown in window */
@@ -246,6 +280,11 @@ typedef struct
 		size_t unfiltered_count;
 		/* Number of entries filtered in other ways. */
 		size_t prefiltered_count;
+		/* Indexes of entries of the unfiltered array that match the filter (in
+		 * ascending order, parent directory entries are always included). */
+		int *matches;
+		/* Number of elements in the matches field. */
+		size_t matches_count;
 
 		/* List of previous cursor positions in the unfiltered array. */
 		int *poshist;
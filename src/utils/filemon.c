@@ -18,11 +18,42 @@
 
 #include "filemon.h"
 
+#ifdef __linux__
+#include <sys/inotify.h> /* IN_* inotify_event inotify_add_watch()
+                            inotify_init1() */
+#endif
 #include <sys/stat.h> /* stat */
+#include <unistd.h> /* close() read() */
 
-#include <string.h> /* memcmp() memcpy() */
+#include <stddef.h> /* NULL */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memcmp() memcpy() strdup() */
 
 #include "../compat/os.h"
+#include "string_map.h"
+
+struct filemon_watch_t
+{
+	int fd; /* File descriptor of inotify instance. */
+};
+
+#ifdef __linux__
+
+/* List of changes that is being collected. */
+typedef struct
+{
+	filemon_change_t *items; /* Changes of entries. */
+	int count;               /* Number of elements in items. */
+	int capacity;            /* Number of allocated elements of items. */
+	string_map_t *index;     /* Maps names to positions in items plus one. */
+	int rescan;              /* Whether whole directory needs to be rechecked. */
+}
+change_list_t;
+
+static void add_change(change_list_t *list, FilemonChange kind, int existed,
+		const char name[]);
+static FilemonChange merge_changes(FilemonChange old, FilemonChange new);
+#endif
 
 int
 filemon_from_file(const char path[], filemon_t *timestamp)
@@ -57,5 +88,237 @@ filemon_assign(filemon_t *lhs, const filemon_t *rhs)
 	memcpy(lhs, rhs, sizeof(*rhs));
 }
 
+filemon_watch_t *
+filemon_watch(const char path[])
+{
+#ifdef __linux__
+	const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+	                    | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF
+	                    | IN_MOVE_SELF | IN_ONLYDIR;
+
+	filemon_watch_t *const watch = malloc(sizeof(*watch));
+	if(watch == NULL)
+	{
+		return NULL;
+	}
+
+	watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(watch->fd == -1)
+	{
+		free(watch);
+		return NULL;
+	}
+
+	if(inotify_add_watch(watch->fd, path, mask) == -1)
+	{
+		close(watch->fd);
+		free(watch);
+		return NULL;
+	}
+
+	return watch;
+#else
+	return NULL;
+#endif
+}
+
+void
+filemon_unwatch(filemon_watch_t *watch)
+{
+	if(watch != NULL)
+	{
+		close(watch->fd);
+		free(watch);
+	}
+}
+
+int
+filemon_watch_fd(const filemon_watch_t *watch)
+{
+	return watch->fd;
+}
+
+int
+filemon_read_changes(filemon_watch_t *watch, filemon_change_t **changes)
+{
+	*changes = NULL;
+
+#ifdef __linux__
+	/* Having at least one element allocated upfront guarantees that FMC_RESCAN
+	 * can be reported in case of a memory error. */
+	change_list_t list = {
+		.items = malloc(sizeof(*list.items)),
+		.capacity = 1,
+		.index = string_map_create(),
+	};
+
+	if(list.items == NULL || list.index == NULL)
+	{
+		/* Leave events queued until there is enough memory to process them. */
+		free(list.items);
+		string_map_free(list.index, NULL);
+		return 0;
+	}
+
+	for(;;)
+	{
+		char buf[64*1024]
+			__attribute__((aligned(__alignof__(struct inotify_event))));
+		const ssize_t len = read(watch->fd, buf, sizeof(buf));
+		const char *p;
+
+		if(len <= 0)
+		{
+			/* EAGAIN means there is nothing left to read, other errors can't be
+			 * handled in a better way than by just reporting what we have. */
+			break;
+		}
+
+		for(p = buf; p < buf + len; )
+		{
+			const struct inotify_event *const e = (const struct inotify_event *)p;
+			p += sizeof(*e) + e->len;
+
+			if(e->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF |
+						IN_UNMOUNT | IN_IGNORED))
+			{
+				list.rescan = 1;
+			}
+			else if(e->len == 0)
+			{
+				/* Change of the directory itself (e.g., of its permissions). */
+				continue;
+			}
+			else if(e->mask & IN_CREATE)
+			{
+				add_change(&list, FMC_CREATED, 0, e->name);
+			}
+			else if(e->mask & IN_MOVED_TO)
+			{
+				add_change(&list, FMC_CREATED, -1, e->name);
+			}
+			else if(e->mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				add_change(&list, FMC_DELETED, 1, e->name);
+			}
+			else
+			{
+				add_change(&list, FMC_MODIFIED, 1, e->name);
+			}
+		}
+	}
+
+	string_map_free(list.index, NULL);
+
+	/* Rechecking the directory covers all other changes. */
+	if(list.rescan)
+	{
+		int i;
+		for(i = 0; i < list.count; ++i)
+		{
+			free(list.items[i].name);
+		}
+
+		list.items[0].kind = FMC_RESCAN;
+		list.items[0].name = NULL;
+		list.items[0].existed = -1;
+		list.count = 1;
+	}
+
+	if(list.count == 0)
+	{
+		free(list.items);
+		list.items = NULL;
+	}
+
+	*changes = list.items;
+	return list.count;
+#else
+	return 0;
+#endif
+}
+
+void
+filemon_free_changes(filemon_change_t changes[], int count)
+{
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		free(changes[i].name);
+	}
+	free(changes);
+}
+
+#ifdef __linux__
+
+/* Records change, merging it with previous change of the same entry.  The
+ * existed parameter tells whether entry existed before this change and is used
+ * only for the first change of the entry.  Memory errors turn into request to
+ * recheck the directory. */
+static void
+add_change(change_list_t *list, FilemonChange kind, int existed,
+		const char name[])
+{
+	const size_t pos = (size_t)string_map_get(list->index, name);
+	filemon_change_t *change;
+
+	if(list->rescan)
+	{
+		return;
+	}
+
+	if(pos != 0U)
+	{
+		change = &list->items[pos - 1U];
+		change->kind = merge_changes(change->kind, kind);
+		return;
+	}
+
+	if(list->count == list->capacity)
+	{
+		const int capacity = list->capacity*2;
+		filemon_change_t *const items =
+			realloc(list->items, sizeof(*items)*capacity);
+		if(items == NULL)
+		{
+			list->rescan = 1;
+			return;
+		}
+		list->items = items;
+		list->capacity = capacity;
+	}
+
+	change = &list->items[list->count];
+	change->kind = kind;
+	change->existed = existed;
+	change->name = strdup(name);
+	if(change->name == NULL ||
+			string_map_set(list->index, change->name,
+				(void *)(size_t)(list->count + 1)) != 0)
+	{
+		free(change->name);
+		list->rescan = 1;
+		return;
+	}
+
+	++list->count;
+}
+
+/* Combines two consecutive changes of the same entry into one.  Returns the
+ * combined change. */
+static FilemonChange
+merge_changes(FilemonChange old, FilemonChange new)
+{
+	/* Last creation or deletion defines whether entry exists, while creation
+	 * followed by modification is still creation. */
+	if(new == FMC_MODIFIED && old != FMC_DELETED)
+	{
+		return old;
+	}
+	return new;
+}
+
+#endif
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
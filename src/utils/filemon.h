@@ -23,7 +23,8 @@
 
 #include <time.h> /* time_t timespec */
 
-/* Various time stamp service functions. */
+/* Various time stamp service functions and watching for changes of
+ * directories. */
 
 /* Storage for file monitoring information. */
 typedef struct
@@ -49,6 +50,50 @@ int filemon_equal(const filemon_t *a, const filemon_t *b);
 /* Assigns value of the *rhs to *lhs. */
 void filemon_assign(filemon_t *lhs, const filemon_t *rhs);
 
+/* Kind of change of an entry of watched directory. */
+typedef enum
+{
+	FMC_CREATED,  /* Entry was created or moved into the directory. */
+	FMC_DELETED,  /* Entry was deleted or moved out of the directory. */
+	FMC_MODIFIED, /* Entry was written to or its meta-data changed. */
+	FMC_RESCAN,   /* Changes were lost or directory itself was deleted or moved,
+	                 its contents should be rechecked. */
+}
+FilemonChange;
+
+/* Single change of watched directory. */
+typedef struct
+{
+	FilemonChange kind; /* What has happened. */
+	char *name;         /* Name of the entry, NULL for FMC_RESCAN. */
+	int existed;        /* Whether entry existed before the first change: 1 if
+	                       it did, 0 if it didn't and -1 if it's unknown (entry
+	                       was moved in possibly replacing an existing one). */
+}
+filemon_change_t;
+
+/* Watcher of changes in a directory, which doesn't need to poll. */
+typedef struct filemon_watch_t filemon_watch_t;
+
+/* Starts watching entries of the directory.  Returns the watcher or NULL if
+ * watching is not supported on this system or failed. */
+filemon_watch_t * filemon_watch(const char path[]);
+
+/* Stops watching and frees the watcher.  Freeing NULL watcher is OK. */
+void filemon_unwatch(filemon_watch_t *watch);
+
+/* Retrieves file descriptor that becomes readable when there are changes to be
+ * fetched.  Returns the descriptor. */
+int filemon_watch_fd(const filemon_watch_t *watch);
+
+/* Fetches changes accumulated since the last call without blocking.  Several
+ * changes of the same entry are merged into one.  Returns number of elements
+ * in *changes, which should be freed with filemon_free_changes(). */
+int filemon_read_changes(filemon_watch_t *watch, filemon_change_t **changes);
+
+/* Frees list of changes returned by filemon_read_changes(). */
+void filemon_free_changes(filemon_change_t changes[], int count);
+
 #endif /* VIFM__UTILS__FILEMON_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
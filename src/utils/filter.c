@@ -25,17 +25,26 @@
 #include <regex.h> /* REG_EXTENDED REG_ICASE regex_t regfree() */
 
 #include <assert.h> /* assert */
-#include <stddef.h> /* NULL */
+#include <stddef.h> /* NULL size_t wchar_t */
 #include <stdlib.h> /* free() malloc() */
 #include <string.h> /* strdup() strlen() */
 
 #include "str.h"
+#include "string_map.h"
+
+/* Characters of names that are escaped in regular expression. */
+static const char NEED_ESCAPING[] = "\\[](){}+*^$.?|";
 
 static int append_to_filter(filter_t *filter, const char value[]);
 static void reset_regex(filter_t *filter, const char value[]);
 static void free_regex(filter_t *filter);
 static void compile_regex(filter_t *filter, const char value[]);
 static char * escape_name_for_filter(const char string[]);
+static int parse_names(filter_t *filter, const char value[]);
+static int add_name(filter_t *filter, const char name[]);
+static int has_name(const filter_t *filter, const char name[]);
+static char * fold_case(const char name[]);
+static void free_names(filter_t *filter);
 
 int
 filter_init(filter_t *filter, int case_sensitive)
@@ -46,6 +55,8 @@ filter_init(filter_t *filter, int case_sensitive)
 		return 1;
 	}
 
+	filter->raw_len = 0U;
+	filter->names = NULL;
 	filter->is_regex_valid = 0;
 
 	filter->cflags = REG_EXTENDED;
@@ -63,8 +74,10 @@ filter_dispose(filter_t *filter)
 {
 	free(filter->raw);
 	filter->raw = NULL;
+	filter->raw_len = 0U;
 
 	free_regex(filter);
+	free_names(filter);
 }
 
 int
@@ -77,7 +90,9 @@ void
 filter_clear(filter_t *filter)
 {
 	filter->raw[0] = '\0';
+	filter->raw_len = 0U;
 	free_regex(filter);
+	free_names(filter);
 }
 
 int
@@ -90,8 +105,18 @@ filter_set(filter_t *filter, const char value[])
 	}
 	else if(replace_string(&filter->raw, value) == 0)
 	{
+		filter->raw_len = strlen(value);
+
+		/* Result of filter_append() calls, e.g., restored from vifminfo. */
+		free_names(filter);
+		if(parse_names(filter, value) == 0)
+		{
+			free_regex(filter);
+			return 0;
+		}
+
 		reset_regex(filter, value);
-		return (filter->is_regex_valid || filter->raw[0] == '\0') ? 0 : 1;
+		return filter->is_regex_valid ? 0 : 1;
 	}
 	else
 	{
@@ -151,9 +176,15 @@ filter_append(filter_t *filter, const char value[])
 static int
 append_to_filter(filter_t *filter, const char value[])
 {
-	size_t len = strlen(filter->raw);
+	size_t len = filter->raw_len;
 	char *const escaped_value = escape_name_for_filter(value);
 
+	if(escaped_value == NULL || add_name(filter, value) != 0)
+	{
+		free(escaped_value);
+		return 1;
+	}
+
 	if(len != 0)
 	{
 		filter->raw = extend_string(filter->raw, "|", &len);
@@ -165,10 +196,9 @@ append_to_filter(filter_t *filter, const char value[])
 	free(escaped_value);
 
 	filter->raw = extend_string(filter->raw, "$", &len);
+	filter->raw_len = len;
 
-	reset_regex(filter, filter->raw);
-
-	return (filter->is_regex_valid || filter->raw[0] == '\0') ? 0 : 1;
+	return 0;
 }
 
 /* Replaces possibly existing regular expression with the new one. */
@@ -206,13 +236,16 @@ compile_regex(filter_t *filter, const char value[])
 static char *
 escape_name_for_filter(const char string[])
 {
-	static const char *NEED_ESCAPING = "\\[](){}+*^$.?|";
 	size_t len;
 	char *ret, *dup;
 
 	len = strlen(string);
 
 	dup = ret = malloc(len*2 + 2 + 1);
+	if(ret == NULL)
+	{
+		return NULL;
+	}
 
 	while(*string != '\0')
 	{
@@ -226,16 +259,159 @@ escape_name_for_filter(const char string[])
 	return ret;
 }
 
+/* Fills set of names if value consists only of "^name$" alternatives produced
+ * by filter_append().  Returns zero if so, otherwise non-zero is returned and
+ * the set is left empty. */
+static int
+parse_names(filter_t *filter, const char value[])
+{
+	char *const name = malloc(strlen(value) + 1U);
+	if(name == NULL)
+	{
+		return 1;
+	}
+
+	while(*value == '^')
+	{
+		size_t len = 0U;
+
+		++value;
+		while(*value != '$')
+		{
+			if(*value == '\\' && value[1] != '\0' &&
+					char_is_one_of(NEED_ESCAPING, value[1]))
+			{
+				++value;
+			}
+			else if(*value == '\0' || char_is_one_of(NEED_ESCAPING, *value))
+			{
+				break;
+			}
+			name[len++] = *value++;
+		}
+		name[len] = '\0';
+
+		if(*value != '$' || len == 0U || add_name(filter, name) != 0)
+		{
+			break;
+		}
+		++value;
+
+		if(*value == '\0')
+		{
+			free(name);
+			return 0;
+		}
+		if(*value != '|')
+		{
+			break;
+		}
+		++value;
+	}
+
+	free(name);
+	free_names(filter);
+	return 1;
+}
+
+/* Adds name to the set of names of the filter.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+add_name(filter_t *filter, const char name[])
+{
+	int result;
+	char *folded = NULL;
+
+	if(filter->names == NULL)
+	{
+		filter->names = string_map_create();
+		if(filter->names == NULL)
+		{
+			return 1;
+		}
+	}
+
+	if(filter->cflags & REG_ICASE)
+	{
+		folded = fold_case(name);
+		if(folded == NULL)
+		{
+			return 1;
+		}
+		name = folded;
+	}
+
+	/* Value only needs to be non-NULL to mark presence of the key. */
+	result = string_map_set(filter->names, name, filter->names);
+	free(folded);
+	return result;
+}
+
+/* Checks whether name is in the set of names of the filter.  Returns non-zero
+ * if so, otherwise zero is returned. */
+static int
+has_name(const filter_t *filter, const char name[])
+{
+	int found;
+	char *folded;
+
+	if(filter->names == NULL)
+	{
+		return 0;
+	}
+
+	if(!(filter->cflags & REG_ICASE))
+	{
+		return string_map_get(filter->names, name) != NULL;
+	}
+
+	folded = fold_case(name);
+	found = (folded != NULL && string_map_get(filter->names, folded) != NULL);
+	free(folded);
+	return found;
+}
+
+/* Converts name to lower case.  Returns newly allocated string or NULL on
+ * error. */
+static char *
+fold_case(const char name[])
+{
+	char *folded;
+	wchar_t *const wide = to_wide(name);
+	if(wide == NULL)
+	{
+		return NULL;
+	}
+
+	wcstolower(wide);
+	folded = to_multibyte(wide);
+	free(wide);
+	return folded;
+}
+
+/* Empties set of names of the filter. */
+static void
+free_names(filter_t *filter)
+{
+	string_map_free(filter->names, NULL);
+	filter->names = NULL;
+}
+
 int
 filter_matches(filter_t *filter, const char pattern[])
 {
+	if(has_name(filter, pattern))
+	{
+		return 1;
+	}
+
 	if(filter->is_regex_valid)
 	{
 		return regexec(&filter->regex, pattern, 0, NULL, 0) == 0;
 	}
 	else
 	{
-		return -1;
+		return (filter->names != NULL) ? 0 : -1;
 	}
 }
 
@@ -23,12 +23,26 @@
 
 #include <regex.h> /* regex_t */
 
-/* Wrapper for a regular expression, its state and compiled form. */
+#include <stddef.h> /* size_t */
+
+#include "string_map.h"
+
+/* Wrapper for a regular expression, its state and compiled form.  Names that
+ * are matched exactly (see filter_append()) are kept in a set instead of being
+ * compiled into the regular expression. */
 typedef struct
 {
-	/* Raw regexp for filtering, not NULL after initialization. */
+	/* Raw regexp for filtering, not NULL after initialization.  Includes names
+	 * from the set in the form of "^name$" alternatives. */
 	char *raw;
 
+	/* Length of the raw string. */
+	size_t raw_len;
+
+	/* Set of names matched exactly (case folded for case insensitive filter) or
+	 * NULL. */
+	string_map_t *names;
+
 	/* Whether raw regexp was successfully compiled. */
 	int is_regex_valid;
 
@@ -68,7 +82,8 @@ int filter_assign(filter_t *filter, const filter_t *source);
 int filter_change(filter_t *filter, const char value[], int case_sensitive);
 
 /* Appends non-empty value to filter expression (using logical or and whole
- * pattern matching).  Returns zero on success, otherwise non-zero is
+ * pattern matching).  The regular expression isn't recompiled, the value is
+ * added to the set of names.  Returns zero on success, otherwise non-zero is
  * returned. */
 int filter_append(filter_t *filter, const char value[]);
 
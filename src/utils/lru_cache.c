@@ -0,0 +1,213 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "lru_cache.h"
+
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* free() malloc() */
+#include <string.h> /* memcpy() strlen() */
+
+#include "string_map.h"
+
+/* Single entry of the cache. */
+typedef struct node_t
+{
+	struct node_t *prev; /* More recently used entry. */
+	struct node_t *next; /* Less recently used entry. */
+	void *value;         /* Value of the entry. */
+	size_t size;         /* Size of the entry including the key. */
+	char *key;           /* Copy of the key, allocated with the node. */
+}
+node_t;
+
+struct lru_cache_t
+{
+	string_map_t *nodes; /* Maps keys to nodes. */
+	node_t *head;        /* The most recently used entry. */
+	node_t *tail;        /* The least recently used entry. */
+	size_t size;         /* Total size of all entries. */
+	size_t limit;        /* Maximum total size of entries. */
+};
+
+static void remove_node(lru_cache_t *cache, node_t *node);
+static void unlink_node(lru_cache_t *cache, node_t *node);
+static void link_node(lru_cache_t *cache, node_t *node);
+
+lru_cache_t *
+lru_cache_create(size_t limit)
+{
+	lru_cache_t *const cache = malloc(sizeof(*cache));
+	if(cache == NULL)
+	{
+		return NULL;
+	}
+
+	cache->nodes = string_map_create();
+	if(cache->nodes == NULL)
+	{
+		free(cache);
+		return NULL;
+	}
+
+	cache->head = NULL;
+	cache->tail = NULL;
+	cache->size = 0U;
+	cache->limit = limit;
+	return cache;
+}
+
+void
+lru_cache_free(lru_cache_t *cache)
+{
+	if(cache == NULL)
+	{
+		return;
+	}
+
+	while(cache->head != NULL)
+	{
+		remove_node(cache, cache->head);
+	}
+
+	string_map_free(cache->nodes, NULL);
+	free(cache);
+}
+
+int
+lru_cache_put(lru_cache_t *cache, const char key[], void *value, size_t size)
+{
+	const size_t len = strlen(key);
+	node_t *node = string_map_get(cache->nodes, key);
+
+	if(node != NULL)
+	{
+		remove_node(cache, node);
+	}
+
+	size += len + 1U;
+	if(size > cache->limit)
+	{
+		free(value);
+		return 1;
+	}
+
+	while(cache->size + size > cache->limit)
+	{
+		remove_node(cache, cache->tail);
+	}
+
+	node = malloc(sizeof(*node) + len + 1U);
+	if(node == NULL)
+	{
+		free(value);
+		return 1;
+	}
+
+	node->key = (char *)(node + 1);
+	memcpy(node->key, key, len + 1U);
+	node->value = value;
+	node->size = size;
+
+	if(string_map_set(cache->nodes, key, node) != 0)
+	{
+		free(node);
+		free(value);
+		return 1;
+	}
+
+	link_node(cache, node);
+	cache->size += size;
+	return 0;
+}
+
+void *
+lru_cache_get(lru_cache_t *cache, const char key[])
+{
+	node_t *const node = string_map_get(cache->nodes, key);
+	if(node == NULL)
+	{
+		return NULL;
+	}
+
+	if(node != cache->head)
+	{
+		unlink_node(cache, node);
+		link_node(cache, node);
+	}
+	return node->value;
+}
+
+size_t
+lru_cache_size(const lru_cache_t *cache)
+{
+	return cache->size;
+}
+
+/* Drops the node from the cache freeing its value. */
+static void
+remove_node(lru_cache_t *cache, node_t *node)
+{
+	(void)string_map_remove(cache->nodes, node->key);
+	unlink_node(cache, node);
+	cache->size -= node->size;
+	free(node->value);
+	free(node);
+}
+
+/* Excludes the node from the list of nodes. */
+static void
+unlink_node(lru_cache_t *cache, node_t *node)
+{
+	if(node->prev == NULL)
+	{
+		cache->head = node->next;
+	}
+	else
+	{
+		node->prev->next = node->next;
+	}
+
+	if(node->next == NULL)
+	{
+		cache->tail = node->prev;
+	}
+	else
+	{
+		node->next->prev = node->prev;
+	}
+}
+
+/* Puts the node at the beginning of the list of nodes. */
+static void
+link_node(lru_cache_t *cache, node_t *node)
+{
+	node->prev = NULL;
+	node->next = cache->head;
+	if(cache->head == NULL)
+	{
+		cache->tail = node;
+	}
+	else
+	{
+		cache->head->prev = node;
+	}
+	cache->head = node;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
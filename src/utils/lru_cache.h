@@ -0,0 +1,55 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__LRU_CACHE_H__
+#define VIFM__UTILS__LRU_CACHE_H__
+
+#include <stddef.h> /* size_t */
+
+/* Cache of values allocated with malloc() identified by strings.  Total size of
+ * keys and values is limited, least recently used entries are evicted to make
+ * room for new ones.  Not thread-safe. */
+
+/* Opaque declaration of the cache. */
+typedef struct lru_cache_t lru_cache_t;
+
+/* Creates an empty cache that holds at most limit bytes.  Returns the cache or
+ * NULL on error. */
+lru_cache_t * lru_cache_create(size_t limit);
+
+/* Frees the cache along with all values.  Freeing NULL cache is OK. */
+void lru_cache_free(lru_cache_t *cache);
+
+/* Stores the value of the specified size under the key replacing previous
+ * value if any.  The cache takes ownership of the value, which is freed
+ * immediately if it doesn't fit into the cache.  Returns zero on success,
+ * otherwise non-zero is returned. */
+int lru_cache_put(lru_cache_t *cache, const char key[], void *value,
+		size_t size);
+
+/* Looks up value of the key and marks it as the most recently used.  Returns
+ * the value, which is valid until next call of lru_cache_put(), or NULL. */
+void * lru_cache_get(lru_cache_t *cache, const char key[]);
+
+/* Retrieves total size of all entries.  Returns the size. */
+size_t lru_cache_size(const lru_cache_t *cache);
+
+#endif /* VIFM__UTILS__LRU_CACHE_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
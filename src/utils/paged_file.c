@@ -0,0 +1,718 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "paged_file.h"
+
+#ifndef _WIN32
+#include <sys/stat.h> /* fstat() stat() stat */
+#include <sys/types.h> /* dev_t ino_t ssize_t */
+#include <fcntl.h> /* FD_CLOEXEC F_SETFD O_RDONLY fcntl() open() */
+#include <unistd.h> /* close() pread() */
+#endif
+
+#include <errno.h> /* EINTR errno */
+#include <limits.h> /* INT_MAX */
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memchr() memcmp() memcpy() strdup() */
+
+#include "../ui/cancellation.h"
+#include "macros.h"
+#include "string_array.h"
+
+/* Offset of every LINE_STEP-th line is stored in the index. */
+#define LINE_STEP 1024
+
+/* Size of a piece of the file that's read at once. */
+#define CHUNK_SIZE (64*1024)
+
+/* Number of bytes at the beginning and at the end of the file that are
+ * remembered to tell appending to the file from rewriting it. */
+#define SAMPLE_SIZE 64
+
+struct paged_file_t
+{
+	char *path;  /* Path to the file for detecting its replacement. */
+	int fd;      /* Descriptor of the file. */
+	dev_t dev;   /* Device of the opened file. */
+	ino_t inode; /* Inode of the opened file. */
+	size_t size; /* Size of the file at the moment of the last check. */
+
+	/* File is read by chunks via pread() rather than mapped into memory, because
+	 * mapping of a file that's truncated by someone else raises SIGBUS on
+	 * access. */
+	char *chunk;         /* Buffer with piece of the file. */
+	size_t chunk_offset; /* Offset of the piece in the file. */
+	size_t chunk_len;    /* Number of bytes in the piece. */
+	int truncated;       /* Whether reading ended before the expected size. */
+
+	char *line;      /* Buffer for a line passed to match callbacks. */
+	size_t line_cap; /* Capacity of the line buffer. */
+
+	char head[SAMPLE_SIZE]; /* First bytes of the file. */
+	char tail[SAMPLE_SIZE]; /* Last bytes of the file. */
+	size_t sample_len;      /* Number of bytes in head and tail samples. */
+
+	size_t *offsets; /* Offsets of every LINE_STEP-th line. */
+	int noffsets;    /* Number of elements in offsets array. */
+	int nlines;      /* Number of indexed lines. */
+	size_t scanned;  /* Offset of the first line that's not indexed yet. */
+	int complete;    /* Whether all lines of the file are indexed. */
+	int has_tail;    /* Whether last indexed line doesn't end with newline. */
+
+	int cancellable; /* Whether indexing can be cancelled. */
+};
+
+static int open_file(paged_file_t *pf);
+static int update_file(paged_file_t *pf);
+static int stat_file(paged_file_t *pf);
+static int samples_match(paged_file_t *pf, size_t old_size);
+static void take_samples(paged_file_t *pf);
+static void check_truncation(paged_file_t *pf);
+static void reset_index(paged_file_t *pf);
+static void index_until(paged_file_t *pf, int line);
+static int record_line(paged_file_t *pf);
+static size_t line_start(paged_file_t *pf, int line);
+static size_t next_line(paged_file_t *pf, size_t offset);
+static size_t find_newline(paged_file_t *pf, size_t offset);
+static const char * load_line(paged_file_t *pf, size_t offset, size_t *len,
+		size_t *next);
+static int read_bytes(paged_file_t *pf, size_t offset, size_t len, char buf[]);
+static const char * get_chunk(paged_file_t *pf, size_t offset, size_t *len);
+
+paged_file_t *
+pf_open(const char path[])
+{
+#ifndef _WIN32
+	paged_file_t *const pf = malloc(sizeof(*pf));
+	if(pf == NULL)
+	{
+		return NULL;
+	}
+
+	pf->path = strdup(path);
+	pf->fd = -1;
+	pf->size = 0U;
+	pf->chunk = malloc(CHUNK_SIZE);
+	pf->chunk_offset = 0U;
+	pf->chunk_len = 0U;
+	pf->truncated = 0;
+	pf->line = NULL;
+	pf->line_cap = 0U;
+	pf->offsets = NULL;
+	pf->cancellable = 0;
+	reset_index(pf);
+
+	if(pf->path == NULL || pf->chunk == NULL || open_file(pf) != 0)
+	{
+		pf_close(pf);
+		return NULL;
+	}
+
+	return pf;
+#else
+	return NULL;
+#endif
+}
+
+void
+pf_close(paged_file_t *pf)
+{
+	if(pf == NULL)
+	{
+		return;
+	}
+
+#ifndef _WIN32
+	if(pf->fd != -1)
+	{
+		close(pf->fd);
+	}
+#endif
+
+	free(pf->path);
+	free(pf->chunk);
+	free(pf->line);
+	free(pf->offsets);
+	free(pf);
+}
+
+int
+pf_refresh(paged_file_t *pf)
+{
+#ifndef _WIN32
+	struct stat st;
+
+	/* Old file is kept if there is no new one (e.g., it's being rotated). */
+	if(stat(pf->path, &st) == 0 &&
+			(st.st_dev != pf->dev || st.st_ino != pf->inode))
+	{
+		reset_index(pf);
+		return open_file(pf);
+	}
+
+	return update_file(pf);
+#else
+	return 1;
+#endif
+}
+
+void
+pf_set_cancellable(paged_file_t *pf, int cancellable)
+{
+	pf->cancellable = cancellable;
+}
+
+int
+pf_count_lines(paged_file_t *pf)
+{
+	check_truncation(pf);
+	index_until(pf, INT_MAX);
+	return pf->nlines;
+}
+
+int
+pf_known_lines(const paged_file_t *pf, int *complete)
+{
+	*complete = pf->complete;
+	return pf->nlines;
+}
+
+int
+pf_has_line(paged_file_t *pf, int line)
+{
+	if(line < 0)
+	{
+		return 0;
+	}
+
+	check_truncation(pf);
+	index_until(pf, line);
+	return line < pf->nlines;
+}
+
+char **
+pf_read_lines(paged_file_t *pf, int first, int count, int *nread)
+{
+	size_t offset;
+	char **lines;
+
+	*nread = 0;
+
+	lines = malloc(sizeof(*lines)*(count > 0 ? count : 1));
+	if(lines == NULL || count <= 0 || first < 0)
+	{
+		return lines;
+	}
+
+	check_truncation(pf);
+
+	/* Index all lines that are being read at once. */
+	index_until(pf, (first > INT_MAX - count) ? INT_MAX : first + count - 1);
+	if(first >= pf->nlines)
+	{
+		return lines;
+	}
+
+	offset = line_start(pf, first);
+	while(*nread < count && offset < pf->size)
+	{
+		size_t len;
+		char *line;
+		const char *const text = load_line(pf, offset, &len, &offset);
+		if(text == NULL)
+		{
+			/* The file got shorter while it was being read. */
+			break;
+		}
+
+		line = malloc(len + 1U);
+		if(line == NULL)
+		{
+			free_string_array(lines, *nread);
+			*nread = 0;
+			return NULL;
+		}
+
+		memcpy(line, text, len + 1U);
+		lines[(*nread)++] = line;
+	}
+
+	return lines;
+}
+
+int
+pf_find(paged_file_t *pf, int from, int backward, pf_match_func match,
+		void *arg)
+{
+	int found = -1;
+	size_t len;
+	const char *text;
+
+	if(!pf_has_line(pf, from))
+	{
+		return -1;
+	}
+
+	if(!backward)
+	{
+		size_t offset = line_start(pf, from);
+		int line = from;
+		while(offset < pf->size)
+		{
+			int result;
+
+			text = load_line(pf, offset, &len, &offset);
+			if(text == NULL)
+			{
+				break;
+			}
+
+			result = match(text, len, arg);
+			if(result != 0)
+			{
+				found = (result > 0) ? line : -2;
+				break;
+			}
+			++line;
+		}
+	}
+	else
+	{
+		/* Lines can't be enumerated backward efficiently, so go through blocks of
+		 * indexed lines in reverse order searching for the last match in each. */
+		int block;
+		for(block = from/LINE_STEP; block >= 0 && found == -1; --block)
+		{
+			const int last = MIN(from, (block + 1)*LINE_STEP - 1);
+			int line = block*LINE_STEP;
+			size_t offset = pf->offsets[block];
+			for(; line <= last && offset < pf->size; ++line)
+			{
+				int result;
+
+				text = load_line(pf, offset, &len, &offset);
+				if(text == NULL)
+				{
+					break;
+				}
+
+				result = match(text, len, arg);
+				if(result < 0)
+				{
+					return -2;
+				}
+				if(result > 0)
+				{
+					found = line;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+/* Opens file at pf->path replacing currently opened one.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+open_file(paged_file_t *pf)
+{
+#ifndef _WIN32
+	const int fd = open(pf->path, O_RDONLY);
+	if(fd == -1)
+	{
+		return 1;
+	}
+
+	/* Don't leak the descriptor into viewers and other child processes. */
+	(void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	if(pf->fd != -1)
+	{
+		close(pf->fd);
+	}
+	pf->fd = fd;
+	pf->chunk_len = 0U;
+	pf->truncated = 0;
+
+	if(stat_file(pf) != 0)
+	{
+		return 1;
+	}
+
+	take_samples(pf);
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+/* Picks up changes of the opened file.  Index is preserved only if contents of
+ * the file looks like it was appended to.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+update_file(paged_file_t *pf)
+{
+	const size_t old_size = pf->size;
+
+	/* Buffered data might be outdated. */
+	pf->chunk_len = 0U;
+	pf->truncated = 0;
+
+	if(stat_file(pf) != 0)
+	{
+		return 1;
+	}
+
+	if(pf->size < old_size || !samples_match(pf, old_size))
+	{
+		reset_index(pf);
+	}
+	else if(pf->size > old_size && pf->complete)
+	{
+		/* Last line without newline can continue in appended data. */
+		if(pf->has_tail)
+		{
+			--pf->nlines;
+			pf->has_tail = 0;
+		}
+		pf->complete = 0;
+	}
+
+	take_samples(pf);
+	return 0;
+}
+
+/* Queries size and identity of the opened file.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+stat_file(paged_file_t *pf)
+{
+#ifndef _WIN32
+	struct stat st;
+
+	if(fstat(pf->fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		return 1;
+	}
+
+	pf->dev = st.st_dev;
+	pf->inode = st.st_ino;
+	pf->size = st.st_size;
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+/* Checks whether the file still starts and ends (at the old size) with the
+ * same bytes as when samples were taken.  Returns non-zero if so, otherwise
+ * zero is returned. */
+static int
+samples_match(paged_file_t *pf, size_t old_size)
+{
+	char buf[SAMPLE_SIZE];
+
+	if(pf->sample_len == 0U)
+	{
+		return (old_size == 0U);
+	}
+
+	if(read_bytes(pf, 0U, pf->sample_len, buf) != 0 ||
+			memcmp(buf, pf->head, pf->sample_len) != 0)
+	{
+		return 0;
+	}
+
+	return read_bytes(pf, old_size - pf->sample_len, pf->sample_len, buf) == 0
+	    && memcmp(buf, pf->tail, pf->sample_len) == 0;
+}
+
+/* Remembers first and last bytes of the file to be able to check whether it
+ * was changed in place later. */
+static void
+take_samples(paged_file_t *pf)
+{
+	pf->sample_len = MIN(pf->size, sizeof(pf->head));
+	if(read_bytes(pf, 0U, pf->sample_len, pf->head) != 0 ||
+			read_bytes(pf, pf->size - pf->sample_len, pf->sample_len,
+				pf->tail) != 0)
+	{
+		/* This will make the next check fail. */
+		pf->sample_len = 0U;
+	}
+}
+
+/* Indexed lines are invalidated if the file got shorter than it was.  This is
+ * checked before accessing the file, so that truncation is noticed without an
+ * explicit refresh. */
+static void
+check_truncation(paged_file_t *pf)
+{
+#ifndef _WIN32
+	struct stat st;
+	if(!pf->truncated && fstat(pf->fd, &st) == 0 &&
+			(size_t)st.st_size >= pf->size)
+	{
+		return;
+	}
+
+	/* On error the file ends up being empty. */
+	if(update_file(pf) != 0)
+	{
+		pf->size = 0U;
+		reset_index(pf);
+	}
+#endif
+}
+
+/* Drops all information about lines of the file. */
+static void
+reset_index(paged_file_t *pf)
+{
+	pf->noffsets = 0;
+	pf->nlines = 0;
+	pf->scanned = 0U;
+	pf->complete = 0;
+	pf->has_tail = 0;
+}
+
+/* Indexes lines of the file until the specified one is indexed or end of file
+ * is reached.  Indexing of cancellable file stops on cancellation request and
+ * resumes on the next call. */
+static void
+index_until(paged_file_t *pf, int line)
+{
+	while(!pf->complete && pf->nlines <= line)
+	{
+		size_t newline;
+
+		if(pf->scanned == pf->size || pf->nlines == INT_MAX)
+		{
+			pf->complete = 1;
+			break;
+		}
+
+		if(pf->cancellable && pf->nlines%LINE_STEP == 0 &&
+				ui_cancellation_requested())
+		{
+			break;
+		}
+
+		if(record_line(pf) != 0)
+		{
+			break;
+		}
+
+		++pf->nlines;
+
+		newline = find_newline(pf, pf->scanned);
+		if(newline == pf->size)
+		{
+			/* Offset of unterminated line is left in scanned, see pf_refresh(). */
+			pf->has_tail = 1;
+			pf->complete = 1;
+			break;
+		}
+
+		pf->scanned = newline + 1U;
+	}
+}
+
+/* Adds offset of the next line to the index if it's a line that's stored there.
+ * Returns zero on success, otherwise non-zero is returned. */
+static int
+record_line(paged_file_t *pf)
+{
+	const int i = pf->nlines/LINE_STEP;
+
+	if(pf->nlines%LINE_STEP != 0)
+	{
+		return 0;
+	}
+
+	if(i == pf->noffsets)
+	{
+		size_t *const offsets = realloc(pf->offsets,
+				sizeof(*offsets)*(pf->noffsets + 1));
+		if(offsets == NULL)
+		{
+			return 1;
+		}
+		pf->offsets = offsets;
+		++pf->noffsets;
+	}
+
+	pf->offsets[i] = pf->scanned;
+	return 0;
+}
+
+/* Finds beginning of an indexed line.  Returns offset of the line. */
+static size_t
+line_start(paged_file_t *pf, int line)
+{
+	size_t offset = pf->offsets[line/LINE_STEP];
+	int i;
+	for(i = 0; i < line%LINE_STEP; ++i)
+	{
+		offset = next_line(pf, offset);
+	}
+	return offset;
+}
+
+/* Finds beginning of the line that follows the one at the offset.  Returns
+ * offset of the next line, which is size of the file for the last line. */
+static size_t
+next_line(paged_file_t *pf, size_t offset)
+{
+	const size_t newline = find_newline(pf, offset);
+	return (newline == pf->size) ? pf->size : newline + 1U;
+}
+
+/* Looks for the first newline character at or after the offset.  Returns its
+ * offset or size of the file if there is none. */
+static size_t
+find_newline(paged_file_t *pf, size_t offset)
+{
+	while(offset < pf->size)
+	{
+		size_t len;
+		const char *newline;
+		const char *const data = get_chunk(pf, offset, &len);
+		if(data == NULL)
+		{
+			break;
+		}
+
+		newline = memchr(data, '\n', len);
+		if(newline != NULL)
+		{
+			return offset + (newline - data);
+		}
+		offset += len;
+	}
+	return pf->size;
+}
+
+/* Reads line at the offset into internal buffer dropping its line ending.
+ * Returns pointer to null-terminated line (valid until the next call) or NULL
+ * on error, *len is set to length of the line and *next to offset of the next
+ * line. */
+static const char *
+load_line(paged_file_t *pf, size_t offset, size_t *len, size_t *next)
+{
+	const size_t newline = find_newline(pf, offset);
+	size_t n = newline - offset;
+
+	if(n + 1U > pf->line_cap)
+	{
+		char *const line = realloc(pf->line, n + 1U);
+		if(line == NULL)
+		{
+			return NULL;
+		}
+		pf->line = line;
+		pf->line_cap = n + 1U;
+	}
+
+	if(read_bytes(pf, offset, n, pf->line) != 0)
+	{
+		return NULL;
+	}
+
+	if(n != 0U && pf->line[n - 1U] == '\r')
+	{
+		--n;
+	}
+	pf->line[n] = '\0';
+
+	*len = n;
+	*next = (newline == pf->size) ? pf->size : newline + 1U;
+	return pf->line;
+}
+
+/* Copies len bytes of the file starting at the offset into the buffer.
+ * Returns zero on success, otherwise non-zero is returned. */
+static int
+read_bytes(paged_file_t *pf, size_t offset, size_t len, char buf[])
+{
+	while(len != 0U)
+	{
+		size_t available;
+		const char *const data = get_chunk(pf, offset, &available);
+		if(data == NULL)
+		{
+			return 1;
+		}
+
+		available = MIN(available, len);
+		memcpy(buf, data, available);
+		buf += available;
+		offset += available;
+		len -= available;
+	}
+	return 0;
+}
+
+/* Retrieves contents of the file starting at the offset reading it if
+ * necessary.  Returns pointer to the data or NULL on error or end of file, *len
+ * is set to number of available bytes. */
+static const char *
+get_chunk(paged_file_t *pf, size_t offset, size_t *len)
+{
+#ifndef _WIN32
+	if(offset < pf->chunk_offset || offset >= pf->chunk_offset + pf->chunk_len)
+	{
+		size_t wanted;
+		ssize_t nread;
+
+		if(offset >= pf->size)
+		{
+			return NULL;
+		}
+
+		wanted = MIN(pf->size - offset, (size_t)CHUNK_SIZE);
+		do
+		{
+			nread = pread(pf->fd, pf->chunk, wanted, offset);
+		}
+		while(nread == -1 && errno == EINTR);
+
+		pf->chunk_offset = offset;
+		pf->chunk_len = (nread > 0) ? (size_t)nread : 0U;
+		if(pf->chunk_len < wanted)
+		{
+			/* The file got shorter, it will be rechecked on the next access. */
+			pf->truncated = 1;
+		}
+		if(pf->chunk_len == 0U)
+		{
+			return NULL;
+		}
+	}
+
+	*len = pf->chunk_offset + pf->chunk_len - offset;
+	return pf->chunk + (offset - pf->chunk_offset);
+#else
+	return NULL;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
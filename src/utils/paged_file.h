@@ -0,0 +1,82 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__PAGED_FILE_H__
+#define VIFM__UTILS__PAGED_FILE_H__
+
+#include <stddef.h> /* size_t */
+
+/* Read-only access to lines of a file, which can be much larger than available
+ * memory.  The file is read by pieces on demand and only sparse index of
+ * offsets of lines is kept, which is built lazily as far as it's necessary.
+ * Lines are separated by '\n', trailing '\r' is dropped.  Truncation of the
+ * file is detected on every access and makes the index to be rebuilt. */
+
+/* Opaque declaration of structure describing opened file. */
+typedef struct paged_file_t paged_file_t;
+
+/* Checks whether line of length len (not null-terminated) matches.  Returns
+ * positive number if so, zero if it doesn't and negative number to stop the
+ * search. */
+typedef int (*pf_match_func)(const char line[], size_t len, void *arg);
+
+/* Opens file for reading by lines.  Returns NULL on error or if this kind of
+ * access isn't supported on the system. */
+paged_file_t * pf_open(const char path[]);
+
+/* Closes the file and frees all associated resources.  The pf can be NULL. */
+void pf_close(paged_file_t *pf);
+
+/* Picks up changes of the file.  Index of lines is preserved if the file only
+ * grew (e.g., log that is being written to).  File that was replaced (e.g.,
+ * rotated by renaming) is reopened.  Returns zero on success, otherwise
+ * non-zero is returned and the pf should be closed. */
+int pf_refresh(paged_file_t *pf);
+
+/* Sets whether indexing of lines should stop when ui_cancellation_requested()
+ * reports a request, in which case lines that weren't reached are treated as
+ * missing until they are requested again.  Not cancellable by default. */
+void pf_set_cancellable(paged_file_t *pf, int cancellable);
+
+/* Counts number of lines in the file, which requires indexing whole file.
+ * Returns the number. */
+int pf_count_lines(paged_file_t *pf);
+
+/* Retrieves number of lines indexed so far.  Sets *complete to non-zero if this
+ * is number of lines in the file.  Returns the number. */
+int pf_known_lines(const paged_file_t *pf, int *complete);
+
+/* Checks whether line with the number exists (numbering starts with zero).
+ * Returns non-zero if so, otherwise zero is returned. */
+int pf_has_line(paged_file_t *pf, int line);
+
+/* Reads at most count lines starting with the first one.  Returns array of
+ * *nread lines (empty one if there are no such lines) or NULL on error. */
+char ** pf_read_lines(paged_file_t *pf, int first, int count, int *nread);
+
+/* Looks for a line for which match callback returns positive number starting
+ * with the from line and going forward or backward.  Returns number of the
+ * line, -1 if nothing was found or -2 if the search was stopped by the
+ * callback. */
+int pf_find(paged_file_t *pf, int from, int backward, pf_match_func match,
+		void *arg);
+
+#endif /* VIFM__UTILS__PAGED_FILE_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -702,6 +702,13 @@ find_cmd_in_path(const char cmd[], size_t path_len, char path[])
 	for(i = 0; i < paths_count; i++)
 	{
 		char tmp_path[PATH_MAX];
+
+		/* Skip directories without such file without querying file system. */
+		if(!path_dir_may_contain(i, cmd))
+		{
+			continue;
+		}
+
 		snprintf(tmp_path, sizeof(tmp_path), "%s/%s", paths[i], cmd);
 
 		/* Need to check for executable, not just a file, as this additionally
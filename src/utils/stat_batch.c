@@ -0,0 +1,150 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+
+#include "stat_batch.h"
+
+#include <pthread.h>
+
+#include <fcntl.h> /* AT_SYMLINK_NOFOLLOW */
+#include <sys/stat.h> /* fstatat() */
+#include <unistd.h> /* sysconf() */
+
+#include <errno.h> /* errno */
+#include <stddef.h> /* size_t */
+#include <stdlib.h> /* free() malloc() */
+
+#include "macros.h"
+
+/* Maximum number of threads used to process a batch. */
+#define MAX_WORKERS 8
+
+/* State shared among workers processing the same batch. */
+typedef struct
+{
+	int dirfd;                /* Base directory for relative paths. */
+	stat_batch_item_t *items; /* Items of the batch. */
+	size_t count;             /* Number of items. */
+	size_t batch_size;        /* Number of items claimed at a time. */
+	size_t next;              /* Index of the first item yet to be claimed. */
+	pthread_mutex_t lock;     /* Protects the next field. */
+}
+batch_t;
+
+static void * worker(void *arg);
+static int claim_chunk(batch_t *batch, size_t *from, size_t *to);
+
+void
+stat_batch(int dirfd, stat_batch_item_t items[], size_t count, int workers,
+		size_t batch_size)
+{
+	batch_t batch = {
+		.dirfd = dirfd,
+		.items = items,
+		.count = count,
+		.batch_size = (batch_size == 0U) ? 1U : batch_size,
+		.next = 0U,
+	};
+	pthread_t *threads;
+	int started = 0;
+
+	workers = MIN(workers, (int)DIV_ROUND_UP(count, batch.batch_size));
+	threads = (workers > 1) ? malloc(sizeof(*threads)*(workers - 1)) : NULL;
+
+	pthread_mutex_init(&batch.lock, NULL);
+
+	/* Failure to start some of threads is not critical, calling thread takes
+	 * part in processing and will handle all leftovers. */
+	if(threads != NULL)
+	{
+		while(started < workers - 1)
+		{
+			if(pthread_create(&threads[started], NULL, &worker, &batch) != 0)
+			{
+				break;
+			}
+			++started;
+		}
+	}
+
+	(void)worker(&batch);
+
+	while(started > 0)
+	{
+		pthread_join(threads[--started], NULL);
+	}
+
+	pthread_mutex_destroy(&batch.lock);
+	free(threads);
+}
+
+/* Entry point of a worker thread, which processes chunks of the batch until
+ * there are no more of them.  Returns NULL. */
+static void *
+worker(void *arg)
+{
+	batch_t *const batch = arg;
+	size_t from, to;
+
+	while(claim_chunk(batch, &from, &to))
+	{
+		for(; from < to; ++from)
+		{
+			stat_batch_item_t *const item = &batch->items[from];
+			const int failed = fstatat(batch->dirfd, item->name, &item->st,
+					AT_SYMLINK_NOFOLLOW);
+			item->error = failed ? errno : 0;
+		}
+	}
+
+	return NULL;
+}
+
+/* Reserves next chunk of the batch for processing by current thread.  Returns
+ * non-zero if *from and *to were set to a non-empty range, otherwise zero is
+ * returned. */
+static int
+claim_chunk(batch_t *batch, size_t *from, size_t *to)
+{
+	pthread_mutex_lock(&batch->lock);
+	*from = batch->next;
+	*to = MIN(batch->next + batch->batch_size, batch->count);
+	batch->next = *to;
+	pthread_mutex_unlock(&batch->lock);
+
+	return *from != *to;
+}
+
+int
+stat_batch_workers(size_t count, size_t batch_size)
+{
+	const long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	const size_t nchunks = DIV_ROUND_UP(count, MAX(batch_size, 1U));
+
+	if(ncpus <= 1 || nchunks <= 1U)
+	{
+		return 1;
+	}
+
+	/* Stat() is usually bound by I/O rather than by CPU, so use more threads
+	 * than there are CPUs, but don't go overboard. */
+	return (int)MIN((size_t)MIN(ncpus*2, (long)MAX_WORKERS), nchunks);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -0,0 +1,51 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__STAT_BATCH_H__
+#define VIFM__UTILS__STAT_BATCH_H__
+
+#include <sys/stat.h> /* stat */
+
+#include <stddef.h> /* size_t */
+
+/* Querying of file meta-data for many files at once by a pool of threads. */
+
+/* Single element of a batch. */
+typedef struct
+{
+	const char *name; /* Path relative to the directory or absolute path. */
+	struct stat st;   /* Result of the query (valid only if error is zero). */
+	int error;        /* Zero on success, otherwise errno value. */
+}
+stat_batch_item_t;
+
+/* Performs lstat() for each item of the batch relative to the dirfd directory
+ * (AT_FDCWD is allowed).  Items are split in chunks of batch_size elements
+ * which are processed by up to workers threads (including calling one).  The
+ * order of items is preserved and results do not depend on parameters. */
+void stat_batch(int dirfd, stat_batch_item_t items[], size_t count,
+		int workers, size_t batch_size);
+
+/* Picks number of workers to process count items in chunks of batch_size
+ * elements.  Returns at least one. */
+int stat_batch_workers(size_t count, size_t batch_size);
+
+#endif /* VIFM__UTILS__STAT_BATCH_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -0,0 +1,228 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "string_map.h"
+
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* memcpy() strcmp() strlen() */
+
+/* Single key-value pair of the map. */
+typedef struct entry_t
+{
+	struct entry_t *next; /* Next entry in the same bucket. */
+	size_t hash;          /* Hash of the key. */
+	void *value;          /* Value of the key. */
+	char *key;            /* Copy of the key, allocated with the entry. */
+}
+entry_t;
+
+struct string_map_t
+{
+	entry_t **buckets; /* Chains of entries. */
+	size_t nbuckets;   /* Number of buckets, always a power of two. */
+	int size;          /* Number of entries. */
+};
+
+static entry_t ** find_entry(const string_map_t *map, const char key[],
+		size_t hash);
+static int grow(string_map_t *map);
+static size_t hash_key(const char key[]);
+
+string_map_t *
+string_map_create(void)
+{
+	string_map_t *const map = malloc(sizeof(*map));
+	if(map == NULL)
+	{
+		return NULL;
+	}
+
+	map->nbuckets = 16U;
+	map->size = 0;
+	map->buckets = calloc(map->nbuckets, sizeof(*map->buckets));
+	if(map->buckets == NULL)
+	{
+		free(map);
+		return NULL;
+	}
+
+	return map;
+}
+
+void
+string_map_free(string_map_t *map, void (*free_value)(void *value))
+{
+	size_t i;
+
+	if(map == NULL)
+	{
+		return;
+	}
+
+	for(i = 0U; i < map->nbuckets; ++i)
+	{
+		entry_t *entry = map->buckets[i];
+		while(entry != NULL)
+		{
+			entry_t *const next = entry->next;
+			if(free_value != NULL)
+			{
+				free_value(entry->value);
+			}
+			free(entry);
+			entry = next;
+		}
+	}
+
+	free(map->buckets);
+	free(map);
+}
+
+int
+string_map_set(string_map_t *map, const char key[], void *value)
+{
+	const size_t hash = hash_key(key);
+	entry_t **const link = find_entry(map, key, hash);
+	entry_t *entry;
+	size_t len;
+
+	if(*link != NULL)
+	{
+		(*link)->value = value;
+		return 0;
+	}
+
+	if(map->size >= (int)map->nbuckets && grow(map) != 0)
+	{
+		return 1;
+	}
+
+	len = strlen(key);
+	entry = malloc(sizeof(*entry) + len + 1U);
+	if(entry == NULL)
+	{
+		return 1;
+	}
+
+	entry->key = (char *)(entry + 1);
+	memcpy(entry->key, key, len + 1U);
+	entry->hash = hash;
+	entry->value = value;
+	entry->next = map->buckets[hash & (map->nbuckets - 1U)];
+	map->buckets[hash & (map->nbuckets - 1U)] = entry;
+	++map->size;
+	return 0;
+}
+
+void *
+string_map_get(const string_map_t *map, const char key[])
+{
+	entry_t *const entry = *find_entry(map, key, hash_key(key));
+	return (entry == NULL) ? NULL : entry->value;
+}
+
+void *
+string_map_remove(string_map_t *map, const char key[])
+{
+	entry_t **const link = find_entry(map, key, hash_key(key));
+	entry_t *const entry = *link;
+	void *value;
+
+	if(entry == NULL)
+	{
+		return NULL;
+	}
+
+	value = entry->value;
+	*link = entry->next;
+	free(entry);
+	--map->size;
+	return value;
+}
+
+int
+string_map_size(const string_map_t *map)
+{
+	return map->size;
+}
+
+/* Finds entry of the key.  Returns pointer to link to the entry, which points
+ * to NULL if there is no such entry. */
+static entry_t **
+find_entry(const string_map_t *map, const char key[], size_t hash)
+{
+	entry_t **link = &map->buckets[hash & (map->nbuckets - 1U)];
+	while(*link != NULL)
+	{
+		if((*link)->hash == hash && strcmp((*link)->key, key) == 0)
+		{
+			break;
+		}
+		link = &(*link)->next;
+	}
+	return link;
+}
+
+/* Doubles number of buckets.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+grow(string_map_t *map)
+{
+	const size_t nbuckets = map->nbuckets*2U;
+	entry_t **const buckets = calloc(nbuckets, sizeof(*buckets));
+	size_t i;
+
+	if(buckets == NULL)
+	{
+		return 1;
+	}
+
+	for(i = 0U; i < map->nbuckets; ++i)
+	{
+		entry_t *entry = map->buckets[i];
+		while(entry != NULL)
+		{
+			entry_t *const next = entry->next;
+			entry->next = buckets[entry->hash & (nbuckets - 1U)];
+			buckets[entry->hash & (nbuckets - 1U)] = entry;
+			entry = next;
+		}
+	}
+
+	free(map->buckets);
+	map->buckets = buckets;
+	map->nbuckets = nbuckets;
+	return 0;
+}
+
+/* Computes FNV-1a hash of the key.  Returns the hash. */
+static size_t
+hash_key(const char key[])
+{
+	size_t hash = 2166136261U;
+	while(*key != '\0')
+	{
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
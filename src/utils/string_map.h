@@ -0,0 +1,52 @@
+/* vifm
+ * Copyright (C) 2015 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__STRING_MAP_H__
+#define VIFM__UTILS__STRING_MAP_H__
+
+/* Hash table that maps strings to pointers.  Keys are copied, values are
+ * owned by the caller. */
+
+/* Opaque declaration of the map. */
+typedef struct string_map_t string_map_t;
+
+/* Creates an empty map.  Returns the map or NULL on error. */
+string_map_t * string_map_create(void);
+
+/* Frees the map, calling free_value for each value if it's not NULL.  Freeing
+ * NULL map is OK. */
+void string_map_free(string_map_t *map, void (*free_value)(void *value));
+
+/* Sets value of the key, replacing old value if there is one (the old value is
+ * not freed).  Returns zero on success, otherwise non-zero is returned. */
+int string_map_set(string_map_t *map, const char key[], void *value);
+
+/* Looks up value of the key.  Returns the value or NULL if key is absent. */
+void * string_map_get(const string_map_t *map, const char key[]);
+
+/* Removes the key from the map.  Returns value of the key or NULL if key is
+ * absent. */
+void * string_map_remove(string_map_t *map, const char key[]);
+
+/* Retrieves number of keys in the map.  Returns the number. */
+int string_map_size(const string_map_t *map);
+
+#endif /* VIFM__UTILS__STRING_MAP_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -18,35 +18,80 @@
 
 #include "tree.h"
 
-#include <stdlib.h>
-#include <string.h>
+#include <ctype.h> /* tolower() */
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* calloc() free() malloc() realloc() */
+#include <string.h> /* memcpy() memmove() */
 
 #ifdef _WIN32
 #include "fs.h"
 #endif
 #include "fs_limits.h"
+#include "macros.h"
 #include "str.h"
 
+/* Path component shared among all nodes of a tree with the same name. */
+typedef struct name_t
+{
+	struct name_t *next; /* Next name in the same bucket. */
+	size_t hash;         /* Hash of the name. */
+	size_t len;          /* Length of the name. */
+	int refs;            /* Number of nodes that use this name. */
+	char *str;           /* Contents of the name, allocated with the struct. */
+}
+name_t;
+
 typedef struct node_t
 {
-	char *name;
-	size_t name_len;
+	name_t *name;             /* Name of the node, NULL for the root. */
+	struct node_t *parent;    /* Parent of the node, NULL for the root. */
+	struct node_t **children; /* Children sorted by their names. */
+	size_t nchildren;         /* Number of children. */
+	size_t capacity;          /* Number of allocated elements of children. */
 	tree_val_t data;
 	int valid;
-	struct node_t *next;
-	struct node_t *child;
-}node_t;
+	struct node_t *lru_prev;  /* More recently used node with value. */
+	struct node_t *lru_next;  /* Less recently used node with value. */
+}
+node_t;
 
 typedef struct root_t
 {
 	node_t node;
 	int longest;
 	int mem;
-}root_t;
+	name_t **names;    /* Hash table of interned names. */
+	size_t nbuckets;   /* Number of buckets in the hash table. */
+	size_t nnames;     /* Number of names in the hash table. */
+	node_t *lru_head;  /* Most recently used node with value. */
+	node_t *lru_tail;  /* Least recently used node with value. */
+	size_t nvalues;    /* Number of nodes with values. */
+	size_t max_values; /* Limit on nvalues, zero means no limit. */
+	int canonical;     /* Whether paths are passed in already resolved. */
+}
+root_t;
 
-static void nodes_free(node_t *node);
-static node_t * find_node(node_t *root, const char *name, int create,
+static const char * resolve_path(const root_t *tree, const char path[],
+		char buf[]);
+static void nodes_free(root_t *tree, node_t *node);
+static node_t * find_node(root_t *tree, const char path[], int create,
 		node_t **last);
+static size_t find_child(const node_t *node, const char name[], size_t len,
+		int *found);
+static int compare_names(const char a[], size_t a_len, const char b[],
+		size_t b_len);
+static node_t * add_child(root_t *tree, node_t *node, size_t pos,
+		const char name[], size_t len);
+static void drop_value(root_t *tree, node_t *node);
+static void drop_subtree(root_t *tree, node_t *node);
+static void prune(root_t *tree, node_t *node);
+static void evict_values(root_t *tree);
+static void lru_unlink(root_t *tree, node_t *node);
+static void lru_push_front(root_t *tree, node_t *node);
+static name_t * intern_name(root_t *tree, const char name[], size_t len);
+static void release_name(root_t *tree, name_t *name);
+static int grow_names(root_t *tree);
+static size_t hash_name(const char name[], size_t len);
 
 tree_t
 tree_create(int longest, int mem)
@@ -58,35 +103,93 @@ tree_create(int longest, int mem)
 		return NULL_TREE;
 	}
 
-	tree->node.child = NULL;
-	tree->node.next = NULL;
 	tree->node.name = NULL;
+	tree->node.parent = NULL;
+	tree->node.children = NULL;
+	tree->node.nchildren = 0U;
+	tree->node.capacity = 0U;
 	tree->node.valid = 0;
+	tree->node.lru_prev = NULL;
+	tree->node.lru_next = NULL;
 	tree->longest = longest;
 	tree->mem = mem;
+	tree->names = NULL;
+	tree->nbuckets = 0U;
+	tree->nnames = 0U;
+	tree->lru_head = NULL;
+	tree->lru_tail = NULL;
+	tree->nvalues = 0U;
+	tree->max_values = 0U;
+	tree->canonical = 0;
 	return tree;
 }
 
 void
 tree_free(tree_t tree)
 {
-	if(tree != NULL_TREE)
+	size_t i;
+
+	if(tree == NULL_TREE)
 	{
-		nodes_free(&tree->node);
+		return;
+	}
+
+	nodes_free(tree, &tree->node);
+
+	for(i = 0U; i < tree->nbuckets; ++i)
+	{
+		name_t *name = tree->names[i];
+		while(name != NULL)
+		{
+			name_t *const next = name->next;
+			free(name);
+			name = next;
+		}
 	}
+	free(tree->names);
+
+	free(tree);
 }
 
+/* Frees children of the node and value of the node itself, but not the node
+ * and its name. */
 static void
-nodes_free(node_t *node)
+nodes_free(root_t *tree, node_t *node)
 {
-	if(node->child != NULL)
-		nodes_free(node->child);
+	size_t i;
 
-	if(node->next != NULL)
-		nodes_free(node->next);
+	for(i = 0U; i < node->nchildren; ++i)
+	{
+		nodes_free(tree, node->children[i]);
+		free(node->children[i]);
+	}
+	free(node->children);
 
-	free(node->name);
-	free(node);
+	if(node->valid && tree->mem)
+	{
+		union
+		{
+			tree_val_t l;
+			void *p;
+		}u = {
+			.l = node->data,
+		};
+
+		free(u.p);
+	}
+}
+
+void
+tree_set_limit(tree_t tree, size_t max_values)
+{
+	tree->max_values = max_values;
+	evict_values(tree);
+}
+
+void
+tree_set_canonical(tree_t tree, int canonical)
+{
+	tree->canonical = canonical;
 }
 
 int
@@ -95,10 +198,13 @@ tree_set_data(tree_t tree, const char *path, tree_val_t data)
 	node_t *node;
 	char real_path[PATH_MAX];
 
-	if(realpath(path, real_path) != real_path)
+	if((path = resolve_path(tree, path, real_path)) == NULL)
+		return -1;
+
+	node = find_node(tree, path, 1, NULL);
+	if(node == NULL)
 		return -1;
 
-	node = find_node(&tree->node, real_path, 1, NULL);
 	if(node->valid && tree->mem)
 	{
 		union
@@ -111,8 +217,20 @@ tree_set_data(tree_t tree, const char *path, tree_val_t data)
 
 		free(u.p);
 	}
+
+	if(node->valid)
+	{
+		lru_unlink(tree, node);
+	}
+	else
+	{
+		node->valid = 1;
+		++tree->nvalues;
+	}
+	lru_push_front(tree, node);
+
 	node->data = data;
-	node->valid = 1;
+	evict_values(tree);
 	return 0;
 }
 
@@ -123,81 +241,418 @@ tree_get_data(tree_t tree, const char *path, tree_val_t *data)
 	node_t *node;
 	char real_path[PATH_MAX];
 
-	if(tree->node.child == NULL)
+	if(tree->nvalues == 0U)
 		return -1;
 
-	if(realpath(path, real_path) != real_path)
+	if((path = resolve_path(tree, path, real_path)) == NULL)
 		return -1;
 
-	node = find_node(&tree->node, real_path, 0, tree->longest ? &last : NULL);
-	if((node == NULL || !node->valid) && last == NULL)
-		return -1;
+	node = find_node(tree, path, 0, tree->longest ? &last : NULL);
+	if(node == NULL || !node->valid)
+	{
+		if(last == NULL)
+			return -1;
+		node = last;
+	}
 
-	if(node != NULL && node->valid)
-		*data = node->data;
-	else
-		*data = last->data;
+	lru_unlink(tree, node);
+	lru_push_front(tree, node);
+
+	*data = node->data;
 	return 0;
 }
 
-static node_t *
-find_node(node_t *root, const char *name, int create, node_t **last)
+void
+tree_remove(tree_t tree, const char *path)
 {
-	const char *end;
-	size_t name_len;
-	node_t *prev = NULL, *curr;
-	node_t *new_node;
+	node_t *node;
+	char real_path[PATH_MAX];
+
+	/* The path might not exist anymore, in which case it's used as is. */
+	const char *const resolved = resolve_path(tree, path, real_path);
+	if(resolved != NULL)
+		path = resolved;
+
+	node = find_node(tree, path, 0, NULL);
+	if(node != NULL)
+	{
+		drop_subtree(tree, node);
+		prune(tree, node);
+	}
+}
 
-	name = skip_char(name, '/');
-	if(*name == '\0')
-		return root;
+/* Resolves path into buf of PATH_MAX length unless paths of the tree are
+ * canonical.  Returns path to use or NULL on error. */
+static const char *
+resolve_path(const root_t *tree, const char path[], char buf[])
+{
+	if(tree->canonical)
+		return path;
+	return (realpath(path, buf) == buf) ? buf : NULL;
+}
 
-	end = until_first(name, '/');
+/* Looks up node by its path, possibly creating missing nodes.  *last is set to
+ * the deepest node with value on the way if last isn't NULL.  Returns the node
+ * or NULL if it doesn't exist or on error. */
+static node_t *
+find_node(root_t *tree, const char path[], int create, node_t **last)
+{
+	node_t *node = &tree->node;
 
-	name_len = end - name;
-	curr = root->child;
-	while(curr != NULL)
+	for(;;)
 	{
-		int comp = strnoscmp(name, curr->name, name_len);
-		if(comp == 0 && curr->name_len == name_len)
+		const char *end;
+		size_t len;
+		size_t pos;
+		int found;
+
+		path = skip_char(path, '/');
+		if(*path == '\0')
+			return node;
+
+		end = until_first(path, '/');
+		len = end - path;
+
+		pos = find_child(node, path, len, &found);
+		if(found)
+		{
+			node = node->children[pos];
+			if(node->valid && last != NULL)
+				*last = node;
+		}
+		else
 		{
-			if(curr->valid && last != NULL)
-				*last = curr;
-			return find_node(curr, end, create, last);
+			node_t *child;
+
+			if(!create)
+				return NULL;
+
+			child = add_child(tree, node, pos, path, len);
+			if(child == NULL)
+			{
+				/* Don't leave nodes without values and children behind. */
+				prune(tree, node);
+				return NULL;
+			}
+			node = child;
 		}
-		else if(comp < 0)
+
+		path = end;
+	}
+}
+
+/* Performs binary search of a child by its name.  Sets *found to non-zero if
+ * the child exists.  Returns position of the child or position at which it
+ * should be inserted. */
+static size_t
+find_child(const node_t *node, const char name[], size_t len, int *found)
+{
+	size_t l = 0U;
+	size_t r = node->nchildren;
+
+	while(l < r)
+	{
+		const size_t m = l + (r - l)/2U;
+		const name_t *const child_name = node->children[m]->name;
+		const int cmp = compare_names(name, len, child_name->str, child_name->len);
+		if(cmp == 0)
 		{
-			break;
+			*found = 1;
+			return m;
 		}
-		prev = curr;
-		curr = curr->next;
+
+		if(cmp < 0)
+			r = m;
+		else
+			l = m + 1U;
 	}
 
-	if(!create)
-		return NULL;
+	*found = 0;
+	return l;
+}
+
+/* Compares two names that aren't necessarily null-terminated.  Returns
+ * negative number, zero or positive number like strcmp() does. */
+static int
+compare_names(const char a[], size_t a_len, const char b[], size_t b_len)
+{
+	const int cmp = strnoscmp(a, b, MIN(a_len, b_len));
+	if(cmp != 0)
+		return cmp;
+	return (a_len < b_len) ? -1 : (a_len > b_len);
+}
+
+/* Inserts new child of the node at specified position.  Returns the child or
+ * NULL on error. */
+static node_t *
+add_child(root_t *tree, node_t *node, size_t pos, const char name[],
+		size_t len)
+{
+	node_t *child;
 
-	new_node = malloc(sizeof(*new_node));
-	if(new_node == NULL)
+	if(node->nchildren == node->capacity)
+	{
+		const size_t capacity = (node->capacity == 0U) ? 4U : node->capacity*2U;
+		node_t **const children = realloc(node->children,
+				sizeof(*children)*capacity);
+		if(children == NULL)
+			return NULL;
+		node->children = children;
+		node->capacity = capacity;
+	}
+
+	child = malloc(sizeof(*child));
+	if(child == NULL)
 		return NULL;
 
-	if((new_node->name = malloc(name_len + 1)) == NULL)
+	child->name = intern_name(tree, name, len);
+	if(child->name == NULL)
 	{
-		free(new_node);
+		free(child);
 		return NULL;
 	}
-	strncpy(new_node->name, name, name_len);
-	new_node->name[name_len] = '\0';
-	new_node->name_len = name_len;
-	new_node->valid = 0;
-	new_node->child = NULL;
-	new_node->next = curr;
 
-	if(root->child == curr)
-		root->child = new_node;
+	child->parent = node;
+	child->children = NULL;
+	child->nchildren = 0U;
+	child->capacity = 0U;
+	child->valid = 0;
+	child->lru_prev = NULL;
+	child->lru_next = NULL;
+
+	memmove(&node->children[pos + 1U], &node->children[pos],
+			sizeof(*node->children)*(node->nchildren - pos));
+	node->children[pos] = child;
+	++node->nchildren;
+
+	return child;
+}
+
+/* Removes value of the node if it has one. */
+static void
+drop_value(root_t *tree, node_t *node)
+{
+	if(!node->valid)
+		return;
+
+	if(tree->mem)
+	{
+		union
+		{
+			tree_val_t l;
+			void *p;
+		}u = {
+			.l = node->data,
+		};
+
+		free(u.p);
+	}
+
+	lru_unlink(tree, node);
+	node->valid = 0;
+	--tree->nvalues;
+}
+
+/* Removes all values of the node and its descendants along with descendant
+ * nodes. */
+static void
+drop_subtree(root_t *tree, node_t *node)
+{
+	size_t i;
+
+	for(i = 0U; i < node->nchildren; ++i)
+	{
+		node_t *const child = node->children[i];
+		drop_subtree(tree, child);
+		release_name(tree, child->name);
+		free(child);
+	}
+
+	free(node->children);
+	node->children = NULL;
+	node->nchildren = 0U;
+	node->capacity = 0U;
+
+	drop_value(tree, node);
+}
+
+/* Frees the node and its ancestors as long as they have neither values nor
+ * children. */
+static void
+prune(root_t *tree, node_t *node)
+{
+	while(node != &tree->node && !node->valid && node->nchildren == 0U)
+	{
+		node_t *const parent = node->parent;
+		int found;
+		const size_t pos = find_child(parent, node->name->str, node->name->len,
+				&found);
+
+		memmove(&parent->children[pos], &parent->children[pos + 1U],
+				sizeof(*parent->children)*(parent->nchildren - pos - 1U));
+		--parent->nchildren;
+
+		release_name(tree, node->name);
+		free(node->children);
+		free(node);
+
+		node = parent;
+	}
+}
+
+/* Drops least recently used values until their number fits the limit. */
+static void
+evict_values(root_t *tree)
+{
+	while(tree->max_values != 0U && tree->nvalues > tree->max_values)
+	{
+		node_t *const node = tree->lru_tail;
+		drop_value(tree, node);
+		prune(tree, node);
+	}
+}
+
+/* Excludes node from the list of nodes with values. */
+static void
+lru_unlink(root_t *tree, node_t *node)
+{
+	if(node->lru_prev == NULL)
+		tree->lru_head = node->lru_next;
 	else
-		prev->next = new_node;
+		node->lru_prev->lru_next = node->lru_next;
 
-	return find_node(new_node, end, create, last);
+	if(node->lru_next == NULL)
+		tree->lru_tail = node->lru_prev;
+	else
+		node->lru_next->lru_prev = node->lru_prev;
+
+	node->lru_prev = NULL;
+	node->lru_next = NULL;
+}
+
+/* Makes node the most recently used one. */
+static void
+lru_push_front(root_t *tree, node_t *node)
+{
+	node->lru_prev = NULL;
+	node->lru_next = tree->lru_head;
+	if(tree->lru_head != NULL)
+		tree->lru_head->lru_prev = node;
+	tree->lru_head = node;
+	if(tree->lru_tail == NULL)
+		tree->lru_tail = node;
+}
+
+/* Finds or adds name to the table of interned names.  Returns the name or NULL
+ * on error. */
+static name_t *
+intern_name(root_t *tree, const char name[], size_t len)
+{
+	const size_t hash = hash_name(name, len);
+	name_t *interned;
+
+	if(tree->nbuckets != 0U)
+	{
+		for(interned = tree->names[hash%tree->nbuckets]; interned != NULL;
+				interned = interned->next)
+		{
+			if(interned->hash == hash &&
+					compare_names(name, len, interned->str, interned->len) == 0)
+			{
+				++interned->refs;
+				return interned;
+			}
+		}
+	}
+
+	if(tree->nnames >= tree->nbuckets && grow_names(tree) != 0)
+		return NULL;
+
+	interned = malloc(sizeof(*interned) + len + 1U);
+	if(interned == NULL)
+		return NULL;
+
+	interned->str = (char *)(interned + 1);
+	memcpy(interned->str, name, len);
+	interned->str[len] = '\0';
+	interned->len = len;
+	interned->hash = hash;
+	interned->refs = 1;
+
+	interned->next = tree->names[hash%tree->nbuckets];
+	tree->names[hash%tree->nbuckets] = interned;
+	++tree->nnames;
+
+	return interned;
+}
+
+/* Drops reference to the interned name freeing it when it's not used
+ * anymore. */
+static void
+release_name(root_t *tree, name_t *name)
+{
+	name_t **link;
+
+	if(--name->refs != 0)
+		return;
+
+	link = &tree->names[name->hash%tree->nbuckets];
+	while(*link != name)
+		link = &(*link)->next;
+	*link = name->next;
+
+	--tree->nnames;
+	free(name);
+}
+
+/* Doubles number of buckets of table of interned names.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+grow_names(root_t *tree)
+{
+	const size_t nbuckets = (tree->nbuckets == 0U) ? 64U : tree->nbuckets*2U;
+	name_t **const names = calloc(nbuckets, sizeof(*names));
+	size_t i;
+
+	if(names == NULL)
+		return 1;
+
+	for(i = 0U; i < tree->nbuckets; ++i)
+	{
+		name_t *name = tree->names[i];
+		while(name != NULL)
+		{
+			name_t *const next = name->next;
+			name->next = names[name->hash%nbuckets];
+			names[name->hash%nbuckets] = name;
+			name = next;
+		}
+	}
+
+	free(tree->names);
+	tree->names = names;
+	tree->nbuckets = nbuckets;
+	return 0;
+}
+
+/* Computes hash of a name, which is case insensitive where file names are.
+ * Returns the hash. */
+static size_t
+hash_name(const char name[], size_t len)
+{
+	/* FNV-1a hash. */
+	size_t hash = 2166136261U;
+	size_t i;
+	for(i = 0U; i < len; ++i)
+	{
+#ifndef _WIN32
+		hash ^= (unsigned char)name[i];
+#else
+		hash ^= (unsigned char)tolower((unsigned char)name[i]);
+#endif
+		hash *= 16777619U;
+	}
+	return hash;
 }
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -19,7 +19,7 @@
 #ifndef VIFM__UTILS__TREE_H__
 #define VIFM__UTILS__TREE_H__
 
-#include <stddef.h> /* NULL */
+#include <stddef.h> /* NULL size_t */
 #include <stdint.h> /* uint64_t */
 
 #define NULL_TREE NULL
@@ -38,6 +38,16 @@ tree_t tree_create(int longest, int mem);
  * true. Freeing of NULL_TREE tree is OK. */
 void tree_free(tree_t tree);
 
+/* Limits number of values stored in the tree, least recently set or retrieved
+ * values are dropped to satisfy the limit.  Zero means no limit, which is the
+ * default. */
+void tree_set_limit(tree_t tree, size_t max_values);
+
+/* Makes tree treat paths passed to it as canonical ones (absolute, without
+ * symbolic links, "." and ".." components), which skips resolving them via
+ * realpath().  Off by default. */
+void tree_set_canonical(tree_t tree, int canonical);
+
 /* Returns non-zero on error. */
 int tree_set_data(tree_t tree, const char *path, tree_val_t data);
 
@@ -45,6 +55,10 @@ int tree_set_data(tree_t tree, const char *path, tree_val_t data);
  * error. */
 int tree_get_data(tree_t tree, const char *path, tree_val_t *data);
 
+/* Removes value at the path along with values of all paths under it.  The path
+ * doesn't have to exist on file system. */
+void tree_remove(tree_t tree, const char *path);
+
 #endif /* VIFM__UTILS__TREE_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
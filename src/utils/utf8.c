@@ -20,8 +20,9 @@
 
 #include <assert.h> /* assert() */
 #include <stddef.h> /* size_t wchar_t */
+#include <stdint.h> /* uint64_t */
 #include <stdlib.h> /* malloc() */
-#include <string.h> /* strlen() */
+#include <string.h> /* memcpy() strlen() */
 
 #include "macros.h"
 #include "utils.h"
@@ -29,6 +30,7 @@
 static size_t guess_char_width(char c);
 static wchar_t utf8_char_to_wchar(const char str[], size_t char_width);
 static size_t get_char_screen_width(const char str[], size_t char_width);
+static size_t count_printable_ascii(const char str[], size_t len);
 
 size_t
 get_char_width(const char str[])
@@ -150,13 +152,25 @@ utf8_char_to_wchar(const char str[], size_t char_width)
 size_t
 get_screen_string_length(const char str[])
 {
+	const char *const end = str + strlen(str);
 	size_t length = 0;
-	while(*str != '\0')
+	while(str != end)
 	{
-		const size_t char_width = get_char_width(str);
-		const size_t char_screen_width = get_char_screen_width(str, char_width);
+		size_t char_width;
+
+		/* Each printable ASCII character occupies exactly one position, no need to
+		 * decode and query their width one by one. */
+		const size_t ascii_len = count_printable_ascii(str, end - str);
+		str += ascii_len;
+		length += ascii_len;
+		if(str == end)
+		{
+			break;
+		}
+
+		char_width = get_char_width(str);
+		length += get_char_screen_width(str, char_width);
 		str += char_width;
-		length += char_screen_width;
 	}
 	return length;
 }
@@ -170,6 +184,38 @@ get_char_screen_width(const char str[], size_t char_width)
 	return (result == (size_t)-1) ? 1 : result;
 }
 
+/* Counts printable ASCII characters at the beginning of the string of length
+ * len.  Checks eight bytes at a time while possible.  Returns the number. */
+static size_t
+count_printable_ascii(const char str[], size_t len)
+{
+	const uint64_t ones = 0x0101010101010101ULL;
+	const uint64_t high_bits = 0x8080808080808080ULL;
+
+	size_t count = 0;
+
+	while(len - count >= sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, str + count, sizeof(word));
+		/* Non-ASCII bytes have high bit set, control characters get it set after
+		 * subtraction of a space. */
+		if(((word | (word - ones*' ')) & high_bits) != 0)
+		{
+			break;
+		}
+		count += sizeof(word);
+	}
+
+	while(count < len && (unsigned char)str[count] >= ' ' &&
+			(unsigned char)str[count] < 0x80)
+	{
+		++count;
+	}
+
+	return count;
+}
+
 size_t
 get_utf8_overhead(const char str[])
 {
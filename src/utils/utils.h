@@ -215,6 +215,11 @@ void get_gid_string(const dir_entry_t *entry, int as_num, size_t buf_len,
  * returned. */
 FILE * reopen_terminal(void);
 
+/* Makes standard input stream read from the terminal (e.g., after reading data
+ * passed via a pipe).  Returns zero on success, otherwise non-zero is
+ * returned. */
+int reopen_term_stdin(void);
+
 /* Executes the command via shell and opens its output for reading.  Returns
  * NULL on error, otherwise stream valid for reading is returned. */
 FILE * read_cmd_output(const char cmd[]);
@@ -25,8 +25,9 @@
 #include <sys/time.h> /* timeval */
 #include <sys/types.h> /* gid_t mode_t pid_t uid_t */
 #include <sys/wait.h> /* waitpid */
-#include <fcntl.h> /* open() close() */
+#include <fcntl.h> /* F_SETFD FD_CLOEXEC open() close() fcntl() */
 #include <grp.h> /* getgrnam() getgrgid_r() */
+#include <poll.h> /* POLLERR POLLPRI poll() pollfd */
 #include <pwd.h> /* getpwnam() getpwuid_r() */
 #include <unistd.h> /* X_OK dup() dup2() getpid() pause() */
 
@@ -39,7 +40,8 @@
 #include <stddef.h> /* NULL size_t */
 #include <stdio.h> /* FILE stderr fdopen() fprintf() snprintf() */
 #include <stdlib.h> /* atoi() free() */
-#include <string.h> /* strchr() strdup() strlen() strncmp() */
+#include <string.h> /* strchr() strcpy() strdup() strlen() strncmp()
+                       strrchr() */
 
 #include "../cfg/config.h"
 #include "../compat/os.h"
@@ -55,28 +57,13 @@
 #include "mntent.h" /* mntent setmntent() getmntent() endmntent() */
 #include "path.h"
 #include "str.h"
+#include "string_map.h"
 #include "utils.h"
 
-/* Types of mount point information for get_mount_point_traverser_state. */
-typedef enum
-{
-	MI_MOUNT_POINT, /* Path to the mount point. */
-	MI_FS_TYPE,     /* File system name. */
-}
-mntinfo;
-
-/* State for get_mount_point() traverser. */
-typedef struct
-{
-	mntinfo type;     /* Type of information to put into the buffer. */
-	const char *path; /* Path whose mount point we're looking for. */
-	size_t buf_len;   /* Output buffer length. */
-	char *buf;        /* Output buffer. */
-	size_t curr_len;  /* Max length among all found points (len of buf string). */
-}
-get_mount_point_traverser_state;
-
-static int get_mount_info_traverser(struct mntent *entry, void *arg);
+static const struct mntent * find_mount(const char path[]);
+static int update_mounts(void);
+static int mounts_changed(void);
+static void strip_trailing_slashes(char path[]);
 static void free_mnt_entries(struct mntent *entries, unsigned int nentries);
 struct mntent * read_mnt_entries(unsigned int *nentries);
 static int clone_mnt_entry(struct mntent *lhs, const struct mntent *rhs);
@@ -84,6 +71,19 @@ static void free_mnt_entry(struct mntent *entry);
 static int starts_with_list_item(const char str[], const char list[]);
 static int find_path_prefix_index(const char path[], const char list[]);
 
+/* Cached mount table. */
+static struct
+{
+	struct mntent *entries; /* Mount entries in order of the table. */
+	unsigned int nentries;  /* Number of elements in the entries array. */
+	string_map_t *dirs;     /* Maps mount points to their first entries. */
+	int loaded;             /* Whether fields above correspond to the table. */
+	int mountinfo_fd;       /* Opened /proc/self/mountinfo or -1. */
+	int mountinfo_opened;   /* Whether opening mountinfo was tried. */
+	filemon_t mtab_mon;     /* State of /etc/mtab when mountinfo_fd is -1. */
+}
+mounts = { .mountinfo_fd = -1 };
+
 void
 pause_shell(void)
 {
@@ -316,15 +316,7 @@ refers_to_slower_fs(const char from[], const char to[])
 int
 is_on_slow_fs(const char full_path[])
 {
-	char fs_name[PATH_MAX];
-	get_mount_point_traverser_state state =
-	{
-		.type = MI_FS_TYPE,
-		.path = full_path,
-		.buf_len = sizeof(fs_name),
-		.buf = fs_name,
-		.curr_len = 0UL,
-	};
+	const struct mntent *entry;
 
 	/* Empty list optimization. */
 	if(cfg.slow_fs_list[0] == '\0')
@@ -332,15 +324,10 @@ is_on_slow_fs(const char full_path[])
 		return 0;
 	}
 
-	if(traverse_mount_points(&get_mount_info_traverser, &state) == 0)
+	entry = find_mount(full_path);
+	if(entry != NULL && starts_with_list_item(entry->mnt_type, cfg.slow_fs_list))
 	{
-		if(state.curr_len > 0)
-		{
-			if(starts_with_list_item(fs_name, cfg.slow_fs_list))
-			{
-				return 1;
-			}
-		}
+		return 1;
 	}
 
 	return find_path_prefix_index(full_path, cfg.slow_fs_list) != -1;
@@ -349,77 +336,155 @@ is_on_slow_fs(const char full_path[])
 int
 get_mount_point(const char path[], size_t buf_len, char buf[])
 {
-	get_mount_point_traverser_state state =
+	const struct mntent *entry;
+
+	if(update_mounts() != 0)
+	{
+		return 1;
+	}
+
+	entry = find_mount(path);
+	if(entry != NULL)
 	{
-		.type = MI_MOUNT_POINT,
-		.path = path,
-		.buf_len = buf_len,
-		.buf = buf,
-		.curr_len = 0UL,
-	};
-	return traverse_mount_points(&get_mount_info_traverser, &state);
+		copy_str(buf, buf_len, entry->mnt_dir);
+	}
+	return 0;
 }
 
-/* traverse_mount_points client that gets mount point info for a given path. */
-static int
-get_mount_info_traverser(struct mntent *entry, void *arg)
+int
+traverse_mount_points(mptraverser client, void *arg)
 {
-	get_mount_point_traverser_state *const state = arg;
-	if(path_starts_with(state->path, entry->mnt_dir))
+	unsigned int i;
+
+	if(update_mounts() != 0)
+	{
+		return 1;
+	}
+
+	for(i = 0; i < mounts.nentries; ++i)
+	{
+		client(&mounts.entries[i], arg);
+	}
+
+	return 0;
+}
+
+/* Looks up mount point of the path by checking the path and its parents from
+ * the longest one.  Returns the entry or NULL if nothing is found. */
+static const struct mntent *
+find_mount(const char path[])
+{
+	char dir[strlen(path) + 1];
+
+	if(update_mounts() != 0)
 	{
-		const size_t new_len = strlen(entry->mnt_dir);
-		if(new_len > state->curr_len)
+		return NULL;
+	}
+
+	strcpy(dir, path);
+	strip_trailing_slashes(dir);
+
+	while(1)
+	{
+		char *slash;
+		const struct mntent *const entry = string_map_get(mounts.dirs, dir);
+		if(entry != NULL)
 		{
-			state->curr_len = new_len;
-			switch(state->type)
-			{
-				case MI_MOUNT_POINT:
-					copy_str(state->buf, state->buf_len, entry->mnt_dir);
-					break;
-				case MI_FS_TYPE:
-					copy_str(state->buf, state->buf_len, entry->mnt_type);
-					break;
-
-				default:
-					assert(0 && "Unknown mount information type.");
-					break;
-			}
+			return entry;
+		}
+
+		slash = strrchr(dir, '/');
+		if(slash == NULL || (slash == dir && dir[1] == '\0'))
+		{
+			return NULL;
 		}
+		slash[slash == dir] = '\0';
 	}
-	return 0;
 }
 
-int
-traverse_mount_points(mptraverser client, void *arg)
+/* Rereads mount table if it has changed.  Returns non-zero if the table is
+ * empty, otherwise zero is returned. */
+static int
+update_mounts(void)
 {
-	/* Cached mount entries, updated only when /etc/mtab changes. */
-	static filemon_t mtab_mon;
-	static struct mntent *entries;
-	static unsigned int nentries;
+	unsigned int i;
+
+	if(!mounts_changed())
+	{
+		return (mounts.nentries == 0U);
+	}
+
+	string_map_free(mounts.dirs, NULL);
+	free_mnt_entries(mounts.entries, mounts.nentries);
 
+	mounts.entries = read_mnt_entries(&mounts.nentries);
+	mounts.dirs = string_map_create();
+	mounts.loaded = (mounts.dirs != NULL);
+
+	for(i = 0U; i < mounts.nentries && mounts.dirs != NULL; ++i)
+	{
+		char dir[strlen(mounts.entries[i].mnt_dir) + 1];
+		strcpy(dir, mounts.entries[i].mnt_dir);
+		strip_trailing_slashes(dir);
+
+		/* The first entry wins for mount points that are listed several times. */
+		if(string_map_get(mounts.dirs, dir) == NULL &&
+				string_map_set(mounts.dirs, dir, &mounts.entries[i]) != 0)
+		{
+			mounts.loaded = 0;
+		}
+	}
+
+	return (mounts.nentries == 0U);
+}
+
+/* Checks whether cached mount table might be outdated.  Kernel marks
+ * /proc/self/mountinfo with POLLPRI on every change of the table, otherwise
+ * modification of /etc/mtab is checked.  Returns non-zero if so, otherwise zero
+ * is returned. */
+static int
+mounts_changed(void)
+{
 	filemon_t mon;
-	unsigned int i;
 
-	/* Check for cache validity. */
-	if(filemon_from_file("/etc/mtab", &mon) != 0 ||
-			!filemon_equal(&mon, &mtab_mon))
+	if(!mounts.mountinfo_opened)
 	{
-		filemon_assign(&mtab_mon, &mon);
-		free_mnt_entries(entries, nentries);
-		entries = read_mnt_entries(&nentries);
+		mounts.mountinfo_opened = 1;
+		mounts.mountinfo_fd = open("/proc/self/mountinfo", O_RDONLY);
+		if(mounts.mountinfo_fd != -1)
+		{
+			(void)fcntl(mounts.mountinfo_fd, F_SETFD, FD_CLOEXEC);
+		}
 	}
 
-	if(nentries == 0U)
+	if(mounts.mountinfo_fd != -1)
 	{
-		return 1;
+		struct pollfd pfd = { .fd = mounts.mountinfo_fd, .events = POLLPRI };
+		/* Polling resets the notification, so it's done unconditionally. */
+		const int changed = poll(&pfd, 1, 0) > 0
+		                 && (pfd.revents & (POLLPRI | POLLERR)) != 0;
+		return changed || !mounts.loaded;
 	}
 
-	for(i = 0; i < nentries; ++i)
+	if(filemon_from_file("/etc/mtab", &mon) == 0 &&
+			filemon_equal(&mon, &mounts.mtab_mon) && mounts.loaded)
 	{
-		client(&entries[i], arg);
+		return 0;
 	}
 
-	return 0;
+	filemon_assign(&mounts.mtab_mon, &mon);
+	return 1;
+}
+
+/* Removes trailing slashes from the path leaving root alone. */
+static void
+strip_trailing_slashes(char path[])
+{
+	size_t len = strlen(path);
+	while(len > 1U && path[len - 1U] == '/')
+	{
+		path[--len] = '\0';
+	}
 }
 
 /* Frees array of mount entries. */
@@ -777,6 +842,32 @@ reopen_terminal(void)
 	return fp;
 }
 
+int
+reopen_term_stdin(void)
+{
+	int ttyfd;
+
+	ttyfd = open("/dev/tty", O_RDONLY);
+	if(ttyfd == -1)
+	{
+		return 1;
+	}
+
+	if(dup2(ttyfd, STDIN_FILENO) == -1)
+	{
+		close(ttyfd);
+		return 1;
+	}
+
+	if(ttyfd != STDIN_FILENO)
+	{
+		close(ttyfd);
+	}
+
+	clearerr(stdin);
+	return 0;
+}
+
 FILE *
 read_cmd_output(const char cmd[])
 {
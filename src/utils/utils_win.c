@@ -772,6 +772,12 @@ reopen_terminal(void)
 	return fp;
 }
 
+int
+reopen_term_stdin(void)
+{
+	return freopen("CONIN$", "r", stdin) == NULL;
+}
+
 FILE *
 read_cmd_output(const char cmd[])
 {
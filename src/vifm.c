@@ -27,7 +27,7 @@
 
 #include <curses.h>
 
-#include <unistd.h> /* getcwd() */
+#include <unistd.h> /* STDIN_FILENO getcwd() isatty() */
 
 #include <errno.h> /* errno */
 #include <locale.h> /* setlocale */
@@ -55,6 +55,7 @@
 #include "utils/macros.h"
 #include "utils/path.h"
 #include "utils/str.h"
+#include "utils/string_array.h"
 #include "utils/utils.h"
 #include "args.h"
 #include "background.h"
@@ -92,6 +93,9 @@ static int undo_perform_func(OPS op, void *data, const char src[],
 static void parse_received_arguments(char *args[]);
 static void remote_cd(FileView *view, const char *path, int handle);
 static void check_path_for_file(FileView *view, const char path[], int handle);
+static int take_stdin_path(char path[], const char dir[]);
+static void load_file_list(FileView *view, const char dir[], char *files[],
+		int nfiles);
 static int need_to_switch_active_pane(const char lwin_path[],
 		const char rwin_path[]);
 static void load_scheme(void);
@@ -112,6 +116,9 @@ main(int argc, char *argv[])
 
 	char dir[PATH_MAX];
 	int old_config;
+	char **stdin_files = NULL;
+	int nstdin_files = 0;
+	int lwin_stdin, rwin_stdin;
 
 	if(getcwd(dir, sizeof(dir)) == NULL)
 	{
@@ -126,6 +133,26 @@ main(int argc, char *argv[])
 	args_parse(&vifm_args, argc, argv, dir);
 	args_process(&vifm_args, 1);
 
+	/* List of files passed via a pipe must be read before terminal is set up. */
+	lwin_stdin = take_stdin_path(vifm_args.lwin_path, dir);
+	rwin_stdin = take_stdin_path(vifm_args.rwin_path, dir);
+	if(lwin_stdin || rwin_stdin)
+	{
+		/* Otherwise reading below would wait for user to type in the list. */
+		if(isatty(STDIN_FILENO))
+		{
+			puts("\"-\" requires list of files to be piped into standard input.");
+			return -1;
+		}
+
+		stdin_files = read_stream_lines(stdin, &nstdin_files);
+		if(reopen_term_stdin() != 0)
+		{
+			puts("Failed to open terminal for input.");
+			return -1;
+		}
+	}
+
 	(void)setlocale(LC_ALL, "");
 
 	cfg_init();
@@ -254,6 +281,16 @@ main(int argc, char *argv[])
 	check_path_for_file(&lwin, vifm_args.lwin_path, vifm_args.lwin_handle);
 	check_path_for_file(&rwin, vifm_args.rwin_path, vifm_args.rwin_handle);
 
+	if(lwin_stdin)
+	{
+		load_file_list(&lwin, dir, stdin_files, nstdin_files);
+	}
+	if(rwin_stdin)
+	{
+		load_file_list(&rwin, dir, stdin_files, nstdin_files);
+	}
+	free_string_array(stdin_files, nstdin_files);
+
 	curr_stats.load_stage = 2;
 
 	exec_startup_commands(&vifm_args);
@@ -419,6 +456,58 @@ check_path_for_file(FileView *view, const char path[], int handle)
 	}
 }
 
+/* Replaces "-" path, which requests reading list of files from standard input,
+ * with the dir.  Returns non-zero if the replacement took place, otherwise zero
+ * is returned. */
+static int
+take_stdin_path(char path[], const char dir[])
+{
+	if(strcmp(path, "-") != 0)
+	{
+		return 0;
+	}
+
+	copy_str(path, PATH_MAX, dir);
+	return 1;
+}
+
+/* Displays files from the list in the view as a custom view.  Relative paths
+ * are resolved against the dir. */
+static void
+load_file_list(FileView *view, const char dir[], char *files[], int nfiles)
+{
+	int i;
+
+	flist_custom_start(view, "-");
+
+	for(i = 0; i < nfiles; ++i)
+	{
+		char path[PATH_MAX];
+
+		/* Skip empty lines. */
+		if(files[i][0] == '\0')
+		{
+			continue;
+		}
+
+		if(is_path_absolute(files[i]))
+		{
+			copy_str(path, sizeof(path), files[i]);
+		}
+		else
+		{
+			snprintf(path, sizeof(path), "%s/%s", dir, files[i]);
+		}
+
+		flist_custom_add(view, path);
+	}
+
+	if(flist_custom_finish(view) == 0)
+	{
+		view->list_pos = 0;
+	}
+}
+
 /* Decides whether active view should be switched based on paths provided for
  * panes on the command-line.  Returns non-zero if so, otherwise zero is
  * returned. */
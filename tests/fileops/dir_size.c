@@ -0,0 +1,133 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* stat lstat() mkdir() */
+#include <unistd.h> /* rmdir() unlink() */
+#include <utime.h> /* utimbuf utime() */
+
+#include <stdint.h> /* uint64_t */
+#include <stdio.h> /* FILE fclose() fopen() fwrite() */
+#include <time.h> /* time() */
+
+#include "../../src/cfg/config.h"
+#include "../../src/utils/tree.h"
+#include "../../src/fileops.h"
+#include "../../src/status.h"
+
+#define SANDBOX "test-data/sandbox"
+
+static void make_file(const char path[], size_t size);
+static void set_mtime_in_past(const char path[], int age);
+
+SETUP()
+{
+	curr_stats.dirsize_cache = tree_create(0, 1);
+	tree_set_canonical(curr_stats.dirsize_cache, 1);
+	cfg.io_threads = 4;
+
+	assert_success(mkdir(SANDBOX "/dir", 0700));
+	assert_success(mkdir(SANDBOX "/dir/sub", 0700));
+	make_file(SANDBOX "/dir/file", 10);
+	make_file(SANDBOX "/dir/sub/file", 100);
+	set_mtime_in_past(SANDBOX "/dir/sub", 100);
+}
+
+TEARDOWN()
+{
+	(void)unlink(SANDBOX "/dir/sub/new");
+	assert_success(unlink(SANDBOX "/dir/sub/file"));
+	assert_success(unlink(SANDBOX "/dir/file"));
+	assert_success(rmdir(SANDBOX "/dir/sub"));
+	assert_success(rmdir(SANDBOX "/dir"));
+
+	tree_free(curr_stats.dirsize_cache);
+	curr_stats.dirsize_cache = NULL_TREE;
+}
+
+TEST(sizes_of_files_and_subdirectories_are_summed_up)
+{
+	uint64_t size = 0U;
+
+	assert_int_equal(110, calc_dirsize(SANDBOX "/dir", 0));
+
+	dcache_get_size(SANDBOX "/dir/sub", &size);
+	assert_int_equal(100, size);
+	dcache_get_size(SANDBOX "/dir", &size);
+	assert_int_equal(110, size);
+}
+
+TEST(sizes_are_same_for_any_number_of_threads)
+{
+	cfg.io_threads = 1;
+	assert_int_equal(110, calc_dirsize(SANDBOX "/dir", 1));
+	cfg.io_threads = 8;
+	assert_int_equal(110, calc_dirsize(SANDBOX "/dir", 1));
+}
+
+TEST(valid_cached_size_of_subdirectory_is_used)
+{
+	struct stat st;
+	assert_success(lstat(SANDBOX "/dir/sub", &st));
+
+	dcache_set_size(SANDBOX "/dir/sub", 1000, st.st_mtime, st.st_ino);
+	assert_int_equal(1010, calc_dirsize(SANDBOX "/dir", 0));
+}
+
+TEST(cached_size_of_replaced_subdirectory_is_not_used)
+{
+	struct stat st;
+	assert_success(lstat(SANDBOX "/dir/sub", &st));
+
+	dcache_set_size(SANDBOX "/dir/sub", 1000, st.st_mtime, st.st_ino + 1);
+	assert_int_equal(110, calc_dirsize(SANDBOX "/dir", 0));
+}
+
+TEST(forced_calculation_ignores_cached_sizes)
+{
+	assert_int_equal(110, calc_dirsize(SANDBOX "/dir", 0));
+
+	make_file(SANDBOX "/dir/sub/file", 200);
+	assert_int_equal(210, calc_dirsize(SANDBOX "/dir", 1));
+}
+
+TEST(changed_subdirectory_is_recalculated)
+{
+	assert_int_equal(110, calc_dirsize(SANDBOX "/dir", 0));
+
+	make_file(SANDBOX "/dir/sub/new", 5);
+	set_mtime_in_past(SANDBOX "/dir/sub", 50);
+	assert_int_equal(115, calc_dirsize(SANDBOX "/dir", 0));
+}
+
+TEST(recently_changed_subdirectory_is_recalculated)
+{
+	make_file(SANDBOX "/dir/sub/new", 5);
+	assert_int_equal(115, calc_dirsize(SANDBOX "/dir", 0));
+
+	make_file(SANDBOX "/dir/sub/new", 50);
+	assert_int_equal(160, calc_dirsize(SANDBOX "/dir", 0));
+}
+
+/* Creates file of specified size or truncates and fills existing one. */
+static void
+make_file(const char path[], size_t size)
+{
+	static const char data[256];
+
+	FILE *const f = fopen(path, "wb");
+	assert_non_null(f);
+	assert_int_equal(size, fwrite(data, 1, size, f));
+	fclose(f);
+}
+
+/* Sets modification time of a file to be age seconds ago. */
+static void
+set_mtime_in_past(const char path[], int age)
+{
+	struct utimbuf times;
+	times.actime = time(NULL) - age;
+	times.modtime = time(NULL) - age;
+	assert_success(utime(path, &times));
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
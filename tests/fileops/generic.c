@@ -1,12 +1,17 @@
 #include <stic.h>
 
-#include <unistd.h> /* unlink() */
+#include <sys/stat.h> /* mkdir() */
+#include <unistd.h> /* rmdir() unlink() usleep() */
 
-#include <stdlib.h> /* calloc() free() */
-#include <string.h> /* strcpy() strdup() */
+#include <stdlib.h> /* calloc() free() realloc() */
+#include <stdio.h> /* FILE fclose() fopen() snprintf() */
+#include <string.h> /* memset() strcpy() strdup() */
 
+#include "../../src/cfg/config.h"
 #include "../../src/utils/fs.h"
+#include "../../src/utils/fs_limits.h"
 #include "../../src/utils/macros.h"
+#include "../../src/background.h"
 #include "../../src/fileops.h"
 
 SETUP()
@@ -61,5 +66,50 @@ TEST(move_file)
 	(void)unlink(new_fname);
 }
 
+TEST(files_are_copied_by_several_threads_in_background)
+{
+	int i;
+
+	lwin.dir_entry = realloc(lwin.dir_entry, sizeof(*lwin.dir_entry)*3);
+	lwin.list_rows = 3;
+	memset(&lwin.dir_entry[1], 0, sizeof(*lwin.dir_entry)*2);
+	lwin.dir_entry[1].name = strdup("file2");
+	lwin.dir_entry[1].origin = &lwin.curr_dir[0];
+	lwin.dir_entry[2].name = strdup("file3");
+	lwin.dir_entry[2].origin = &lwin.curr_dir[0];
+
+	assert_success(mkdir("dst", 0700));
+	strcpy(rwin.curr_dir, "dst");
+
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		FILE *const f = fopen(lwin.dir_entry[i].name, "w");
+		fclose(f);
+		lwin.dir_entry[i].marked = 1;
+	}
+
+	lwin.column_count = 1;
+	cfg.io_threads = 2;
+	assert_success(cpmv_files_bg(&lwin, NULL, 0, 0, 0));
+	while(bg_has_active_jobs())
+	{
+		usleep(5000);
+	}
+
+	assert_true(path_exists("dst/file", NODEREF));
+	assert_true(path_exists("dst/file2", NODEREF));
+	assert_true(path_exists("dst/file3", NODEREF));
+	assert_false(is_symlink("dst/file"));
+
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "dst/%s", lwin.dir_entry[i].name);
+		assert_success(unlink(path));
+		assert_success(unlink(lwin.dir_entry[i].name));
+	}
+	assert_success(rmdir("dst"));
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
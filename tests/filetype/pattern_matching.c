@@ -0,0 +1,79 @@
+#include <stic.h>
+
+#include <stdlib.h> /* free() */
+
+#include "../../src/filetype.h"
+
+TEST(extension_is_matched_case_insensitively)
+{
+	ft_set_viewers("*.TXT", "viewer");
+
+	assert_string_equal("viewer", ft_get_viewer("file.txt"));
+	assert_string_equal("viewer", ft_get_viewer("FILE.Txt"));
+	assert_null(ft_get_viewer("file.txt.bak"));
+	assert_null(ft_get_viewer("filetxt"));
+}
+
+TEST(extension_does_not_match_dot_files)
+{
+	ft_set_viewers("*.txt", "viewer");
+
+	assert_null(ft_get_viewer(".txt"));
+	assert_null(ft_get_viewer(".file.txt"));
+	assert_string_equal("viewer", ft_get_viewer("a.txt"));
+}
+
+TEST(compound_extension_is_matched_at_any_dot)
+{
+	ft_set_viewers("*.tar.gz", "tar-viewer");
+	ft_set_viewers("*.gz", "gz-viewer");
+
+	assert_string_equal("tar-viewer", ft_get_viewer("a.b.tar.gz"));
+	assert_string_equal("gz-viewer", ft_get_viewer("a.gz"));
+}
+
+TEST(order_of_associations_is_preserved)
+{
+	assoc_records_t records;
+
+	ft_set_viewers("*.gz", "first");
+	ft_set_viewers("*.[gG]z", "second");
+	ft_set_viewers("*.tar.gz,*.gz", "third");
+	ft_set_viewers("*", "fourth");
+	ft_set_viewers("*.bz2", "fifth");
+
+	records = ft_get_all_viewers("file.tar.gz");
+	assert_int_equal(4, records.count);
+	if(records.count == 4)
+	{
+		assert_string_equal("first", records.list[0].command);
+		assert_string_equal("second", records.list[1].command);
+		assert_string_equal("third", records.list[2].command);
+		assert_string_equal("fourth", records.list[3].command);
+	}
+	ft_assoc_records_free(&records);
+}
+
+TEST(mixed_list_of_globals_is_matched)
+{
+	ft_set_viewers("*.c,Makefile,*.[ch]pp", "viewer");
+
+	assert_string_equal("viewer", ft_get_viewer("main.c"));
+	assert_string_equal("viewer", ft_get_viewer("Makefile"));
+	assert_string_equal("viewer", ft_get_viewer("main.cpp"));
+	assert_string_equal("viewer", ft_get_viewer("main.hpp"));
+	assert_null(ft_get_viewer("main.h"));
+}
+
+TEST(associations_added_after_lookup_are_found)
+{
+	ft_set_viewers("*.a", "a-viewer");
+	assert_null(ft_get_viewer("file.b"));
+
+	ft_set_viewers("*.b", "b-viewer");
+	assert_string_equal("b-viewer", ft_get_viewer("file.b"));
+	assert_string_equal("a-viewer", ft_get_viewer("file.a"));
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -1,5 +1,6 @@
 #include <stic.h>
 
+#include <stdio.h> /* sprintf() */
 #include <string.h>
 #include <stdlib.h>
 
@@ -49,5 +50,65 @@ TEST(empty_value_not_appended)
 	filter_dispose(&filter);
 }
 
+TEST(many_names_can_be_appended)
+{
+	int i;
+	char name[32];
+
+	filter_t filter;
+	assert_int_equal(0, filter_init(&filter, 1));
+
+	for(i = 0; i < 10000; ++i)
+	{
+		sprintf(name, "file%d.", i);
+		assert_int_equal(0, filter_append(&filter, name));
+	}
+
+	assert_true(filter_matches(&filter, "file0."));
+	assert_true(filter_matches(&filter, "file9999."));
+	assert_false(filter_matches(&filter, "file10000."));
+	assert_false(filter_matches(&filter, "file0x"));
+
+	filter_dispose(&filter);
+}
+
+TEST(appended_names_are_restored_from_raw_value)
+{
+	filter_t filter, copy;
+	assert_int_equal(0, filter_init(&filter, 1));
+	assert_int_equal(0, filter_init(&copy, 1));
+
+	assert_int_equal(0, filter_append(&filter, "a.c"));
+	assert_int_equal(0, filter_append(&filter, "dir/"));
+	assert_int_equal(0, filter_append(&filter, "(x|y)\\"));
+
+	assert_int_equal(0, filter_set(&copy, filter.raw));
+	assert_true(filter_matches(&copy, "a.c"));
+	assert_true(filter_matches(&copy, "dir/"));
+	assert_true(filter_matches(&copy, "(x|y)\\"));
+	assert_false(filter_matches(&copy, "abc"));
+	assert_false(filter_matches(&copy, "dir"));
+	assert_false(filter_matches(&copy, "x"));
+
+	filter_dispose(&copy);
+	filter_dispose(&filter);
+}
+
+TEST(appended_names_respect_case_sensitivity)
+{
+	filter_t filter;
+	assert_int_equal(0, filter_init(&filter, 0));
+
+	assert_int_equal(0, filter_append(&filter, "Name"));
+	assert_true(filter_matches(&filter, "name"));
+	assert_true(filter_matches(&filter, "NAME"));
+
+	assert_int_equal(0, filter_change(&filter, filter.raw, 1));
+	assert_true(filter_matches(&filter, "Name"));
+	assert_false(filter_matches(&filter, "name"));
+
+	filter_dispose(&filter);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
@@ -4,6 +4,9 @@
 #include <sys/stat.h> /* stat */
 #include <unistd.h> /* lstat() */
 
+#include <stddef.h> /* size_t */
+#include <stdio.h> /* FILE fclose() fopen() fputc() */
+
 #include "../../src/compat/os.h"
 #include "../../src/io/iop.h"
 #include "../../src/utils/fs.h"
@@ -12,7 +15,12 @@
 
 #include "utils.h"
 
+/* Size of a file that needs several chunks to be copied via a buffer. */
+#define BIG_FILE_SIZE (3*1024*1024 + 17)
+
+static void create_big_file(const char name[], size_t size);
 static int not_windows(void);
+static int has_proc(void);
 
 TEST(dir_is_not_copied)
 {
@@ -196,6 +204,68 @@ TEST(appending_does_not_shrink_files)
 	}
 }
 
+TEST(big_file_is_copied)
+{
+	create_big_file("big", BIG_FILE_SIZE);
+	file_is_copied("big");
+	delete_test_file("big");
+}
+
+TEST(big_file_is_appended_to_its_beginning)
+{
+	create_big_file("big", BIG_FILE_SIZE);
+	create_big_file("partial", BIG_FILE_SIZE/2);
+
+	{
+		io_args_t args = {
+			.arg1.src = "big",
+			.arg2.dst = "partial",
+			.arg3.crs = IO_CRS_APPEND_TO_FILES,
+		};
+		assert_int_equal(0, iop_cp(&args));
+	}
+
+	assert_int_equal(BIG_FILE_SIZE, get_file_size("partial"));
+	assert_true(files_are_identical("big", "partial"));
+
+	delete_test_file("big");
+	delete_test_file("partial");
+}
+
+/* Files of /proc report zero size, which makes the kernel copy nothing. */
+TEST(file_with_misreported_size_is_copied, IF(has_proc))
+{
+	{
+		io_args_t args = {
+			.arg1.src = "/proc/version",
+			.arg2.dst = "version",
+		};
+		assert_int_equal(0, iop_cp(&args));
+	}
+
+	assert_true(get_file_size("version") > 0);
+	assert_true(files_are_identical("/proc/version", "version"));
+
+	delete_test_file("version");
+}
+
+/* Some files of /proc can't be copied by the kernel at all. */
+TEST(file_is_copied_via_buffer_if_kernel_refuses_to_copy_it, IF(has_proc))
+{
+	{
+		io_args_t args = {
+			.arg1.src = "/proc/self/limits",
+			.arg2.dst = "limits",
+		};
+		assert_int_equal(0, iop_cp(&args));
+	}
+
+	assert_true(get_file_size("limits") > 0);
+	assert_true(files_are_identical("/proc/self/limits", "limits"));
+
+	delete_test_file("limits");
+}
+
 /* Windows doesn't support Unix-style permissions. */
 TEST(file_permissions_are_preserved, IF(not_windows))
 {
@@ -306,11 +376,35 @@ TEST(dir_symlink_copy_is_symlink, IF(not_windows))
 	}
 }
 
+/* Creates file of specified size, whose contents depend on position, so files
+ * created by this function are prefixes of each other. */
+static void
+create_big_file(const char name[], size_t size)
+{
+	size_t i;
+	FILE *const f = fopen(name, "wb");
+	assert_non_null(f);
+
+	for(i = 0U; i < size; ++i)
+	{
+		fputc((i*31U + i/256U)%256U, f);
+	}
+
+	fclose(f);
+}
+
 static int
 not_windows(void)
 {
 	return get_env_type() != ET_WIN;
 }
 
+static int
+has_proc(void)
+{
+	return is_regular_file("/proc/version")
+	    && get_file_size("/proc/version") == 0;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
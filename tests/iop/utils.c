@@ -46,7 +46,7 @@ files_are_identical(const char a[], const char b[])
 		a_data = fgetc(a_file);
 		b_data = fgetc(b_file);
 	}
-	while(a_data != EOF && b_data != EOF);
+	while(a_data == b_data && a_data != EOF);
 
 	fclose(b_file);
 	fclose(a_file);
@@ -0,0 +1,113 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* mkdir() */
+#include <unistd.h> /* chdir() getcwd() rmdir() unlink() */
+
+#include <stdio.h> /* FILE fclose() fopen() snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* memset() strdup() */
+
+#include "../../src/cfg/config.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/filter.h"
+#include "../../src/utils/fs_limits.h"
+#include "../../src/utils/utils.h"
+#include "../../src/filelist.h"
+#include "../../src/filtering.h"
+
+#define SANDBOX "test-data/sandbox/big"
+
+/* Large enough to make list of entries grow several times. */
+#define FILE_COUNT 1000
+
+static void make_file_name(int i, char buf[], size_t buf_len);
+
+static char cwd[PATH_MAX];
+
+SETUP()
+{
+	int i;
+
+	assert_non_null(getcwd(cwd, sizeof(cwd)));
+	assert_success(mkdir(SANDBOX, 0700));
+
+	for(i = 0; i < FILE_COUNT; ++i)
+	{
+		char name[PATH_MAX];
+		FILE *f;
+
+		make_file_name(i, name, sizeof(name));
+		f = fopen(name, "w");
+		assert_non_null(f);
+		fclose(f);
+	}
+
+	cfg.fuse_home = strdup("no");
+	cfg.dot_dirs = 0;
+
+	filter_init(&lwin.manual_filter, FILTER_DEF_CASE_SENSITIVITY);
+	filter_init(&lwin.auto_filter, FILTER_DEF_CASE_SENSITIVITY);
+	filter_init(&lwin.local_filter.filter, FILTER_DEF_CASE_SENSITIVITY);
+
+	lwin.list_rows = 0;
+	lwin.dir_entry = NULL;
+	lwin.sort[0] = SK_BY_NAME;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+	snprintf(lwin.curr_dir, sizeof(lwin.curr_dir), "%s/%s", cwd, SANDBOX);
+}
+
+TEARDOWN()
+{
+	int i;
+
+	assert_success(chdir(cwd));
+
+	for(i = 0; i < FILE_COUNT; ++i)
+	{
+		char name[PATH_MAX];
+		make_file_name(i, name, sizeof(name));
+		assert_success(unlink(name));
+	}
+	assert_success(rmdir(SANDBOX));
+
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		free(lwin.dir_entry[i].name);
+	}
+	free(lwin.dir_entry);
+	lwin.dir_entry = NULL;
+	lwin.list_rows = 0;
+
+	filter_dispose(&lwin.manual_filter);
+	filter_dispose(&lwin.auto_filter);
+	filter_dispose(&lwin.local_filter.filter);
+
+	free(cfg.fuse_home);
+	cfg.fuse_home = NULL;
+}
+
+TEST(all_files_of_big_directory_are_loaded_in_order)
+{
+	int i;
+
+	load_dir_list(&lwin, 1);
+
+	assert_int_equal(FILE_COUNT, lwin.list_rows);
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		char name[PATH_MAX];
+		snprintf(name, sizeof(name), "file%04d", i);
+		assert_string_equal(name, lwin.dir_entry[i].name);
+		assert_true(lwin.dir_entry[i].type == FT_REG);
+	}
+}
+
+/* Formats path to i-th file in the sandbox. */
+static void
+make_file_name(int i, char buf[], size_t buf_len)
+{
+	snprintf(buf, buf_len, "%s/file%04d", SANDBOX, i);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
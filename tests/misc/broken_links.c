@@ -0,0 +1,109 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* mkdir() */
+#include <unistd.h> /* chdir() getcwd() rmdir() symlink() unlink() */
+
+#include <stdio.h> /* FILE fclose() fopen() snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* memset() strdup() */
+
+#include "../../src/cfg/config.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/filter.h"
+#include "../../src/utils/fs_limits.h"
+#include "../../src/filelist.h"
+#include "../../src/filtering.h"
+
+#define SANDBOX "test-data/sandbox/links"
+
+static int not_windows(void);
+
+static char cwd[PATH_MAX];
+
+SETUP()
+{
+	assert_non_null(getcwd(cwd, sizeof(cwd)));
+	assert_success(mkdir(SANDBOX, 0700));
+
+	cfg.fuse_home = strdup("no");
+	cfg.slow_fs_list = strdup("");
+	cfg.dot_dirs = 0;
+
+	filter_init(&lwin.manual_filter, FILTER_DEF_CASE_SENSITIVITY);
+	filter_init(&lwin.auto_filter, FILTER_DEF_CASE_SENSITIVITY);
+	filter_init(&lwin.local_filter.filter, FILTER_DEF_CASE_SENSITIVITY);
+
+	lwin.list_rows = 0;
+	lwin.dir_entry = NULL;
+	lwin.sort[0] = SK_BY_NAME;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+	snprintf(lwin.curr_dir, sizeof(lwin.curr_dir), "%s/%s", cwd, SANDBOX);
+}
+
+TEARDOWN()
+{
+	int i;
+
+	assert_success(chdir(cwd));
+	assert_success(rmdir(SANDBOX));
+
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		free(lwin.dir_entry[i].name);
+	}
+	free(lwin.dir_entry);
+	lwin.dir_entry = NULL;
+	lwin.list_rows = 0;
+
+	filter_dispose(&lwin.manual_filter);
+	filter_dispose(&lwin.auto_filter);
+	filter_dispose(&lwin.local_filter.filter);
+
+	free(cfg.slow_fs_list);
+	cfg.slow_fs_list = NULL;
+	free(cfg.fuse_home);
+	cfg.fuse_home = NULL;
+}
+
+TEST(state_of_links_is_determined_on_loading, IF(not_windows))
+{
+	FILE *const f = fopen(SANDBOX "/file", "w");
+	assert_non_null(f);
+	fclose(f);
+
+	assert_success(symlink("file", SANDBOX "/good"));
+	assert_success(symlink("no-file", SANDBOX "/bad"));
+
+	load_dir_list(&lwin, 1);
+
+	assert_int_equal(3, lwin.list_rows);
+
+	assert_string_equal("bad", lwin.dir_entry[0].name);
+	assert_true(lwin.dir_entry[0].type == FT_LINK);
+	assert_true(lwin.dir_entry[0].broken_link);
+
+	assert_string_equal("file", lwin.dir_entry[1].name);
+	assert_false(lwin.dir_entry[1].broken_link);
+
+	assert_string_equal("good", lwin.dir_entry[2].name);
+	assert_true(lwin.dir_entry[2].type == FT_LINK);
+	assert_false(lwin.dir_entry[2].broken_link);
+
+	assert_success(chdir(cwd));
+	assert_success(unlink(SANDBOX "/bad"));
+	assert_success(unlink(SANDBOX "/good"));
+	assert_success(unlink(SANDBOX "/file"));
+}
+
+static int
+not_windows(void)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
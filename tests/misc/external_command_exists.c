@@ -1,6 +1,21 @@
 #include <stic.h>
 
+#include <sys/stat.h> /* chmod() */
+#include <unistd.h> /* getcwd() unlink() */
+
+#include <stdio.h> /* FILE fclose() fopen() snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* strdup() */
+
+#include "../../src/utils/env.h"
+#include "../../src/utils/fs_limits.h"
 #include "../../src/commands_completion.h"
+#include "../../src/path_env.h"
+
+#define SANDBOX "test-data/sandbox"
+
+static void create_file(const char path[], int mode);
+static int not_windows(void);
 
 TEST(system_shell_exists)
 {
@@ -13,5 +28,56 @@ TEST(system_shell_exists)
 	assert_true(exists);
 }
 
+TEST(only_executables_from_path_exist, IF(not_windows))
+{
+	char cwd[PATH_MAX];
+	char path[PATH_MAX];
+	char *const saved_path = strdup(env_get("PATH"));
+
+	assert_non_null(getcwd(cwd, sizeof(cwd)));
+	snprintf(path, sizeof(path), "%s/" SANDBOX, cwd);
+	env_set("PATH", path);
+	update_path_env(1);
+
+	create_file(SANDBOX "/exe", 0700);
+	create_file(SANDBOX "/data", 0600);
+
+	assert_true(external_command_exists("exe"));
+	assert_false(external_command_exists("data"));
+	assert_false(external_command_exists("none"));
+
+	/* Second time answers come from the cache. */
+	assert_true(external_command_exists("exe"));
+	assert_false(external_command_exists("data"));
+	assert_false(external_command_exists("none"));
+
+	assert_success(unlink(SANDBOX "/exe"));
+	assert_success(unlink(SANDBOX "/data"));
+
+	env_set("PATH", saved_path);
+	update_path_env(1);
+	free(saved_path);
+}
+
+/* Creates empty file at the path with the specified mode. */
+static void
+create_file(const char path[], int mode)
+{
+	FILE *const f = fopen(path, "w");
+	assert_non_null(f);
+	fclose(f);
+	assert_success(chmod(path, mode));
+}
+
+static int
+not_windows(void)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	return 1;
+#endif
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
@@ -62,6 +62,27 @@ TEST(duplicates_are_not_added)
 	assert_int_equal(1, lwin.list_rows);
 }
 
+TEST(duplicates_are_detected_by_canonical_path)
+{
+	flist_custom_start(&lwin, "test");
+	flist_custom_add(&lwin, "test-data/existing-files/a");
+	flist_custom_add(&lwin, "test-data/existing-files/../existing-files/a");
+	flist_custom_add(&lwin, "test-data/existing-files/./b");
+	flist_custom_add(&lwin, "test-data/existing-files/b");
+	assert_true(flist_custom_finish(&lwin) == 0);
+	assert_int_equal(2, lwin.list_rows);
+}
+
+TEST(nonexistent_files_are_skipped)
+{
+	flist_custom_start(&lwin, "test");
+	flist_custom_add(&lwin, "test-data/existing-files/no-such-file");
+	flist_custom_add(&lwin, "test-data/existing-files/c");
+	assert_true(flist_custom_finish(&lwin) == 0);
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("c", lwin.dir_entry[0].name);
+}
+
 TEST(custom_view_replaces_custom_view_fine)
 {
 	assert_false(flist_custom_active(&lwin));
@@ -117,5 +138,38 @@ TEST(locally_filtered_files_are_not_lost_on_reload)
 	assert_int_equal(1, lwin.filtered);
 }
 
+TEST(local_filter_can_be_narrowed_and_widened)
+{
+	filters_view_reset(&lwin);
+
+	flist_custom_start(&lwin, "test");
+	flist_custom_add(&lwin, "test-data/existing-files/a");
+	flist_custom_add(&lwin, "test-data/existing-files/b");
+	flist_custom_add(&lwin, "test-data/existing-files/c");
+	assert_true(flist_custom_finish(&lwin) == 0);
+
+	local_filter_set(&lwin, "");
+	assert_int_equal(3, lwin.list_rows);
+
+	local_filter_set(&lwin, "b");
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("b", lwin.dir_entry[0].name);
+
+	local_filter_set(&lwin, "");
+	assert_int_equal(3, lwin.list_rows);
+
+	local_filter_set(&lwin, "[ac]");
+	assert_int_equal(2, lwin.list_rows);
+
+	local_filter_set(&lwin, "[ac]|b");
+	assert_int_equal(3, lwin.list_rows);
+
+	local_filter_set(&lwin, "c");
+	local_filter_accept(&lwin);
+	assert_int_equal(1, lwin.list_rows);
+	assert_int_equal(2, lwin.filtered);
+	assert_string_equal("c", lwin.dir_entry[0].name);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
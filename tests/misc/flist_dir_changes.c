@@ -0,0 +1,255 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* mkdir() */
+#include <unistd.h> /* chdir() getcwd() rmdir() unlink() */
+
+#include <stdio.h> /* FILE fclose() fopen() fputs() remove() rename()
+                      snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* memset() strdup() */
+
+#include "../../src/cfg/config.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/filemon.h"
+#include "../../src/utils/filter.h"
+#include "../../src/utils/fs_limits.h"
+#include "../../src/filelist.h"
+#include "../../src/filtering.h"
+#include "../../src/status.h"
+
+#define SANDBOX "test-data/sandbox/changes"
+
+static void append_to_file(const char name[]);
+static void check_for_changes(void);
+static int is_linux(void);
+
+static char cwd[PATH_MAX];
+
+SETUP()
+{
+	assert_non_null(getcwd(cwd, sizeof(cwd)));
+	assert_success(mkdir(SANDBOX, 0700));
+	append_to_file("a");
+	append_to_file("b");
+	append_to_file(".hidden");
+
+	cfg.fuse_home = strdup("no");
+	cfg.dot_dirs = 0;
+
+	curr_view = &lwin;
+	other_view = &rwin;
+	curr_stats.number_of_windows = 2;
+
+	filter_init(&lwin.manual_filter, FILTER_DEF_CASE_SENSITIVITY);
+	filter_init(&lwin.auto_filter, FILTER_DEF_CASE_SENSITIVITY);
+	filter_init(&lwin.local_filter.filter, FILTER_DEF_CASE_SENSITIVITY);
+
+	lwin.hide_dot = 1;
+	lwin.list_rows = 0;
+	lwin.dir_entry = NULL;
+	lwin.sort[0] = SK_BY_NAME;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+	snprintf(lwin.curr_dir, sizeof(lwin.curr_dir), "%s/%s", cwd, SANDBOX);
+
+	load_dir_list(&lwin, 0);
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(1, lwin.filtered);
+
+	/* This sets up watcher of the directory. */
+	check_if_filelist_have_changed(&lwin);
+
+	/* Loading changes current directory. */
+	assert_success(chdir(cwd));
+}
+
+TEARDOWN()
+{
+	int i;
+
+	assert_success(chdir(cwd));
+
+	(void)remove(SANDBOX "/a");
+	(void)remove(SANDBOX "/b");
+	(void)remove(SANDBOX "/c");
+	(void)remove(SANDBOX "/.hidden");
+	(void)remove(SANDBOX "/.new");
+	assert_success(rmdir(SANDBOX));
+
+	filemon_unwatch(lwin.dir_watcher);
+	lwin.dir_watcher = NULL;
+	lwin.watched_dir[0] = '\0';
+
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		free(lwin.dir_entry[i].name);
+	}
+	free(lwin.dir_entry);
+	lwin.dir_entry = NULL;
+	lwin.list_rows = 0;
+	lwin.filtered = 0;
+	lwin.hide_dot = 0;
+
+	filter_dispose(&lwin.manual_filter);
+	filter_dispose(&lwin.auto_filter);
+	filter_dispose(&lwin.local_filter.filter);
+
+	free(cfg.fuse_home);
+	cfg.fuse_home = NULL;
+
+	curr_view = NULL;
+	other_view = NULL;
+}
+
+TEST(created_visible_file_is_added, IF(is_linux))
+{
+	append_to_file("c");
+	check_for_changes();
+
+	assert_int_equal(3, lwin.list_rows);
+	assert_string_equal("a", lwin.dir_entry[0].name);
+	assert_string_equal("b", lwin.dir_entry[1].name);
+	assert_string_equal("c", lwin.dir_entry[2].name);
+	assert_int_equal(1, lwin.filtered);
+}
+
+TEST(modified_visible_file_is_updated, IF(is_linux))
+{
+	append_to_file("b");
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_string_equal("b", lwin.dir_entry[1].name);
+	assert_int_equal(8, lwin.dir_entry[1].size);
+	assert_int_equal(1, lwin.filtered);
+}
+
+TEST(deleted_visible_file_is_removed, IF(is_linux))
+{
+	assert_success(unlink(SANDBOX "/a"));
+	append_to_file("c");
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_string_equal("b", lwin.dir_entry[0].name);
+	assert_string_equal("c", lwin.dir_entry[1].name);
+	assert_int_equal(1, lwin.filtered);
+}
+
+TEST(created_filtered_file_is_counted, IF(is_linux))
+{
+	append_to_file(".new");
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(2, lwin.filtered);
+}
+
+TEST(modified_filtered_file_is_not_counted_again, IF(is_linux))
+{
+	append_to_file(".hidden");
+	check_for_changes();
+	append_to_file(".hidden");
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(1, lwin.filtered);
+}
+
+TEST(replaced_filtered_file_is_not_counted_again, IF(is_linux))
+{
+	append_to_file(".new");
+	assert_success(rename(SANDBOX "/.new", SANDBOX "/.hidden"));
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(1, lwin.filtered);
+}
+
+TEST(deleted_filtered_file_is_uncounted, IF(is_linux))
+{
+	assert_success(unlink(SANDBOX "/.hidden"));
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(0, lwin.filtered);
+}
+
+TEST(short_lived_filtered_file_is_not_counted, IF(is_linux))
+{
+	append_to_file(".new");
+	assert_success(unlink(SANDBOX "/.new"));
+	check_for_changes();
+
+	assert_int_equal(2, lwin.list_rows);
+	assert_int_equal(1, lwin.filtered);
+}
+
+TEST(filtered_files_are_counted_without_rescanning, IF(is_linux))
+{
+	/* Recounting would reset this to the actual number. */
+	lwin.filtered = 10;
+
+	append_to_file(".new");
+	check_for_changes();
+	assert_int_equal(11, lwin.filtered);
+
+	append_to_file(".hidden");
+	check_for_changes();
+	assert_int_equal(11, lwin.filtered);
+
+	assert_success(unlink(SANDBOX "/.new"));
+	check_for_changes();
+	assert_int_equal(10, lwin.filtered);
+
+	assert_success(unlink(SANDBOX "/b"));
+	check_for_changes();
+	assert_int_equal(10, lwin.filtered);
+}
+
+TEST(file_moved_in_is_counted_once, IF(is_linux))
+{
+	assert_success(rename(SANDBOX "/a", SANDBOX "/.new"));
+	check_for_changes();
+
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("b", lwin.dir_entry[0].name);
+	assert_int_equal(2, lwin.filtered);
+}
+
+/* Creates file in the sandbox or appends to it. */
+static void
+append_to_file(const char name[])
+{
+	char path[PATH_MAX];
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/%s/%s", cwd, SANDBOX, name);
+	f = fopen(path, "a");
+	assert_non_null(f);
+	fputs("text", f);
+	fclose(f);
+}
+
+/* Makes the view process changes of its directory. */
+static void
+check_for_changes(void)
+{
+	assert_non_null(lwin.dir_watcher);
+	check_if_filelist_have_changed(&lwin);
+
+	/* Processing changes current directory. */
+	assert_success(chdir(cwd));
+}
+
+static int
+is_linux(void)
+{
+#ifdef __linux__
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
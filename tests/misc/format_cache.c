@@ -0,0 +1,141 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* strdup() */
+
+#include "../../src/cfg/config.h"
+#include "../../src/engine/options.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/macros.h"
+#include "../../src/fileview.h"
+#include "../../src/opt_handlers.h"
+#include "../../src/sort.h"
+
+/* Large enough for values to be cached. */
+#define BUF_LEN 128
+
+/* String values of options that are taken from configuration as is, they need
+ * to be initialized for options to be set up. */
+static char **const str_opts[] = {
+	&cfg.apropos_prg, &cfg.cd_path, &cfg.find_prg, &cfg.fuse_home,
+	&cfg.grep_prg, &cfg.locate_prg, &cfg.ruler_format, &cfg.shell,
+	&cfg.slow_fs_list, &cfg.status_line, &cfg.vi_command, &cfg.vi_x_command,
+};
+
+SETUP()
+{
+	size_t i;
+
+	curr_view = &lwin;
+	other_view = &rwin;
+
+	for(i = 0U; i < ARRAY_LEN(str_opts); ++i)
+	{
+		*str_opts[i] = strdup("");
+	}
+	cfg.time_format = strdup(" %Y");
+
+	init_option_handlers();
+	fview_formatting_updated();
+}
+
+TEARDOWN()
+{
+	size_t i;
+
+	clear_options();
+
+	for(i = 0U; i < ARRAY_LEN(str_opts); ++i)
+	{
+		free(*str_opts[i]);
+		*str_opts[i] = NULL;
+	}
+	free(cfg.time_format);
+	cfg.time_format = NULL;
+
+	curr_view = NULL;
+	other_view = NULL;
+}
+
+TEST(cached_value_is_used)
+{
+	char buf[BUF_LEN];
+
+	fill_format_cache(SK_BY_SIZE, 10, sizeof(buf) - 1, " 10 B");
+	assert_true(use_format_cache(SK_BY_SIZE, 10, sizeof(buf) - 1, buf));
+	assert_string_equal(" 10 B", buf);
+}
+
+TEST(small_buffers_are_not_cached)
+{
+	char buf[BUF_LEN];
+
+	fill_format_cache(SK_BY_SIZE, 10, 4, " 10 B");
+	assert_false(use_format_cache(SK_BY_SIZE, 10, sizeof(buf) - 1, buf));
+
+	fill_format_cache(SK_BY_SIZE, 10, sizeof(buf) - 1, " 10 B");
+	assert_false(use_format_cache(SK_BY_SIZE, 10, 4, buf));
+}
+
+TEST(timefmt_change_invalidates_cache)
+{
+	char buf[BUF_LEN];
+
+	fill_format_cache(SK_BY_TIME_MODIFIED, 0, sizeof(buf) - 1, " 1970");
+	assert_true(use_format_cache(SK_BY_TIME_MODIFIED, 0, sizeof(buf) - 1, buf));
+
+	assert_success(set_options("timefmt=%m"));
+	assert_false(use_format_cache(SK_BY_TIME_MODIFIED, 0, sizeof(buf) - 1, buf));
+}
+
+TEST(iec_change_invalidates_cache)
+{
+	char buf[BUF_LEN];
+
+	fill_format_cache(SK_BY_SIZE, 2048, sizeof(buf) - 1, " 2 K");
+	assert_true(use_format_cache(SK_BY_SIZE, 2048, sizeof(buf) - 1, buf));
+
+	assert_success(set_options("iec"));
+	assert_false(use_format_cache(SK_BY_SIZE, 2048, sizeof(buf) - 1, buf));
+}
+
+TEST(different_values_do_not_collide)
+{
+	char buf[BUF_LEN];
+	char text[BUF_LEN];
+	int i;
+
+	/* There are more values than slots in the cache, so some of them share
+	 * slots. */
+	for(i = 0; i < 4096; ++i)
+	{
+		snprintf(text, sizeof(text), " %d", i);
+		fill_format_cache(SK_BY_SIZE, i, sizeof(buf) - 1, text);
+	}
+
+	for(i = 0; i < 4096; ++i)
+	{
+		if(use_format_cache(SK_BY_SIZE, i, sizeof(buf) - 1, buf))
+		{
+			snprintf(text, sizeof(text), " %d", i);
+			assert_string_equal(text, buf);
+		}
+	}
+}
+
+TEST(same_value_of_different_columns_do_not_collide)
+{
+	char buf[BUF_LEN];
+
+	fill_format_cache(SK_BY_OWNER_ID, 1000, sizeof(buf) - 1, " 1000");
+	assert_false(use_format_cache(SK_BY_OWNER_NAME, 1000, sizeof(buf) - 1, buf));
+	assert_false(use_format_cache(SK_BY_SIZE, 1000, sizeof(buf) - 1, buf));
+
+	fill_format_cache(SK_BY_OWNER_NAME, 1000, sizeof(buf) - 1, " user");
+	assert_true(use_format_cache(SK_BY_OWNER_NAME, 1000, sizeof(buf) - 1, buf));
+	assert_string_equal(" user", buf);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
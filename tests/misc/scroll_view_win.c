@@ -0,0 +1,191 @@
+#include <stic.h>
+
+#include <stdlib.h> /* calloc() free() */
+
+#include "../../src/cfg/config.h"
+#include "../../src/ui/ui.h"
+#include "../../src/column_view.h"
+#include "../../src/fileview.h"
+
+static void print_line(const void *data, int column_id, const char buf[],
+		size_t offset);
+
+static FileView *const view = &lwin;
+
+/* Number of cells of the list that were drawn. */
+static int ncells_drawn;
+
+SETUP()
+{
+	curr_view = &lwin;
+	other_view = &rwin;
+
+	cfg.filelist_col_padding = 0;
+	cfg.scroll_bind = 0;
+	columns_set_line_print_func(&print_line);
+
+	view->dir_entry = calloc(20, sizeof(*view->dir_entry));
+	view->list_rows = 20;
+	view->columns = columns_create();
+	view->ls_view = 0;
+	view->num_type = NT_NONE;
+	view->window_width = 40;
+	/* window_rows actually contains "number or rows - 1". */
+	view->window_rows = 8 - 1;
+	view->window_cells = view->window_rows + 1;
+
+	view->top_line = 0;
+	view->drawn_top = 0;
+	view->list_pos = 0;
+	view->curr_line = 0;
+}
+
+TEARDOWN()
+{
+	ncells_drawn = 0;
+
+	columns_free(view->columns);
+	view->columns = NULL_COLUMNS;
+	free(view->dir_entry);
+	view->dir_entry = NULL;
+	view->list_rows = 0;
+
+	columns_set_line_print_func(NULL);
+
+	curr_view = NULL;
+	other_view = NULL;
+}
+
+TEST(scrolling_down_draws_only_new_lines)
+{
+	view->top_line = 3;
+	view->list_pos = 10;
+
+	assert_true(scroll_view_win(view));
+	assert_int_equal(3, view->top_line);
+	assert_int_equal(3, view->drawn_top);
+	assert_int_equal(7, view->curr_line);
+	assert_int_equal(3, ncells_drawn);
+}
+
+TEST(scrolling_up_draws_only_new_lines)
+{
+	view->drawn_top = 10;
+	view->top_line = 8;
+	view->list_pos = 8;
+
+	assert_true(scroll_view_win(view));
+	assert_int_equal(8, view->top_line);
+	assert_int_equal(8, view->drawn_top);
+	assert_int_equal(0, view->curr_line);
+	assert_int_equal(2, ncells_drawn);
+}
+
+TEST(scrolling_to_the_end_of_the_list_is_done)
+{
+	view->drawn_top = 11;
+	view->top_line = 12;
+	view->list_pos = 19;
+
+	assert_true(scroll_view_win(view));
+	assert_int_equal(12, view->drawn_top);
+	assert_int_equal(7, view->curr_line);
+	assert_int_equal(1, ncells_drawn);
+}
+
+TEST(short_list_is_redrawn)
+{
+	view->list_rows = 6;
+	view->top_line = 1;
+	view->list_pos = 5;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(0, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+}
+
+TEST(list_is_redrawn_if_new_top_leaves_empty_lines)
+{
+	view->drawn_top = 10;
+	view->top_line = 13;
+	view->list_pos = 19;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(10, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+}
+
+TEST(list_is_redrawn_on_scrolling_by_whole_window)
+{
+	view->top_line = 8;
+	view->list_pos = 8;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(0, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+
+	view->drawn_top = 12;
+	view->top_line = 2;
+	view->list_pos = 2;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(12, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+}
+
+TEST(list_is_redrawn_if_it_was_not_drawn)
+{
+	view->drawn_top = -1;
+	view->top_line = 1;
+	view->list_pos = 8;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(-1, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+}
+
+TEST(list_with_relative_numbers_is_redrawn)
+{
+	view->num_type = NT_REL;
+	view->top_line = 1;
+	view->list_pos = 8;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(0, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+}
+
+TEST(list_is_redrawn_when_scrolling_is_bound)
+{
+	cfg.scroll_bind = 1;
+	view->top_line = 1;
+	view->list_pos = 8;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(0, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+
+	cfg.scroll_bind = 0;
+}
+
+TEST(inactive_view_is_redrawn)
+{
+	curr_view = &rwin;
+	view->top_line = 1;
+	view->list_pos = 8;
+
+	assert_false(scroll_view_win(view));
+	assert_int_equal(0, view->drawn_top);
+	assert_int_equal(0, ncells_drawn);
+}
+
+/* Print callback for column_view unit that counts drawn cells.  There are no
+ * columns, so each cell is drawn as a single gap. */
+static void
+print_line(const void *data, int column_id, const char buf[], size_t offset)
+{
+	++ncells_drawn;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
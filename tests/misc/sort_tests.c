@@ -7,6 +7,7 @@
 #include "../../src/cfg/config.h"
 #include "../../src/ui/ui.h"
 #include "../../src/utils/str.h"
+#include "../../src/filelist.h"
 #include "../../src/sort.h"
 
 #define SIGN(n) ({__typeof(n) _n = (n); (_n < 0) ? -1 : (_n > 0);})
@@ -33,7 +34,7 @@ TEARDOWN()
 
 	for(i = 0; i < lwin.list_rows; i++)
 	{
-		free(lwin.dir_entry[i].name);
+		free_dir_entry(&lwin, &lwin.dir_entry[i]);
 	}
 	free(lwin.dir_entry);
 
@@ -50,6 +51,57 @@ TEST(special_chars_ignore_case_sort)
 	assert_string_equal("_", lwin.dir_entry[0].name);
 }
 
+TEST(all_keys_are_taken_into_account)
+{
+	lwin.dir_entry[0].size = 2;
+	lwin.dir_entry[1].size = 1;
+	lwin.dir_entry[2].size = 2;
+
+	lwin.sort[0] = -SK_BY_SIZE;
+	lwin.sort[1] = SK_BY_NAME;
+	memset(&lwin.sort[2], SK_NONE, sizeof(lwin.sort) - 2);
+
+	sort_view(&lwin);
+
+	assert_string_equal("A", lwin.dir_entry[0].name);
+	assert_string_equal("a", lwin.dir_entry[1].name);
+	assert_string_equal("_", lwin.dir_entry[2].name);
+}
+
+TEST(equal_entries_keep_their_order)
+{
+	lwin.sort[0] = SK_BY_SIZE;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	sort_view(&lwin);
+
+	assert_string_equal("a", lwin.dir_entry[0].name);
+	assert_string_equal("_", lwin.dir_entry[1].name);
+	assert_string_equal("A", lwin.dir_entry[2].name);
+}
+
+TEST(renamed_entries_are_sorted_by_their_new_names)
+{
+	lwin.sort[0] = SK_BY_NAME;
+	memset(&lwin.sort[1], SK_NONE, sizeof(lwin.sort) - 1);
+
+	replace_string(&lwin.dir_entry[0].name, "f10");
+	replace_string(&lwin.dir_entry[1].name, "f9");
+	replace_string(&lwin.dir_entry[2].name, "f100");
+
+	sort_view(&lwin);
+	assert_string_equal("f9", lwin.dir_entry[0].name);
+	assert_string_equal("f10", lwin.dir_entry[1].name);
+	assert_string_equal("f100", lwin.dir_entry[2].name);
+
+	rename_dir_entry(&lwin.dir_entry[0], "f1000");
+
+	sort_view(&lwin);
+	assert_string_equal("f10", lwin.dir_entry[0].name);
+	assert_string_equal("f100", lwin.dir_entry[1].name);
+	assert_string_equal("f1000", lwin.dir_entry[2].name);
+}
+
 /* Windows is really bad at handling links. */
 #ifndef _WIN32
 
@@ -0,0 +1,153 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* mkdir() */
+#include <unistd.h> /* rmdir() unlink() */
+
+#include <stdio.h> /* FILE fclose() fopen() fputs() rename() snprintf() */
+#include <stddef.h> /* NULL */
+
+#include "../../src/utils/filemon.h"
+
+#define SANDBOX "test-data/sandbox/watched"
+
+static void create_file(const char path[]);
+static int is_linux(void);
+
+static filemon_watch_t *watch;
+
+SETUP()
+{
+	assert_success(mkdir(SANDBOX, 0700));
+	watch = filemon_watch(SANDBOX);
+}
+
+TEARDOWN()
+{
+	filemon_unwatch(watch);
+	(void)unlink(SANDBOX "/a");
+	(void)unlink(SANDBOX "/b");
+	(void)rmdir(SANDBOX);
+}
+
+TEST(nothing_is_reported_without_changes, IF(is_linux))
+{
+	filemon_change_t *changes;
+
+	assert_non_null(watch);
+	assert_int_equal(0, filemon_read_changes(watch, &changes));
+	filemon_free_changes(changes, 0);
+}
+
+TEST(creation_and_deletion_are_reported, IF(is_linux))
+{
+	filemon_change_t *changes;
+	int count;
+
+	create_file(SANDBOX "/a");
+
+	count = filemon_read_changes(watch, &changes);
+	assert_int_equal(1, count);
+	assert_int_equal(FMC_CREATED, changes[0].kind);
+	assert_string_equal("a", changes[0].name);
+	assert_int_equal(0, changes[0].existed);
+	filemon_free_changes(changes, count);
+
+	assert_success(unlink(SANDBOX "/a"));
+
+	count = filemon_read_changes(watch, &changes);
+	assert_int_equal(1, count);
+	assert_int_equal(FMC_DELETED, changes[0].kind);
+	assert_string_equal("a", changes[0].name);
+	assert_int_equal(1, changes[0].existed);
+	filemon_free_changes(changes, count);
+}
+
+TEST(changes_of_the_same_file_are_merged, IF(is_linux))
+{
+	filemon_change_t *changes;
+	int count;
+
+	create_file(SANDBOX "/a");
+	create_file(SANDBOX "/a");
+	assert_success(rename(SANDBOX "/a", SANDBOX "/b"));
+
+	count = filemon_read_changes(watch, &changes);
+	assert_int_equal(2, count);
+	assert_int_equal(FMC_DELETED, changes[0].kind);
+	assert_string_equal("a", changes[0].name);
+	assert_int_equal(0, changes[0].existed);
+	assert_int_equal(FMC_CREATED, changes[1].kind);
+	assert_string_equal("b", changes[1].name);
+	assert_int_equal(-1, changes[1].existed);
+	filemon_free_changes(changes, count);
+}
+
+TEST(changes_of_many_files_are_collected, IF(is_linux))
+{
+	filemon_change_t *changes;
+	int count;
+	int i;
+
+	for(i = 0; i < 100; ++i)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "%s/%d", SANDBOX, i);
+		create_file(path);
+		create_file(path);
+	}
+
+	count = filemon_read_changes(watch, &changes);
+	assert_int_equal(100, count);
+	for(i = 0; i < count; ++i)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "%d", i);
+		assert_int_equal(FMC_CREATED, changes[i].kind);
+		assert_string_equal(name, changes[i].name);
+	}
+	filemon_free_changes(changes, count);
+
+	for(i = 0; i < 100; ++i)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "%s/%d", SANDBOX, i);
+		assert_success(unlink(path));
+	}
+}
+
+TEST(removal_of_directory_requests_rescan, IF(is_linux))
+{
+	filemon_change_t *changes;
+	int count;
+
+	assert_success(rmdir(SANDBOX));
+
+	count = filemon_read_changes(watch, &changes);
+	assert_int_equal(1, count);
+	assert_int_equal(FMC_RESCAN, changes[0].kind);
+	assert_null(changes[0].name);
+	filemon_free_changes(changes, count);
+}
+
+/* Creates file or appends to it. */
+static void
+create_file(const char path[])
+{
+	FILE *const f = fopen(path, "a");
+	assert_non_null(f);
+	fputs("text", f);
+	fclose(f);
+}
+
+static int
+is_linux(void)
+{
+#ifdef __linux__
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
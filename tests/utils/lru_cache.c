@@ -0,0 +1,93 @@
+#include <stic.h>
+
+#include <stdlib.h> /* malloc() */
+#include <string.h> /* strcpy() */
+
+#include "../../src/utils/lru_cache.h"
+
+/* Size of values (keys are one character long, so entries are 12 bytes). */
+#define VALUE_SIZE 10U
+
+static char * make_value(const char text[]);
+
+static lru_cache_t *cache;
+
+SETUP()
+{
+	cache = lru_cache_create(3U*(VALUE_SIZE + 2U));
+	assert_non_null(cache);
+}
+
+TEARDOWN()
+{
+	lru_cache_free(cache);
+}
+
+TEST(values_are_found_by_keys)
+{
+	assert_success(lru_cache_put(cache, "a", make_value("1"), VALUE_SIZE));
+	assert_success(lru_cache_put(cache, "b", make_value("2"), VALUE_SIZE));
+
+	assert_string_equal("1", lru_cache_get(cache, "a"));
+	assert_string_equal("2", lru_cache_get(cache, "b"));
+	assert_null(lru_cache_get(cache, "c"));
+	assert_int_equal(2U*(VALUE_SIZE + 2U), lru_cache_size(cache));
+}
+
+TEST(value_is_replaced)
+{
+	assert_success(lru_cache_put(cache, "a", make_value("1"), VALUE_SIZE));
+	assert_success(lru_cache_put(cache, "a", make_value("2"), VALUE_SIZE));
+
+	assert_string_equal("2", lru_cache_get(cache, "a"));
+	assert_int_equal(VALUE_SIZE + 2U, lru_cache_size(cache));
+}
+
+TEST(least_recently_used_value_is_evicted)
+{
+	assert_success(lru_cache_put(cache, "a", make_value("1"), VALUE_SIZE));
+	assert_success(lru_cache_put(cache, "b", make_value("2"), VALUE_SIZE));
+	assert_success(lru_cache_put(cache, "c", make_value("3"), VALUE_SIZE));
+
+	assert_non_null(lru_cache_get(cache, "a"));
+	assert_success(lru_cache_put(cache, "d", make_value("4"), VALUE_SIZE));
+
+	assert_non_null(lru_cache_get(cache, "a"));
+	assert_null(lru_cache_get(cache, "b"));
+	assert_non_null(lru_cache_get(cache, "c"));
+	assert_non_null(lru_cache_get(cache, "d"));
+}
+
+TEST(several_values_can_be_evicted_at_once)
+{
+	assert_success(lru_cache_put(cache, "a", make_value("1"), VALUE_SIZE));
+	assert_success(lru_cache_put(cache, "b", make_value("2"), VALUE_SIZE));
+	assert_success(lru_cache_put(cache, "c", make_value("3"), VALUE_SIZE));
+
+	assert_success(lru_cache_put(cache, "d", make_value("4"), 2U*VALUE_SIZE));
+
+	assert_null(lru_cache_get(cache, "a"));
+	assert_null(lru_cache_get(cache, "b"));
+	assert_non_null(lru_cache_get(cache, "c"));
+	assert_non_null(lru_cache_get(cache, "d"));
+}
+
+TEST(too_large_value_is_not_stored)
+{
+	assert_success(lru_cache_put(cache, "a", make_value("1"), VALUE_SIZE));
+	assert_failure(lru_cache_put(cache, "b", make_value("2"), 4U*VALUE_SIZE));
+
+	assert_non_null(lru_cache_get(cache, "a"));
+	assert_null(lru_cache_get(cache, "b"));
+	assert_int_equal(VALUE_SIZE + 2U, lru_cache_size(cache));
+}
+
+/* Allocates value with the text.  Returns the value. */
+static char *
+make_value(const char text[])
+{
+	return strcpy(malloc(VALUE_SIZE), text);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -0,0 +1,85 @@
+#include <stic.h>
+
+#include <stddef.h> /* NULL */
+#include <stdio.h> /* snprintf() */
+
+#include "../../src/utils/fs_limits.h"
+#include "../../src/utils/mntent.h"
+#include "../../src/utils/path.h"
+#include "../../src/utils/string_array.h"
+#include "../../src/utils/utils.h"
+
+static int collect_mount_points(struct mntent *entry, void *arg);
+static int not_windows(void);
+
+static char **dirs;
+static int ndirs;
+
+SETUP()
+{
+	dirs = NULL;
+	ndirs = 0;
+}
+
+TEARDOWN()
+{
+	free_string_array(dirs, ndirs);
+}
+
+TEST(root_is_found_for_unknown_path, IF(not_windows))
+{
+	char mount_point[PATH_MAX];
+
+	assert_success(traverse_mount_points(&collect_mount_points, NULL));
+	if(!is_in_string_array(dirs, ndirs, "/"))
+	{
+		return;
+	}
+
+	assert_success(get_mount_point("/no/such/path/", sizeof(mount_point),
+				mount_point));
+	assert_string_equal("/", mount_point);
+}
+
+TEST(mount_point_is_found_for_itself_and_its_children, IF(not_windows))
+{
+	int i;
+
+	assert_success(traverse_mount_points(&collect_mount_points, NULL));
+
+	for(i = 0; i < ndirs; ++i)
+	{
+		char child[PATH_MAX];
+		char mount_point[PATH_MAX];
+
+		assert_success(get_mount_point(dirs[i], sizeof(mount_point),
+					mount_point));
+		assert_true(paths_are_equal(dirs[i], mount_point));
+
+		/* Some other mount point can be there. */
+		snprintf(child, sizeof(child), "%s/no-such-dir/", dirs[i]);
+		assert_success(get_mount_point(child, sizeof(mount_point), mount_point));
+		assert_true(paths_are_equal(dirs[i], mount_point));
+	}
+}
+
+/* traverse_mount_points() client that collects mount points. */
+static int
+collect_mount_points(struct mntent *entry, void *arg)
+{
+	ndirs = add_to_string_array(&dirs, ndirs, 1, entry->mnt_dir);
+	return 0;
+}
+
+static int
+not_windows(void)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -0,0 +1,285 @@
+#include <stic.h>
+
+#include <regex.h> /* regcomp() regexec() regfree() */
+#include <unistd.h> /* unlink() */
+
+#include <stddef.h> /* size_t */
+#include <stdio.h> /* FILE fclose() fopen() fprintf() fputs() rename() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* memcpy() */
+
+#include "../../src/ui/cancellation.h"
+#include "../../src/utils/paged_file.h"
+#include "../../src/utils/string_array.h"
+
+#define FILE_PATH "test-data/sandbox/paged"
+
+/* Enough to have several blocks of the index. */
+#define NLINES 5000
+
+static void write_lines(const char mode[], int from, int to);
+static int re_matches(const char line[], size_t len, void *arg);
+static int stop_search(const char line[], size_t len, void *arg);
+static int count_calls(const char line[], size_t len, void *arg);
+static int not_windows(void);
+
+static paged_file_t *pf;
+
+SETUP()
+{
+	write_lines("w", 0, NLINES);
+	pf = pf_open(FILE_PATH);
+}
+
+TEARDOWN()
+{
+	pf_close(pf);
+	assert_success(unlink(FILE_PATH));
+}
+
+TEST(lines_are_counted, IF(not_windows))
+{
+	int complete;
+
+	assert_non_null(pf);
+
+	assert_true(pf_has_line(pf, 10));
+	assert_true(pf_known_lines(pf, &complete) < NLINES);
+	assert_false(complete);
+
+	assert_int_equal(NLINES, pf_count_lines(pf));
+	assert_int_equal(NLINES, pf_known_lines(pf, &complete));
+	assert_true(complete);
+
+	assert_true(pf_has_line(pf, NLINES - 1));
+	assert_false(pf_has_line(pf, NLINES));
+	assert_false(pf_has_line(pf, -1));
+}
+
+TEST(lines_are_read_from_the_middle, IF(not_windows))
+{
+	int nread;
+	char **const lines = pf_read_lines(pf, 3000, 3, &nread);
+
+	assert_int_equal(3, nread);
+	assert_string_equal("line 3000", lines[0]);
+	assert_string_equal("line 3001", lines[1]);
+	assert_string_equal("line 3002", lines[2]);
+
+	free_string_array(lines, nread);
+}
+
+TEST(reading_stops_at_the_end, IF(not_windows))
+{
+	int nread;
+	char **lines;
+
+	lines = pf_read_lines(pf, NLINES - 1, 10, &nread);
+	assert_int_equal(1, nread);
+	assert_string_equal("line 4999", lines[0]);
+	free_string_array(lines, nread);
+
+	lines = pf_read_lines(pf, NLINES, 10, &nread);
+	assert_int_equal(0, nread);
+	free_string_array(lines, nread);
+}
+
+TEST(search_works_in_both_directions, IF(not_windows))
+{
+	regex_t re;
+	assert_success(regcomp(&re, "^line 12[0-9]$", REG_EXTENDED));
+
+	assert_int_equal(120, pf_find(pf, 0, 0, &re_matches, &re));
+	assert_int_equal(125, pf_find(pf, 125, 0, &re_matches, &re));
+	assert_int_equal(-1, pf_find(pf, 130, 0, &re_matches, &re));
+	assert_int_equal(129, pf_find(pf, 4000, 1, &re_matches, &re));
+	assert_int_equal(-1, pf_find(pf, 119, 1, &re_matches, &re));
+
+	regfree(&re);
+}
+
+TEST(search_can_be_stopped, IF(not_windows))
+{
+	assert_int_equal(-2, pf_find(pf, 0, 0, &stop_search, NULL));
+	assert_int_equal(-2, pf_find(pf, 4000, 1, &stop_search, NULL));
+}
+
+TEST(backward_search_checks_each_line_once, IF(not_windows))
+{
+	int ncalls = 0;
+	assert_int_equal(-1, pf_find(pf, 4000, 1, &count_calls, &ncalls));
+	assert_int_equal(4001, ncalls);
+}
+
+TEST(indexing_can_be_cancelled, IF(not_windows))
+{
+	int complete;
+
+	pf_set_cancellable(pf, 1);
+	ui_cancellation_reset();
+	ui_cancellation_enable();
+	ui_cancellation_request();
+
+	assert_true(pf_count_lines(pf) < NLINES);
+	assert_false(pf_has_line(pf, NLINES - 1));
+	(void)pf_known_lines(pf, &complete);
+	assert_false(complete);
+
+	ui_cancellation_disable();
+	ui_cancellation_reset();
+	pf_set_cancellable(pf, 0);
+
+	assert_int_equal(NLINES, pf_count_lines(pf));
+}
+
+TEST(truncation_is_detected_without_refresh, IF(not_windows))
+{
+	int nread;
+	char **lines;
+
+	assert_int_equal(NLINES, pf_count_lines(pf));
+
+	write_lines("w", 0, 10);
+
+	lines = pf_read_lines(pf, 3000, 3, &nread);
+	assert_int_equal(0, nread);
+	free_string_array(lines, nread);
+
+	assert_int_equal(10, pf_count_lines(pf));
+	assert_int_equal(-1, pf_find(pf, 3000, 1, &count_calls, &nread));
+
+	lines = pf_read_lines(pf, 9, 3, &nread);
+	assert_int_equal(1, nread);
+	assert_string_equal("line 9", lines[0]);
+	free_string_array(lines, nread);
+}
+
+TEST(appended_lines_are_picked_up, IF(not_windows))
+{
+	int nread;
+	char **lines;
+
+	FILE *const f = fopen(FILE_PATH, "a");
+	assert_non_null(f);
+	fputs("line 5000 with", f);
+	fclose(f);
+
+	assert_int_equal(NLINES, pf_count_lines(pf));
+	assert_success(pf_refresh(pf));
+	assert_int_equal(NLINES + 1, pf_count_lines(pf));
+
+	write_lines("a", NLINES + 1, NLINES + 2);
+	assert_success(pf_refresh(pf));
+	assert_int_equal(NLINES + 1, pf_count_lines(pf));
+
+	lines = pf_read_lines(pf, NLINES, 2, &nread);
+	assert_int_equal(1, nread);
+	assert_string_equal("line 5000 withline 5001", lines[0]);
+	free_string_array(lines, nread);
+}
+
+TEST(file_rewritten_in_place_is_reindexed, IF(not_windows))
+{
+	int i;
+	int nread;
+	char **lines;
+	FILE *f;
+
+	assert_int_equal(NLINES, pf_count_lines(pf));
+
+	/* Same size, but different line boundaries. */
+	f = fopen(FILE_PATH, "w");
+	assert_non_null(f);
+	for(i = 0; i < NLINES; ++i)
+	{
+		fprintf(f, "line %d%s", i, (i%2 == 0) ? "\n" : "\n\n");
+	}
+	fclose(f);
+
+	assert_success(pf_refresh(pf));
+	assert_int_equal(NLINES + NLINES/2, pf_count_lines(pf));
+
+	lines = pf_read_lines(pf, 1, 3, &nread);
+	assert_int_equal(3, nread);
+	assert_string_equal("line 1", lines[0]);
+	assert_string_equal("", lines[1]);
+	assert_string_equal("line 2", lines[2]);
+	free_string_array(lines, nread);
+}
+
+TEST(replaced_file_is_reopened, IF(not_windows))
+{
+	int nread;
+	char **lines;
+	FILE *f;
+
+	assert_int_equal(NLINES, pf_count_lines(pf));
+
+	f = fopen(FILE_PATH ".new", "w");
+	assert_non_null(f);
+	fputs("new\n", f);
+	fclose(f);
+	assert_success(rename(FILE_PATH ".new", FILE_PATH));
+
+	assert_success(pf_refresh(pf));
+	assert_int_equal(1, pf_count_lines(pf));
+
+	lines = pf_read_lines(pf, 0, 3, &nread);
+	assert_int_equal(1, nread);
+	assert_string_equal("new", lines[0]);
+	free_string_array(lines, nread);
+}
+
+/* Writes lines in the [from, to) range to the file using specified mode of
+ * opening. */
+static void
+write_lines(const char mode[], int from, int to)
+{
+	int i;
+	FILE *const f = fopen(FILE_PATH, mode);
+	assert_non_null(f);
+	for(i = from; i < to; ++i)
+	{
+		fprintf(f, "line %d%s", i, (i%2 == 0) ? "\n" : "\r\n");
+	}
+	fclose(f);
+}
+
+/* pf_find() callback that matches line against regular expression. */
+static int
+re_matches(const char line[], size_t len, void *arg)
+{
+	char buf[len + 1];
+	memcpy(buf, line, len);
+	buf[len] = '\0';
+	return regexec(arg, buf, 0, NULL, 0) == 0;
+}
+
+/* pf_find() callback that stops search. */
+static int
+stop_search(const char line[], size_t len, void *arg)
+{
+	return -1;
+}
+
+/* pf_find() callback that counts number of times it's called. */
+static int
+count_calls(const char line[], size_t len, void *arg)
+{
+	int *const ncalls = arg;
+	++*ncalls;
+	return 0;
+}
+
+static int
+not_windows(void)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
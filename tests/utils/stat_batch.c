@@ -0,0 +1,78 @@
+#include <stic.h>
+
+#include <fcntl.h> /* AT_FDCWD */
+
+#include <errno.h> /* ENOENT */
+#include <stddef.h> /* size_t */
+
+#include "../../src/utils/macros.h"
+#include "../../src/utils/stat_batch.h"
+
+#define DIR "test-data/various-sizes/"
+
+static void check_batch(int workers, size_t batch_size);
+
+TEST(sizes_are_in_order_for_any_parameters)
+{
+	check_batch(1, 1U);
+	check_batch(1, 100U);
+	check_batch(3, 1U);
+	check_batch(3, 2U);
+	check_batch(8, 3U);
+	check_batch(100, 0U);
+}
+
+TEST(errors_are_reported_per_item)
+{
+	stat_batch_item_t items[] = {
+		{ .name = DIR "empty-file" },
+		{ .name = DIR "no-such-file" },
+		{ .name = DIR "block-size-file" },
+	};
+
+	stat_batch(AT_FDCWD, items, ARRAY_LEN(items), 2, 1U);
+
+	assert_int_equal(0, items[0].error);
+	assert_int_equal(ENOENT, items[1].error);
+	assert_int_equal(0, items[2].error);
+	assert_int_equal(8192, items[2].st.st_size);
+}
+
+TEST(empty_batch_is_fine)
+{
+	stat_batch(AT_FDCWD, NULL, 0U, 4, 16U);
+}
+
+TEST(there_is_always_at_least_one_worker)
+{
+	assert_true(stat_batch_workers(0U, 0U) >= 1);
+	assert_true(stat_batch_workers(1U, 100U) == 1);
+	assert_true(stat_batch_workers(100000U, 100U) >= 1);
+}
+
+static void
+check_batch(int workers, size_t batch_size)
+{
+	stat_batch_item_t items[] = {
+		{ .name = DIR "block-size-file" },
+		{ .name = DIR "block-size-minus-one-file" },
+		{ .name = DIR "block-size-plus-one-file" },
+		{ .name = DIR "double-block-size-file" },
+		{ .name = DIR "double-block-size-minus-one-file" },
+		{ .name = DIR "double-block-size-plus-one-file" },
+		{ .name = DIR "empty-file" },
+	};
+	const off_t sizes[] = { 8192, 8191, 8193, 16384, 16383, 16385, 0 };
+	size_t i;
+
+	stat_batch(AT_FDCWD, items, ARRAY_LEN(items), workers, batch_size);
+
+	for(i = 0U; i < ARRAY_LEN(items); ++i)
+	{
+		assert_int_equal(0, items[i].error);
+		assert_int_equal(sizes[i], items[i].st.st_size);
+	}
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
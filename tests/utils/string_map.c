@@ -0,0 +1,78 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+
+#include "../../src/utils/string_map.h"
+
+static string_map_t *map;
+
+SETUP()
+{
+	map = string_map_create();
+	assert_non_null(map);
+}
+
+TEARDOWN()
+{
+	string_map_free(map, NULL);
+}
+
+TEST(values_are_found_by_keys)
+{
+	int a, b;
+
+	assert_success(string_map_set(map, "a", &a));
+	assert_success(string_map_set(map, "b", &b));
+
+	assert_true(string_map_get(map, "a") == &a);
+	assert_true(string_map_get(map, "b") == &b);
+	assert_null(string_map_get(map, "c"));
+	assert_int_equal(2, string_map_size(map));
+}
+
+TEST(value_is_replaced)
+{
+	int a, b;
+
+	assert_success(string_map_set(map, "key", &a));
+	assert_success(string_map_set(map, "key", &b));
+
+	assert_true(string_map_get(map, "key") == &b);
+	assert_int_equal(1, string_map_size(map));
+}
+
+TEST(keys_are_removed)
+{
+	int a;
+
+	assert_success(string_map_set(map, "key", &a));
+	assert_true(string_map_remove(map, "key") == &a);
+	assert_null(string_map_remove(map, "key"));
+
+	assert_null(string_map_get(map, "key"));
+	assert_int_equal(0, string_map_size(map));
+}
+
+TEST(many_keys_are_stored)
+{
+	static int values[1000];
+	int i;
+
+	for(i = 0; i < 1000; ++i)
+	{
+		char key[16];
+		snprintf(key, sizeof(key), "key%d", i);
+		assert_success(string_map_set(map, key, &values[i]));
+	}
+
+	assert_int_equal(1000, string_map_size(map));
+	for(i = 0; i < 1000; ++i)
+	{
+		char key[16];
+		snprintf(key, sizeof(key), "key%d", i);
+		assert_true(string_map_get(map, key) == &values[i]);
+	}
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
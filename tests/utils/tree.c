@@ -0,0 +1,166 @@
+#include <stic.h>
+
+#include "../../src/utils/tree.h"
+
+#define DIR "test-data/"
+
+static tree_t tree;
+
+SETUP()
+{
+	tree = tree_create(0, 0);
+}
+
+TEARDOWN()
+{
+	tree_free(tree);
+}
+
+TEST(values_are_found_by_path)
+{
+	tree_val_t data = 0;
+
+	assert_success(tree_set_data(tree, DIR "read", 1));
+	assert_success(tree_set_data(tree, DIR "read/two-lines", 2));
+	assert_success(tree_set_data(tree, DIR "various-sizes/empty-file", 3));
+
+	assert_success(tree_get_data(tree, DIR "read", &data));
+	assert_int_equal(1, data);
+	assert_success(tree_get_data(tree, DIR "read/two-lines", &data));
+	assert_int_equal(2, data);
+	assert_success(tree_get_data(tree, DIR "various-sizes/empty-file", &data));
+	assert_int_equal(3, data);
+
+	assert_failure(tree_get_data(tree, DIR "various-sizes", &data));
+	assert_failure(tree_get_data(tree, DIR "read/dos-eof", &data));
+}
+
+TEST(value_is_replaced)
+{
+	tree_val_t data = 0;
+
+	assert_success(tree_set_data(tree, DIR "read", 1));
+	assert_success(tree_set_data(tree, DIR "read", 2));
+
+	assert_success(tree_get_data(tree, DIR "read", &data));
+	assert_int_equal(2, data);
+}
+
+TEST(longest_tree_returns_value_of_closest_parent)
+{
+	tree_val_t data = 0;
+	tree_t longest = tree_create(1, 0);
+
+	assert_success(tree_set_data(longest, DIR "read", 1));
+	assert_success(tree_get_data(longest, DIR "read/two-lines", &data));
+	assert_int_equal(1, data);
+	assert_failure(tree_get_data(longest, DIR "various-sizes", &data));
+
+	tree_free(longest);
+}
+
+TEST(children_are_looked_up_regardless_of_insertion_order)
+{
+	tree_val_t data = 0;
+
+	assert_success(tree_set_data(tree, DIR "read/very-long-line", 5));
+	assert_success(tree_set_data(tree, DIR "read/binary-data", 1));
+	assert_success(tree_set_data(tree, DIR "read/two-lines", 4));
+	assert_success(tree_set_data(tree, DIR "read/dos-eof", 2));
+	assert_success(tree_set_data(tree, DIR "read/dos-line-endings", 3));
+
+	assert_success(tree_get_data(tree, DIR "read/binary-data", &data));
+	assert_int_equal(1, data);
+	assert_success(tree_get_data(tree, DIR "read/dos-eof", &data));
+	assert_int_equal(2, data);
+	assert_success(tree_get_data(tree, DIR "read/dos-line-endings", &data));
+	assert_int_equal(3, data);
+	assert_success(tree_get_data(tree, DIR "read/two-lines", &data));
+	assert_int_equal(4, data);
+	assert_success(tree_get_data(tree, DIR "read/very-long-line", &data));
+	assert_int_equal(5, data);
+}
+
+TEST(subtree_is_removed)
+{
+	tree_val_t data = 0;
+
+	assert_success(tree_set_data(tree, DIR "read", 1));
+	assert_success(tree_set_data(tree, DIR "read/two-lines", 2));
+	assert_success(tree_set_data(tree, DIR "various-sizes", 3));
+
+	tree_remove(tree, DIR "read");
+
+	assert_failure(tree_get_data(tree, DIR "read", &data));
+	assert_failure(tree_get_data(tree, DIR "read/two-lines", &data));
+	assert_success(tree_get_data(tree, DIR "various-sizes", &data));
+	assert_int_equal(3, data);
+
+	assert_success(tree_set_data(tree, DIR "read/two-lines", 4));
+	assert_success(tree_get_data(tree, DIR "read/two-lines", &data));
+	assert_int_equal(4, data);
+}
+
+TEST(removing_nonexistent_path_does_nothing)
+{
+	tree_val_t data = 0;
+
+	assert_success(tree_set_data(tree, DIR "read", 1));
+	tree_remove(tree, DIR "no-such-path");
+
+	assert_success(tree_get_data(tree, DIR "read", &data));
+	assert_int_equal(1, data);
+}
+
+TEST(canonical_paths_are_not_resolved)
+{
+	tree_val_t data = 0;
+
+	assert_failure(tree_set_data(tree, "/no/such/path", 1));
+
+	tree_set_canonical(tree, 1);
+
+	assert_success(tree_set_data(tree, "/no/such/path", 1));
+	assert_success(tree_get_data(tree, "/no/such/path", &data));
+	assert_int_equal(1, data);
+
+	tree_remove(tree, "/no/such");
+	assert_failure(tree_get_data(tree, "/no/such/path", &data));
+}
+
+TEST(least_recently_used_values_are_evicted)
+{
+	tree_val_t data = 0;
+
+	tree_set_limit(tree, 2U);
+
+	assert_success(tree_set_data(tree, DIR "read/binary-data", 1));
+	assert_success(tree_set_data(tree, DIR "read/dos-eof", 2));
+	assert_success(tree_get_data(tree, DIR "read/binary-data", &data));
+	assert_success(tree_set_data(tree, DIR "read/two-lines", 3));
+
+	assert_success(tree_get_data(tree, DIR "read/binary-data", &data));
+	assert_int_equal(1, data);
+	assert_failure(tree_get_data(tree, DIR "read/dos-eof", &data));
+	assert_success(tree_get_data(tree, DIR "read/two-lines", &data));
+	assert_int_equal(3, data);
+}
+
+TEST(lowering_limit_evicts_values)
+{
+	tree_val_t data = 0;
+
+	assert_success(tree_set_data(tree, DIR "read/binary-data", 1));
+	assert_success(tree_set_data(tree, DIR "read/dos-eof", 2));
+	assert_success(tree_set_data(tree, DIR "read", 3));
+
+	tree_set_limit(tree, 1U);
+
+	assert_failure(tree_get_data(tree, DIR "read/binary-data", &data));
+	assert_failure(tree_get_data(tree, DIR "read/dos-eof", &data));
+	assert_success(tree_get_data(tree, DIR "read", &data));
+	assert_int_equal(3, data);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 : */
@@ -49,6 +49,29 @@ TEST(get_real_string_width_in_the_middle_b, IF(locale_works))
 	assert_int_equal(expected_len, calculated_len);
 }
 
+TEST(screen_length_of_ascii_string)
+{
+	assert_int_equal(0, get_screen_string_length(""));
+	assert_int_equal(3, get_screen_string_length("abc"));
+	assert_int_equal(26, get_screen_string_length("abcdefghijklmnopqrstuvwxyz"));
+	assert_int_equal(11, get_screen_string_length("abcdefghi\x7f~"));
+}
+
+TEST(screen_length_of_control_characters)
+{
+	assert_int_equal(2, get_screen_string_length("\t"));
+	assert_int_equal(19, get_screen_string_length("abcdefgh\tijklmnopq"));
+	assert_int_equal(21, get_screen_string_length("abcdefghijklmnopq\x01\x1f"));
+}
+
+TEST(screen_length_of_mixed_string, IF(locale_works))
+{
+	assert_int_equal(4, get_screen_string_length("师螺"));
+	assert_int_equal(13, get_screen_string_length("abcdefgh师ijk"));
+	assert_int_equal(21, get_screen_string_length("abcdefgh师ijklmnop螺q"));
+	assert_int_equal(11, get_screen_string_length("abcdefghвгд"));
+}
+
 static int
 locale_works(void)
 {